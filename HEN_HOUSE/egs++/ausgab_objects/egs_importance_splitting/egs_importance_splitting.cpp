@@ -0,0 +1,162 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ importance splitting object
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+#
+#  Geometry splitting and Russian Roulette based on region importances.
+#
+###############################################################################
+*/
+
+
+/*! \file egs_importance_splitting.cpp
+ *  \brief A region importance splitting ausgab object: implementation
+ */
+
+#include <string>
+#include <cstdio>
+
+#include "egs_importance_splitting.h"
+#include "egs_input.h"
+#include "egs_functions.h"
+
+EGS_ImportanceSplitting::EGS_ImportanceSplitting(const string &Name,
+        EGS_ObjectFactory *f) :
+    EGS_AusgabObject(Name,f), default_imp(1) {
+    otype = "EGS_ImportanceSplitting";
+    split_q[0] = false;
+    split_q[1] = true;
+    split_q[2] = false;
+}
+
+EGS_ImportanceSplitting::~EGS_ImportanceSplitting() {
+}
+
+void EGS_ImportanceSplitting::setApplication(EGS_Application *App) {
+    EGS_AusgabObject::setApplication(App);
+    if (!app) {
+        return;
+    }
+
+    int nreg = app->getnRegions();
+    imp.assign(nreg,default_imp);
+    char buf[128];
+    string imp_description;
+    for (size_t j=0; j<imp_regions.size(); j++) {
+        vector<int> regs;
+        app->getNumberRegions(imp_regions[j],regs);
+        app->getLabelRegions(imp_regions[j],regs);
+        int nset = 0;
+        for (size_t i=0; i<regs.size(); i++) {
+            if (regs[i] >= 0 && regs[i] < nreg) {
+                imp[regs[i]] = imp_values[j];
+                ++nset;
+            }
+            else egsWarning("EGS_ImportanceSplitting::setApplication: "
+                                "region %d does not exist, ignoring it\n",regs[i]);
+        }
+        sprintf(buf," - Importance %g in %d region(s): ",imp_values[j],nset);
+        imp_description += buf;
+        imp_description += imp_regions[j];
+        imp_description += "\n";
+    }
+
+    description = "\n===========================================\n";
+    description +=  "Importance splitting Object (";
+    description += name;
+    description += ")\n";
+    description += "===========================================\n";
+    description += " - Splitting photons       = ";
+    description += split_q[1] ? "YES\n" : "NO\n";
+    description += " - Splitting electrons     = ";
+    description += split_q[0] ? "YES\n" : "NO\n";
+    description += " - Splitting positrons     = ";
+    description += split_q[2] ? "YES\n" : "NO\n";
+    sprintf(buf," - Default importance      = %g\n",default_imp);
+    description += buf;
+    description += imp_description;
+    description += "===========================================\n\n";
+}
+
+//*********************************************************************
+// Process input for this ausgab object
+//
+//**********************************************************************
+extern "C" {
+
+    EGS_IMPORTANCE_SPLITTING_EXPORT EGS_AusgabObject *createAusgabObject(
+        EGS_Input *input, EGS_ObjectFactory *f) {
+        const static char *func = "createAusgabObject(importance_splitting)";
+        if (!input) {
+            egsWarning("%s: null input?\n",func);
+            return 0;
+        }
+
+        EGS_Float default_imp = 1;
+        input->getInput("default importance",default_imp);
+        if (default_imp < 0) {
+            egsWarning("%s: negative default importance %g\n",func,
+                       default_imp);
+            return 0;
+        }
+        vector<string> yn;
+        yn.push_back("no");
+        yn.push_back("yes");
+        bool sph = input->getInput("split photons",yn,1);
+        bool sel = input->getInput("split electrons",yn,0);
+        bool spo = input->getInput("split positrons",yn,0);
+
+        EGS_ImportanceSplitting *result = new EGS_ImportanceSplitting("",f);
+        result->setDefaultImportance(default_imp);
+        result->setSplitParticle(0,sph);
+        result->setSplitParticle(-1,sel);
+        result->setSplitParticle(1,spo);
+
+        EGS_Input *ij;
+        while ((ij = input->takeInputItem("region importance"))) {
+            string regions;
+            EGS_Float value;
+            int err1 = ij->getInput("regions",regions);
+            int err2 = ij->getInput("importance",value);
+            if (err1 || err2 || regions.length() < 1) {
+                egsWarning("%s: missing/wrong 'regions' or 'importance' "
+                           "input in a region importance input, ignoring it\n",func);
+            }
+            else if (value < 0) {
+                egsWarning("%s: negative importance %g, ignoring it\n",func,
+                           value);
+            }
+            else {
+                result->addImportance(regions,value);
+            }
+            delete ij;
+        }
+
+        result->setName(input);
+        return result;
+    }
+}
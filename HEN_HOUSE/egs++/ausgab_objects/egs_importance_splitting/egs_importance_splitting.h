@@ -0,0 +1,215 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ importance splitting object headers
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+#
+#  Geometry splitting and Russian Roulette based on region importances.
+#
+###############################################################################
+*/
+
+
+/*! \file egs_importance_splitting.h
+ *  \brief A region importance splitting ausgab object: header
+ */
+
+#ifndef EGS_IMPORTANCE_SPLITTING_
+#define EGS_IMPORTANCE_SPLITTING_
+
+#include "egs_ausgab_object.h"
+#include "egs_application.h"
+#include "egs_rndm.h"
+
+#include <vector>
+
+#ifdef WIN32
+
+    #ifdef BUILD_IMPORTANCE_SPLITTING_DLL
+        #define EGS_IMPORTANCE_SPLITTING_EXPORT __declspec(dllexport)
+    #else
+        #define EGS_IMPORTANCE_SPLITTING_EXPORT __declspec(dllimport)
+    #endif
+    #define EGS_IMPORTANCE_SPLITTING_LOCAL
+
+#else
+
+    #ifdef HAVE_VISIBILITY
+        #define EGS_IMPORTANCE_SPLITTING_EXPORT __attribute__ ((visibility ("default")))
+        #define EGS_IMPORTANCE_SPLITTING_LOCAL  __attribute__ ((visibility ("hidden")))
+    #else
+        #define EGS_IMPORTANCE_SPLITTING_EXPORT
+        #define EGS_IMPORTANCE_SPLITTING_LOCAL
+    #endif
+
+#endif
+
+/*! \brief A region importance splitting object: header
+
+\ingroup AusgabObjects
+
+This ausgab object implements geometry splitting and Russian Roulette
+(RR). Each region of the geometry is assigned an importance \f$I\f$.
+When a particle moves from a region with importance \f$I_{\rm old}\f$
+into a region with importance \f$I_{\rm new}\f$, the ratio
+\f$r = I_{\rm new}/I_{\rm old}\f$ is computed. If \f$r > 1\f$, the
+particle is split into \f$n\f$ particles, where \f$n\f$ is one of the
+two integers closest to \f$r\f$ sampled such that the average of
+\f$n\f$ is \f$r\f$, and the weight of the particles is divided by \f$r\f$.
+If \f$r < 1\f$, RR is played with a survival probability of \f$r\f$ and
+the weight of surviving particles is divided by \f$r\f$. Particles
+entering a region with zero importance are discarded. The weight of
+the particles is thus proportional to the inverse of the importance of
+the region they are in, which improves the efficiency of deep penetration
+shielding calculations and of calculations of the dose in small regions
+(e.g. the cavity of an ion chamber) by assigning increasing importances
+to the regions closer to the region of interest.
+
+This ausgab object is specified via
+\verbatim
+:start ausgab object:
+    library = egs_importance_splitting
+    name    = some_name
+    default importance = value # optional, 1 assumed if missing
+    :start region importance:
+        regions    = list of region numbers and/or region labels
+        importance = value
+    :stop region importance:
+    # more region importance inputs as needed
+    split photons   = yes or no # optional, yes assumed if missing
+    split electrons = yes or no # optional, no assumed if missing
+    split positrons = yes or no # optional, no assumed if missing
+:stop ausgab object:
+\endverbatim
+Regions not listed in any <code>region importance</code> input have the default
+importance. Importances must not be negative. Splitting and RR are only
+applied to the particle types selected. The splitting is done when the
+particle has entered the new region (i.e. at the \c AfterTransport
+ausgab call), so the object works with any egs++ application based on
+EGS_AdvancedApplication. The importances are tabulated for the geometry
+used when the object is attached to the application. In applications
+that change the geometry during the run (e.g. egs_chamber), no splitting
+or RR is done for region numbers outside of this table. Applications
+that use other variance reduction
+techniques which rely on the particle weight or the latch variable should
+be checked for compatibility.
+*/
+class EGS_IMPORTANCE_SPLITTING_EXPORT EGS_ImportanceSplitting :
+    public EGS_AusgabObject {
+
+public:
+
+    EGS_ImportanceSplitting(const string &Name="", EGS_ObjectFactory *f = 0);
+
+    ~EGS_ImportanceSplitting();
+
+    void setApplication(EGS_Application *App);
+
+    /*! \brief Set the importance of the regions in \a regions to \a imp.
+
+    \a regions is a list of region numbers and/or labels resolved when the
+    object is attached to an application.
+    */
+    void addImportance(const string &regions, EGS_Float imp) {
+        imp_regions.push_back(regions);
+        imp_values.push_back(imp);
+    };
+
+    void setDefaultImportance(EGS_Float imp) {
+        default_imp = imp;
+    };
+
+    /*! \brief Select the particle types to split (\a q = charge) */
+    void setSplitParticle(int q, bool on_or_off) {
+        split_q[q+1] = on_or_off;
+    };
+
+    bool needsCall(EGS_Application::AusgabCall iarg) const {
+        return iarg == EGS_Application::AfterTransport;
+    };
+
+    int processEvent(EGS_Application::AusgabCall iarg) {
+        if (iarg != EGS_Application::AfterTransport) {
+            return 0;
+        }
+        int ir = app->top_p.ir;
+        if (ir < 0 || !split_q[app->top_p.q+1]) {
+            return 0;
+        }
+        int irold = app->getPreviousRegion();
+        if (irold == ir || irold < 0) {
+            return 0;
+        }
+        // the table is set up for the geometry in use when the
+        // application was set (e.g. egs_chamber may change geometries)
+        if ((size_t)ir >= imp.size() || (size_t)irold >= imp.size()) {
+            return 0;
+        }
+        EGS_Float iold = imp[irold], inew = imp[ir];
+        if (iold == inew || iold <= 0) {
+            return 0;
+        }
+        if (inew <= 0) {
+            app->discardTopParticle();
+            return 0;
+        }
+        EGS_Float r = inew/iold;
+        if (r > 1) {
+            int nsplit = (int) r;
+            if (app->getRNG()->getUniform() < r - nsplit) {
+                ++nsplit;
+            }
+            app->setWeight(app->top_p.wt/r);
+            if (nsplit > 1) {
+                app->splitTopParticle(nsplit);
+            }
+        }
+        else {
+            if (app->getRNG()->getUniform() < r) {
+                app->setWeight(app->top_p.wt/r);
+            }
+            else {
+                app->discardTopParticle();
+            }
+        }
+        return 0;
+    };
+
+    int processEvent(EGS_Application::AusgabCall iarg, int ir) {
+        return 0;
+    };
+
+protected:
+
+    vector<EGS_Float> imp;          //!< importance of each region
+    vector<string>    imp_regions;  //!< region inputs
+    vector<EGS_Float> imp_values;   //!< importance of the region inputs
+    EGS_Float         default_imp;  //!< importance of all other regions
+    bool              split_q[3];   //!< split e-, photons, e+ ?
+
+};
+
+#endif
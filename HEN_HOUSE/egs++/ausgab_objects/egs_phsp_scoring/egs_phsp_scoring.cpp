@@ -38,6 +38,7 @@
 #include <fstream>
 #include <string>
 #include <cstdlib>
+#include <cmath>
 
 #include "egs_phsp_scoring.h"
 #include "egs_input.h"
@@ -46,12 +47,20 @@
 
 EGS_PhspScoring::EGS_PhspScoring(const string &Name,
                                  EGS_ObjectFactory *f) :
-    EGS_AusgabObject(Name,f), phsp_index(0), store_max(1000), phsp_file(0),
-    count(0), countg(0), emin(1.e30), emax(-1.e30), first_flush(true), is_restart(false) {
+    EGS_AusgabObject(Name,f), phsp_file(0), count(0), countg(0), emax(-1.e30),
+    emin(1.e30), zwriter(0), zpos_res(1e-4), zdir_res(9.5367431640625e-7),
+    ze_bits(16), zblock_size(16384), p_stack(0), store_max(1000),
+    phsp_index(0), first_flush(true), is_restart(false) {
     otype = "EGS_PhspScoring";
 }
 
 EGS_PhspScoring::~EGS_PhspScoring() {
+    if (p_stack) {
+        delete [] p_stack;
+    }
+    if (zwriter) {
+        delete zwriter;
+    }
 }
 
 void EGS_PhspScoring::setApplication(EGS_Application *App) {
@@ -62,7 +71,7 @@ void EGS_PhspScoring::setApplication(EGS_Application *App) {
 
     char buf[512];//useful character buffer
     //set up the stack of particles to output to the phase space file
-    //1000 particles at a time
+    //store_max particles at a time
     p_stack = new Particle[store_max];
 
     description = "\n*******************************************\n";
@@ -174,6 +183,23 @@ void EGS_PhspScoring::setApplication(EGS_Application *App) {
             }
         }
     }
+    else if (oformat==2) {
+        description += "\n Data will be output in compressed format.\n";
+        if (app->getNparallel()>0) {
+            sprintf(buf,"%s_w%d.egsphspz",getObjectName().c_str(),app->getIparallel());
+        }
+        else {
+            sprintf(buf,"%s.egsphspz",getObjectName().c_str());
+        }
+        phsp_fname=egsJoinPath(phspoutdir,buf);
+        description += "\n Phase space file name:\n";
+        description += phsp_fname;
+        sprintf(buf,"\n Position resolution: %g cm\n Direction resolution: %g\n"
+                " Energy mantissa bits: %d\n Particles per block: %d",
+                zpos_res,zdir_res,ze_bits,zblock_size);
+        description += buf;
+        zwriter = new EGS_CompressedPhspWriter;
+    }
     description += "\n Particles scored: ";
     if (ocharge == 0) {
         description += "all";
@@ -187,9 +213,11 @@ void EGS_PhspScoring::setApplication(EGS_Application *App) {
     if (oformat ==1 && score_mu) {
         description += "\n mu will be scored (if available)";
     }
-    if (oformat ==0 && score_mc) {
+    if (oformat !=1 && score_mc) {
         description += "\n will score multiple crossers (and descendents)";
     }
+    sprintf(buf,"\n Particle buffer size: %d",store_max);
+    description += buf;
 }
 
 //final buffer flush and then close file
@@ -207,6 +235,9 @@ void EGS_PhspScoring::reportResults() {
     else if (oformat == 0) {
         phsp_file.close();
     }
+    else if (oformat == 2) {
+        zwriter->close();
+    }
     egsInformation("\n======================================================\n");
     egsInformation("Phase Space Scoring Object(%s)\n",name.c_str());
     egsInformation("======================================================\n");
@@ -219,6 +250,10 @@ void EGS_PhspScoring::reportResults() {
         egsInformation("\n EGSnrc format phase space output:\n");
         egsInformation(" Data file: %s\n",phsp_fname.c_str());
     }
+    else if (oformat == 2) {
+        egsInformation("\n Compressed phase space output:\n");
+        egsInformation(" Data file: %s\n",phsp_fname.c_str());
+    }
     float emintmp;
     if (count == countg) {
         emintmp = 0.0;
@@ -235,8 +270,8 @@ void EGS_PhspScoring::reportResults() {
     egsInformation("\n======================================================\n");
 }
 
-//store 1000 particles at a time in p_stack
-//if we're at 1000, actually write the particles to the file and update
+//store store_max particles at a time in p_stack
+//if we're at store_max, actually write the particles to the file and update
 //the header info
 //also, keep track of phase space file counters, min., max. energy
 void EGS_PhspScoring::storeParticle(EGS_I64 ncase) {
@@ -321,6 +356,24 @@ void EGS_PhspScoring::openPhspFile() const {
             phsp_file.seekp(28,ios::beg);
         }
     }
+    else if (oformat == 2) {  //compressed format
+        if (is_restart) {
+            if (!zwriter->openForAppend(phsp_fname)) {
+                egsFatal("\nEGS_PhspScoring: Failed to open phase space file %s for appending.\n",
+                         phsp_fname.c_str());
+            }
+            //check that total no. of particles in file = total no. read from .egsdat file
+            if (zwriter->getNparticle() != countprev) {
+                egsFatal("\nEGS_PhspScoring: Particle no. mismatch between %s and .egsdat file.\n",phsp_fname.c_str());
+            }
+        }
+        else {
+            if (!zwriter->open(phsp_fname,zblock_size,zpos_res,zdir_res,ze_bits)) {
+                egsFatal("\nEGS_PhspScoring: Failed to open phase space file %s for writing.\n",
+                         phsp_fname.c_str());
+            }
+        }
+    }
     else if (oformat == 1) {  //IAEA format
         int rwmode;
         int iaea_iostat;
@@ -391,18 +444,19 @@ int EGS_PhspScoring::flushBuffer() const {
     first_flush = false;
 
     if (oformat == 1) { //iaea format
+        //extra long/float arrays re-used for all particles
+        EGS_I32 *iaea_extra_long = new EGS_I32[iaea_n_extra_long];
+        float *iaea_extra_float = new float[iaea_n_extra_float > 0 ? iaea_n_extra_float : 1];
         for (int j=0; j<phsp_index; j++) {
             //fairly transparent, could probably put a lot of this in a separate method
             //undo -ve energy marker and use n_stat to indicate new primary hist.
             int n_stat = p_stack[j].E < 0 ? 1 : 0;
-            float E = abs(p_stack[j].E);
+            float E = fabs(p_stack[j].E);
             //convert charge to iaea type
             int type = iaea_q_type[p_stack[j].q+1];
 
             //store latch in iaea_extra_long
-            EGS_I32 *iaea_extra_long = new EGS_I32[iaea_n_extra_long];
             iaea_extra_long[iaea_i_latch]=p_stack[j].latch;
-            float *iaea_extra_float = new float[iaea_n_extra_float];
             if (score_mu) {
                 iaea_extra_float[iaea_i_mu] = p_stack[j].mu;
             }
@@ -422,6 +476,8 @@ int EGS_PhspScoring::flushBuffer() const {
                 egsFatal("\nEGS_PhspScoring: Failed to write particle data to phase space file.");
             }
         }
+        delete [] iaea_extra_long;
+        delete [] iaea_extra_float;
         //update header with no. of primary histories
         EGS_I64 last_case_tmp = last_case;
         iaea_set_total_original_particles(&iaea_id,&last_case_tmp);
@@ -436,11 +492,13 @@ int EGS_PhspScoring::flushBuffer() const {
         if (!phsp_file) {
             egsFatal("\nEGS_PhspScoring: phase space file is not open for writing.");
         }
-        //don't forget that phsp_index is incremented after every particle written to p_stack
+        //convert the whole buffer and write it with a single call
+        egs_phsp_write_struct *ws = new egs_phsp_write_struct[phsp_index > 0 ? phsp_index : 1];
         for (int j=0; j<phsp_index; j++) {
-            egs_phsp_write_struct ws(p_stack[j]);
-            phsp_file.write((char *) &ws, sizeof(ws));
+            ws[j] = egs_phsp_write_struct(p_stack[j]);
         }
+        phsp_file.write((char *) ws, phsp_index*sizeof(egs_phsp_write_struct));
+        delete [] ws;
         //store position of end of file
         iostream::off_type pos = (count+1)*sizeof(egs_phsp_write_struct);
         //update header
@@ -461,6 +519,26 @@ int EGS_PhspScoring::flushBuffer() const {
         phsp_file.write((char *) &pinc, sizeof(float));
         phsp_file.seekp(pos,ios::beg);
     }
+    else if (oformat == 2) {  //compressed format
+        EGS_PhspRecord r;
+        for (int j=0; j<phsp_index; j++) {
+            egs_phsp_write_struct ws(p_stack[j]);
+            r.latch = ws.latch;
+            r.E = ws.E;
+            r.x = ws.x;
+            r.y = ws.y;
+            r.u = ws.u;
+            r.v = ws.v;
+            r.wt = ws.wt;
+            if (!zwriter->write(&r,1)) {
+                egsFatal("\nEGS_PhspScoring: Failed to write particle data to phase space file.");
+            }
+        }
+        float emintmp = count == countg ? 0.0 : emin;
+        if (!zwriter->flush(countg,emax,emintmp,last_case)) {
+            egsFatal("\nEGS_PhspScoring: Failed to update phase space file.");
+        }
+    }
 
     phsp_index=0;
 
@@ -527,6 +605,9 @@ extern "C" {
         int ptype;
         int sdir;
         int imuscore = 0;
+        int bsize = 1000;
+        EGS_Float zposres = 1e-4, zdirres = 9.5367431640625e-7;
+        int zebits = 16, zbsize = 16384;
         float xyzconst[3];
         bool xyzisconst[3] = {false, false, false};
         string gname;
@@ -613,6 +694,7 @@ extern "C" {
             vector<string> allowed_oformat;
             allowed_oformat.push_back("EGSnrc");
             allowed_oformat.push_back("IAEA");
+            allowed_oformat.push_back("compressed");
             phspouttype = input->getInput("output format", allowed_oformat, -1);
             if (phspouttype < 0) {
                 egsFatal("\nEGS_PhspScoring: Invalid output format.\n");
@@ -645,7 +727,26 @@ extern "C" {
                 }
             }
         }
-        if (phspouttype == 0) {
+        if (phspouttype == 2) {
+            //quantization and block size for compressed format
+            if (input->getInput("position resolution",zposres)) {
+                zposres = 1e-4;
+            }
+            if (input->getInput("direction resolution",zdirres)) {
+                zdirres = 9.5367431640625e-7;
+            }
+            if (input->getInput("energy bits",zebits)) {
+                zebits = 16;
+            }
+            else if (zebits < 1 || zebits > 23) {
+                egsWarning("\nEGS_PhspScoring: Invalid no. of energy bits %d.  Will use 16.\n",zebits);
+                zebits = 16;
+            }
+            if (input->getInput("block size",zbsize) || zbsize < 1) {
+                zbsize = 16384;
+            }
+        }
+        if (phspouttype != 1) {
             //see if user wants to score multiple crossers
             if (!input->getInput("score multiple crossers", str)) {
                 vector<string> allowed_scoremc;
@@ -661,6 +762,10 @@ extern "C" {
         if (input->getInput("output directory",outdir) < 0) {
             outdir="";
         }
+        if (!input->getInput("buffer size",bsize) && bsize < 1) {
+            egsWarning("\nEGS_PhspScoring: Invalid buffer size %d.  Will use 1000.\n",bsize);
+            bsize = 1000;
+        }
         if (input->getInput("particle type", str) < 0) {
             egsInformation("EGS_PhspScoring: No input for particle type.  Will score all.\n");
             ptype = 0;
@@ -695,6 +800,8 @@ extern "C" {
         result->setScoreDir(sdir);
         result->setMuScore(imuscore);
         result->setScoreMC(iscoremc);
+        result->setBufferSize(bsize);
+        result->setCompression(zposres,zdirres,zebits,zbsize);
         return result;
     }
 }
@@ -41,6 +41,7 @@
 #include "egs_application.h"
 #include "egs_scoring.h"
 #include "egs_base_geometry.h"
+#include "egs_compressed_phsp.h"
 
 #ifdef WIN32
 
@@ -74,10 +75,11 @@ This ausgab object generates phase space data for particles using one of two met
 2. Scores particles on exiting one user-specified region and entering another.
    The user can specify multiple exit/entry region pairs.
 
-Phase space data can be scored in one of 2 possible formats:
+Phase space data can be scored in one of 3 possible formats:
 
 EGSnrc format: E,x,y,u,v,wt,latch
 IAEA format: iq,E,[x],[y],[z],u,v,wt,latch,[mu]
+compressed format: same data as EGSnrc format, stored in compressed blocks
 
 Note that in IAEA format, the user has the option of specifying a fixed x, y, and/or z coordinate
 of the scoring plane/line/point, in which case the fixed coordinates shall not be scored for each
@@ -92,14 +94,19 @@ the ausgab object definition block.
       :start ausgab object:
           library                  = egs_phsp_scoring
           name                     = some_name
-          output format            = EGSnrc or IAEA
+          output format            = EGSnrc, IAEA or compressed
           constant X               = X value (cm) at which all particles are scored (IAEA format only)
           constant Y               = Y value (cm) at which all particles are scored (IAEA format only)
           constant Z               = Z value (cm) at which all particles are scored (IAEA format only)
           particle type            = all, photons, or charged
           score mu                 = yes or no [default] (IAEA format only)
-          score multiple crossers  = no (default) or yes (EGSnrc format only)
+          score multiple crossers  = no (default) or yes (EGSnrc and compressed formats only)
           output directory         = name of output directory
+          buffer size              = no. of particles buffered before writing [default 1000]
+          position resolution      = position quantization step in cm [default 1e-4] (compressed format only)
+          direction resolution     = direction cosine quantization step [default 9.5367e-7] (compressed format only)
+          energy bits              = no. of energy mantissa bits kept (1-23) [default 16] (compressed format only)
+          block size               = no. of particles per compressed block [default 16384] (compressed format only)
 
      and one of two methods of scoring particles:
 
@@ -115,8 +122,9 @@ the ausgab object definition block.
 :stop ausgab object definition:
 \endverbatim
 
-Phase space data is output to the file some_name.egsphsp1 (EGSnrc format)
-or some_name.1.IAEAphsp and some_name.1.IAEAheader (IAEA format)
+Phase space data is output to the file some_name.egsphsp1 (EGSnrc format),
+some_name.1.IAEAphsp and some_name.1.IAEAheader (IAEA format) or
+some_name.egsphspz (compressed format).
 Note that if the user specifies constant X/Y/Z, then particles are all assumed to be scored at the
 same X/Y/Z with this(ese) values output to .IAEAheader instead of being output for each particle
 to the .IAEAphsp file.
@@ -141,6 +149,23 @@ objects in one run: a particle scored by one phase space scoring object will not
 be scored by another, unless the user has set "score multiple crossers = yes" in the
 latter.
 
+Particles are collected in a buffer of "buffer size" particles (default 1000) before
+being written to the phase space file.  In EGSnrc format, a full buffer is written
+with a single call.  Larger buffers reduce the number of write operations and header
+updates at the expense of memory.  The buffer is always written out at the end of
+each batch and at the end of the run, so that restarts work as usual.
+
+The compressed format (see EGS_CompressedPhspWriter) stores the same
+information as the EGSnrc format, but positions and direction cosines are
+quantized to "position resolution" and "direction resolution" (a resolution
+of 0 stores the value without loss) and only "energy bits" bits of the
+energy mantissa are kept (23 is lossless).  The particles are written in
+independently compressed blocks of "block size" particles with an index
+at the end of the file, which allows egs_phsp_source to start reading at
+any particle without decompressing the preceding part of the file.
+With the default settings, the compressed files are typically 2-3 times
+smaller than EGSnrc format files.
+
 If "output directory" is omitted or left blank then the output directory defaults to the
 application directory (i.e. $EGS_HOME/appname).
 
@@ -263,7 +288,7 @@ public:
             int latch = app->top_p.latch;
             //only score if: 1) it has not been scored before or
             //2) we are scoring multiple crossers (EGSnrc format only)
-            if (!(latch & bsmc()) || (oformat==0 && score_mc)) {
+            if (!(latch & bsmc()) || (oformat!=1 && score_mc)) {
                 if (score_type==0) {  //using scoring geometry
                     if (iarg == 0) {
                         phsp_before = phsp_geom->isInside(x);
@@ -314,7 +339,7 @@ public:
             int latch = app->top_p.latch;
             //only score if: 1) it has not been scored before or
             //2) we are scoring multiple crossers (EGSnrc format only)
-            if (!(latch & bsmc()) || (oformat==0 && score_mc)) {
+            if (!(latch & bsmc()) || (oformat!=1 && score_mc)) {
                 if (score_type==0) {  //using scoring geometry
                     if (iarg == 0) {
                         phsp_before = phsp_geom->isInside(x);
@@ -388,6 +413,14 @@ public:
         oformat = phspouttype;
     }
 
+    //method below pertains only to compressed format
+    void setCompression(float posres, float dirres, int ebits, int bsize) {
+        zpos_res = posres;
+        zdir_res = dirres;
+        ze_bits = ebits;
+        zblock_size = bsize;
+    }
+
     //set output directory
     void setOutDir(const string outdir) {
         phspoutdir =  outdir;
@@ -430,6 +463,13 @@ public:
         }
     }
 
+    //set the no. of particles buffered in memory before writing to file
+    void setBufferSize(const int bsize) {
+        if (bsize > 0) {
+            store_max = bsize;
+        }
+    }
+
     void storeParticle(EGS_I64 ncase);
 
     int flushBuffer() const;
@@ -505,7 +545,13 @@ protected:
     bool score_mu; //set to true if scoring mu
     float pmu; //mu value associated with particle
 
-    //back to variables common to EGSnrc and IAEA formats
+    //variables specific to compressed format
+    EGS_CompressedPhspWriter *zwriter; //the compressed file writer
+    float zpos_res, zdir_res; //position and direction quantization steps
+    int ze_bits;              //no. of energy mantissa bits kept
+    int zblock_size;          //no. of particles per compressed block
+
+    //back to variables common to all formats
 
     Particle *p_stack; //the stored particle stack
 
@@ -524,7 +570,7 @@ protected:
     EGS_I64    last_case;   //last primary history scored
     EGS_I64    current_case; //current primary history
 
-    int oformat;           //0 for EGSnrc format, 1 for IAEA format
+    int oformat;           //0 for EGSnrc format, 1 for IAEA format, 2 for compressed format
 
     int ocharge;           //particle type for output: 0--all; 1--photons; 2--charged particles
 
@@ -0,0 +1,230 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ range discard object
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+#
+#  Electron and positron range rejection.
+#
+###############################################################################
+*/
+
+
+/*! \file egs_range_discard.cpp
+ *  \brief A range rejection ausgab object: implementation
+ */
+
+#include <string>
+#include <cstdio>
+
+#include "egs_range_discard.h"
+#include "egs_input.h"
+#include "egs_functions.h"
+
+EGS_RangeDiscard::EGS_RangeDiscard(const string &Name,
+                                   EGS_ObjectFactory *f) :
+    EGS_AusgabObject(Name,f), Esave(0), safety(1.02), rm(0.5109989461),
+    tgeom(0), nmed(0) {
+    otype = "EGS_RangeDiscard";
+    erange[0] = 0;
+    erange[1] = 0;
+}
+
+EGS_RangeDiscard::~EGS_RangeDiscard() {
+    for (int iq=0; iq<2; iq++) {
+        if (erange[iq]) {
+            delete [] erange[iq];
+        }
+    }
+}
+
+void EGS_RangeDiscard::setApplication(EGS_Application *App) {
+    EGS_AusgabObject::setApplication(App);
+    if (!app) {
+        return;
+    }
+    if (app->getRM() > 0) {
+        rm = app->getRM();
+    }
+
+    int nreg = app->getnRegions();
+    is_target.assign(nreg,0);
+    int ntarget = 0;
+    if (target_regions.length() > 0) {
+        vector<int> regs;
+        app->getNumberRegions(target_regions,regs);
+        app->getLabelRegions(target_regions,regs);
+        for (size_t i=0; i<regs.size(); i++) {
+            if (regs[i] >= 0 && regs[i] < nreg) {
+                is_target[regs[i]] = 1;
+                ++ntarget;
+            }
+        }
+    }
+
+    //
+    // *** range tables for all media and the largest range of all
+    //     media (or the range in the range medium) for the distance
+    //     to the target geometry
+    //
+    for (int iq=0; iq<2; iq++) {
+        if (erange[iq]) {
+            delete [] erange[iq];
+        }
+    }
+    nmed = app->getnMedia();
+    erange[0] = new EGS_Interpolator [nmed];
+    erange[1] = new EGS_Interpolator [nmed];
+    int irange_med = -1;
+    if (range_medium.length() > 0) {
+        for (int imed=0; imed<nmed; imed++) {
+            if (range_medium == app->getMediumName(imed)) {
+                irange_med = imed;
+                break;
+            }
+        }
+        if (irange_med < 0) {
+            egsWarning("EGS_RangeDiscard::setApplication: no medium named %s"
+                       " in the geometry, using the largest range of all media"
+                       "\n",range_medium.c_str());
+        }
+    }
+    for (int iq=0; iq<2; iq++) {
+        EGS_Float log_emin = 1e30, log_emax = -1e30;
+        for (int imed=0; imed<nmed; imed++) {
+            if (!app->getRangeInterpolator(imed,2*iq-1,erange[iq][imed])) {
+                egsFatal("EGS_RangeDiscard::setApplication: the application"
+                         " does not provide stopping powers\n");
+            }
+            if (irange_med < 0 || imed == irange_med) {
+                if (erange[iq][imed].getXmin() < log_emin) {
+                    log_emin = erange[iq][imed].getXmin();
+                }
+                if (erange[iq][imed].getXmax() > log_emax) {
+                    log_emax = erange[iq][imed].getXmax();
+                }
+            }
+        }
+        int nbin = 512;
+        EGS_Float dloge = (log_emax - log_emin)/(nbin-1);
+        EGS_Float *r = new EGS_Float [nbin];
+        for (int j=0; j<nbin; j++) {
+            EGS_Float logE = log_emin + dloge*j;
+            r[j] = 0;
+            for (int imed=0; imed<nmed; imed++) {
+                if (irange_med < 0 || imed == irange_med) {
+                    EGS_Float aux = erange[iq][imed].interpolate(logE);
+                    if (aux > r[j]) {
+                        r[j] = aux;
+                    }
+                }
+            }
+        }
+        trange[iq].initialize(nbin,log_emin,log_emax,r);
+        delete [] r;
+    }
+
+    char buf[128];
+    description = "\n===========================================\n";
+    description +=  "Range rejection Object (";
+    description += name;
+    description += ")\n";
+    description += "===========================================\n";
+    sprintf(buf," - Esave                  = %g MeV\n",Esave);
+    description += buf;
+    sprintf(buf," - Range safety factor    = %g\n",safety);
+    description += buf;
+    if (tgeom) {
+        description += " - Target geometry        = ";
+        description += tgeom->getName();
+        description += "\n";
+        sprintf(buf," - Target regions         = %d\n",ntarget);
+        description += buf;
+        description += " - Range to target in     = ";
+        description += irange_med >= 0 ? range_medium : "all media";
+        description += "\n";
+    }
+    else {
+        description += " - Discarding particles that can not leave their"
+                       " region\n";
+    }
+    description += "===========================================\n\n";
+}
+
+//*********************************************************************
+// Process input for this ausgab object
+//
+//**********************************************************************
+extern "C" {
+
+    EGS_RANGE_DISCARD_EXPORT EGS_AusgabObject *createAusgabObject(
+        EGS_Input *input, EGS_ObjectFactory *f) {
+        const static char *func = "createAusgabObject(range_discard)";
+        if (!input) {
+            egsWarning("%s: null input?\n",func);
+            return 0;
+        }
+
+        EGS_Float Esave;
+        int err = input->getInput("Esave",Esave);
+        if (err || Esave <= 0) {
+            egsWarning("%s: missing/wrong 'Esave' input\n",func);
+            return 0;
+        }
+        EGS_Float safety = 1.02;
+        input->getInput("range safety factor",safety);
+        if (safety < 1) {
+            egsWarning("%s: range safety factor must not be less than 1,"
+                       " using 1\n",func);
+            safety = 1;
+        }
+
+        EGS_BaseGeometry *tgeom = 0;
+        string gname;
+        if (!input->getInput("target geometry",gname)) {
+            tgeom = EGS_BaseGeometry::getGeometry(gname);
+            if (!tgeom) {
+                egsWarning("%s: no geometry named %s exists => only discarding"
+                           " particles that can not leave their region\n",
+                           func,gname.c_str());
+            }
+        }
+
+        EGS_RangeDiscard *result = new EGS_RangeDiscard("",f);
+        result->setEsave(Esave);
+        result->setSafetyFactor(safety);
+        result->setTargetGeometry(tgeom);
+        string aux;
+        if (!input->getInput("target regions",aux)) {
+            result->setTargetRegions(aux);
+        }
+        if (!input->getInput("range medium",aux)) {
+            result->setRangeMedium(aux);
+        }
+        result->setName(input);
+        return result;
+    }
+}
@@ -0,0 +1,208 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ range discard object headers
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+#
+#  Electron and positron range rejection.
+#
+###############################################################################
+*/
+
+
+/*! \file egs_range_discard.h
+ *  \brief A range rejection ausgab object: header
+ */
+
+#ifndef EGS_RANGE_DISCARD_
+#define EGS_RANGE_DISCARD_
+
+#include "egs_ausgab_object.h"
+#include "egs_application.h"
+#include "egs_base_geometry.h"
+#include "egs_interpolator.h"
+#include "egs_math.h"
+
+#include <vector>
+
+#ifdef WIN32
+
+    #ifdef BUILD_RANGE_DISCARD_DLL
+        #define EGS_RANGE_DISCARD_EXPORT __declspec(dllexport)
+    #else
+        #define EGS_RANGE_DISCARD_EXPORT __declspec(dllimport)
+    #endif
+    #define EGS_RANGE_DISCARD_LOCAL
+
+#else
+
+    #ifdef HAVE_VISIBILITY
+        #define EGS_RANGE_DISCARD_EXPORT __attribute__ ((visibility ("default")))
+        #define EGS_RANGE_DISCARD_LOCAL  __attribute__ ((visibility ("hidden")))
+    #else
+        #define EGS_RANGE_DISCARD_EXPORT
+        #define EGS_RANGE_DISCARD_LOCAL
+    #endif
+
+#endif
+
+/*! \brief A range rejection object: header
+
+\ingroup AusgabObjects
+
+This ausgab object implements range rejection for electrons and
+positrons with a total energy below a threshold \f$E_{\rm save}\f$.
+Before each step, the residual range of such a particle, obtained from
+restricted CSDA range tables computed for each medium at initialization,
+is compared to
+- the distance to the boundaries of the current region. If the particle
+  can not leave its region, it is discarded and its kinetic energy is
+  deposited locally (positrons annihilate).
+- the distance to a target geometry, if the particle is outside of the
+  target geometry and not in one of the target regions. If the particle
+  can not reach the target geometry, it is discarded in the same way.
+  The range used in this case is the largest range in all media (or the
+  range in the medium given by <code>range medium</code>), so that the
+  decision is safe independently of the media between the particle and
+  the target.
+
+The ranges are multiplied by a safety factor before the comparison.
+Because particles are discarded with the energy that they could have
+emitted as bremsstrahlung, \f$E_{\rm save}\f$ should be chosen such that
+the radiative yield of particles with lower energies is negligible for
+the quantities of interest. This ausgab object is specified via
+\verbatim
+:start ausgab object:
+    library         = egs_range_discard
+    name            = some_name
+    Esave           = total energy in MeV
+    target regions  = list of region numbers and/or labels # optional
+    target geometry = name of a geometry enclosing the target # optional
+    range medium    = medium name # optional
+    range safety factor = factor # optional, 1.02 assumed if missing
+:stop ausgab object:
+\endverbatim
+The target geometry is typically a simple geometry (e.g. a cylinder or a
+sphere) enclosing the target regions. If it is not given, particles are
+only discarded when they can not leave their current region. Vacuum
+regions between the particles and the target geometry are not accounted
+for, and relative mass densities (see EGS_BaseGeometry::setRelativeRho())
+are only taken into account for the current region. The target regions
+are tabulated for the geometry used when the object is attached to the
+application. If the application changes the geometry during the run
+(e.g. egs_chamber), particles in regions outside of this table are only
+discarded when they can not leave their current region.
+*/
+class EGS_RANGE_DISCARD_EXPORT EGS_RangeDiscard : public EGS_AusgabObject {
+
+public:
+
+    EGS_RangeDiscard(const string &Name="", EGS_ObjectFactory *f = 0);
+
+    ~EGS_RangeDiscard();
+
+    void setApplication(EGS_Application *App);
+
+    void setEsave(EGS_Float E) {
+        Esave = E;
+    };
+
+    void setSafetyFactor(EGS_Float f) {
+        safety = f;
+    };
+
+    /*! \brief Set the target regions (numbers and/or labels) */
+    void setTargetRegions(const string &regions) {
+        target_regions = regions;
+    };
+
+    /*! \brief Set the target geometry */
+    void setTargetGeometry(EGS_BaseGeometry *g) {
+        tgeom = g;
+    };
+
+    /*! \brief Set the medium used for the range to the target geometry */
+    void setRangeMedium(const string &medname) {
+        range_medium = medname;
+    };
+
+    bool needsCall(EGS_Application::AusgabCall iarg) const {
+        return iarg == EGS_Application::BeforeTransport;
+    };
+
+    int processEvent(EGS_Application::AusgabCall iarg) {
+        if (iarg != EGS_Application::BeforeTransport) {
+            return 0;
+        }
+        int q = app->top_p.q;
+        if (!q || app->top_p.E >= Esave) {
+            return 0;
+        }
+        int ir = app->top_p.ir;
+        if (ir < 0) {
+            return 0;
+        }
+        int imed = app->getMedium(ir);
+        if (imed < 0) {
+            return 0;
+        }
+        int iq = q < 0 ? 0 : 1;
+        EGS_Float logE = log(app->top_p.E - rm);
+        EGS_Float range = safety*erange[iq][imed].interpolate(logE);
+        if (range < app->getDnear()*app->getRelativeRho(ir)) {
+            app->absorbTopParticle();
+            return 0;
+        }
+        if (tgeom && (size_t)ir < is_target.size() && !is_target[ir] &&
+                !tgeom->isInside(app->top_p.x)) {
+            EGS_Float crange = safety*trange[iq].interpolate(logE);
+            if (crange < tgeom->hownear(-1,app->top_p.x)) {
+                app->absorbTopParticle();
+            }
+        }
+        return 0;
+    };
+
+    int processEvent(EGS_Application::AusgabCall iarg, int ir) {
+        return 0;
+    };
+
+protected:
+
+    EGS_Float         Esave;          //!< total energy threshold
+    EGS_Float         safety;         //!< range safety factor
+    EGS_Float         rm;             //!< electron rest energy
+    EGS_BaseGeometry  *tgeom;         //!< the target geometry
+    string            target_regions; //!< target regions input
+    string            range_medium;   //!< medium for the target range
+    vector<char>      is_target;      //!< is a region a target region ?
+    EGS_Interpolator  *erange[2];     //!< e-/e+ range in each medium
+    EGS_Interpolator  trange[2];      //!< e-/e+ range to the target
+    int               nmed;           //!< number of media
+
+};
+
+#endif
@@ -57,6 +57,18 @@
 #include <cstdarg>
 #include <cstdlib>
 #include <cstring>
+#include <cctype>
+#include <sstream>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -95,12 +107,6 @@ struct EGS_IO           *the_egsio     = & F77_OBJ_(egs_io,EGS_IO);
 struct EGS_VarianceReduction *the_egsvr = & F77_OBJ_(egs_vr,EGS_VR);
 */
 
-#define egsGetRNGPointers F77_OBJ_(egs_get_rng_pointers,EGS_GET_RNG_POINTERS)
-extern __extc__ void egsGetRNGPointers(EGS_I32 *, EGS_I32 *);
-#define egsGetRNGArray F77_OBJ_(egs_get_rng_array,EGS_GET_RNG_ARRAY)
-extern __extc__ void egsGetRNGArray(EGS_Float *);
-#define egsSetRNGState F77_OBJ_(egs_set_rng_state,EGS_SET_RNG_STATE)
-extern __extc__ void egsSetRNGState(const EGS_I32 *, const EGS_Float *);
 #define egsGetSteps F77_OBJ_(egs_get_steps,EGS_GET_STEPS)
 extern __extc__ void egsGetSteps(double *, double *);
 #define egsSetSteps F77_OBJ_(egs_set_steps,EGS_SET_STEPS)
@@ -184,6 +190,10 @@ extern __extc__  void F77_OBJ_(egs_set_defaults,EGS_SET_DEFAULTS)();
 extern __extc__  void F77_OBJ_(egs_init1,EGS_INIT1)();
 int EGS_AdvancedApplication::initEGSnrcBackEnd() {
     F77_OBJ_(egs_set_defaults,EGS_SET_DEFAULTS)();
+    if (rndm) {
+        rndm->setExternalArray(EGS_NRANDOM,the_rng->rng_array,
+                               &the_rng->rng_seed);
+    }
     __egs_iovar(64,app_name.size(),app_name.c_str(),the_egsio->user_code);
     __egs_iovar(128,hen_house.size(),hen_house.c_str(),the_egsio->hen_house);
     __egs_iovar(128,egs_home.size(),egs_home.c_str(),the_egsio->egs_home);
@@ -399,13 +409,56 @@ public:
 };
 #endif
 
+int EGS_AdvancedApplication::max_table_regions = 4194304;
+
 EGS_AdvancedApplication::EGS_AdvancedApplication(int argc, char **argv) :
-    EGS_Application(argc,argv), nmed(0), n_rng_buffer(0), final_job(false), io_flag(0) { }
+    EGS_Application(argc,argv), nmed(0), final_job(false), io_flag(0),
+    rtable(0) { }
 
 EGS_AdvancedApplication::~EGS_AdvancedApplication() {
-    if (n_rng_buffer > 0) {
-        delete [] rng_buffer;
+    clearRegionTables();
+}
+
+void EGS_AdvancedApplication::clearRegionTables() {
+    for (size_t j=0; j<region_tables.size(); j++) {
+        delete region_tables[j];
+    }
+    region_tables.clear();
+    rtable = 0;
+}
+
+EGS_RegionTable *EGS_AdvancedApplication::findRegionTable() {
+    for (size_t j=0; j<region_tables.size(); j++) {
+        if (region_tables[j]->g == geometry) {
+            rtable = region_tables[j];
+            return rtable;
+        }
+    }
+    EGS_RegionTable *t = new EGS_RegionTable;
+    t->g = geometry;
+    t->has_rho = geometry->hasRhoScaling();
+    t->has_b = geometry->hasBScaling();
+    int nreg = geometry->regions();
+    if (nreg > 0 && nreg <= max_table_regions) {
+        t->data.resize(nreg);
+        for (int ireg=0; ireg<nreg; ireg++) {
+            EGS_RegionData &d = t->data[ireg];
+            if (!geometry->isRealRegion(ireg)) {
+                // Particles are never in a virtual region (e.g. a missing
+                // cone in a cone stack layer) => nothing to tabulate.
+                d.med = -1;
+                d.rho = 1;
+                d.bscale = 1;
+                continue;
+            }
+            d.med = geometry->medium(ireg);
+            d.rho = t->has_rho ? geometry->getRelativeRho(ireg) : 1;
+            d.bscale = t->has_b ? geometry->getBScaling(ireg) : 1;
+        }
     }
+    region_tables.push_back(t);
+    rtable = t;
+    return rtable;
 }
 
 void EGS_AdvancedApplication::describeSimulation() {
@@ -427,12 +480,331 @@ int EGS_AdvancedApplication::initCrossSections() {
 
 extern "C" void F77_OBJ_(set_elastic_parameter,SET_ELASTIC_PARAMETER)();
 
+// Identifies the layout of the data copied by egsHatchData(). Must be
+// changed whenever the list of variables in $HATCH-SNAPSHOT-DATA
+// (egs_c_interface2.macros) changes.
+static const char *egs_hatch_snapshot_id = "EGSXS002";
+
+// 64-bit FNV-1a hash of n bytes at data, accumulated into h
+static void egsSnapshotHash(unsigned long long &h, const void *data,
+                            size_t n) {
+    const unsigned long long prime = 1099511628211ULL;
+    const unsigned char *c = (const unsigned char *) data;
+    for (size_t j=0; j<n; ++j) {
+        h = (h ^ c[j])*prime;
+    }
+}
+
+static void egsSnapshotHash(unsigned long long &h, const string &str) {
+    egsSnapshotHash(h,str.c_str(),str.size()+1);
+}
+
+// Hashes the name, size and modification time of a file. Missing files
+// contribute their name only, so that creating them changes the hash.
+static void egsSnapshotHashFile(unsigned long long &h, const string &fname) {
+    egsSnapshotHash(h,fname);
+    struct stat st;
+    if (!stat(fname.c_str(),&st)) {
+        EGS_I64 size = st.st_size, mtime = st.st_mtime;
+        egsSnapshotHash(h,&size,sizeof(size));
+        egsSnapshotHash(h,&mtime,sizeof(mtime));
+    }
+}
+
+// Trimmed, lower case version of a fixed length Fortran string
+static string egsSnapshotPrefix(const char *str, int len) {
+    string s;
+    for (int j=0; j<len && str[j] && !isspace(str[j]); ++j) {
+        s += tolower(str[j]);
+    }
+    return s;
+}
+
+string EGS_AdvancedApplication::hatchSnapshotKey(const int *ind) {
+    unsigned long long h = 14695981039346656037ULL;
+    egsSnapshotHash(h,egs_hatch_snapshot_id,8);
+    int sizes[3] = {(int)sizeof(EGS_Float), MXMED, nmed};
+    egsSnapshotHash(h,sizes,sizeof(sizes));
+    for (int j=0; j<nmed; j++) {
+        egsSnapshotHash(h,string(geometry->getMediumName(j)));
+        egsSnapshotHash(h,&ind[j],sizeof(int));
+    }
+
+    // Transport parameter and cross section options
+    egsSnapshotHash(h,the_xoptions,sizeof(struct EGS_XOptions));
+    egsSnapshotHash(h,the_etcontrol,sizeof(struct EGS_EtControl));
+    egsSnapshotHash(h,&the_bounds->ecut,sizeof(EGS_Float));
+    egsSnapshotHash(h,&the_bounds->pcut,sizeof(EGS_Float));
+    egsSnapshotHash(h,the_media->pxsec,16);
+    egsSnapshotHash(h,the_media->eiixsec,16);
+    egsSnapshotHash(h,the_media->compxsec,16);
+    egsSnapshotHash(h,the_media->photonucxsec,16);
+    egsSnapshotHash(h,&the_media->nmed,sizeof(EGS_I32));
+    egsSnapshotHash(h,the_rayleigh,sizeof(struct EGS_Rayleigh));
+    egsSnapshotHash(h,&the_egsio->xsec_out,sizeof(EGS_I32));
+
+    // Media data
+    if (is_pegsless) {
+        EGS_Input *media_def = input ? input->getInputItem("media definition") : 0;
+        if (media_def) {
+            ostringstream def;
+            media_def->print(0,def);
+            egsSnapshotHash(h,def.str());
+        }
+    }
+    else {
+        egsSnapshotHashFile(h,abs_pegs_file);
+    }
+
+    // Data files read by HATCH
+    string data_dir = egsJoinPath(hen_house,"data");
+    static const char *data_files[] = {
+        "compton_sigma.data", "iaea_photonuc.data", "incoh.data",
+        "msnew.data", "nist_brems.data", "nrc_brems.data",
+        "pair_nrc1.data", "photo_cs.data", "photo_relax.data",
+        "photo_shellwise.data", "rad_compton1.data", "relax.data",
+        "spinms.data", "triplet.data", 0
+    };
+    for (int j=0; data_files[j]; j++) {
+        egsSnapshotHashFile(h,egsJoinPath(data_dir,data_files[j]));
+    }
+    static const char *pxsec_files[] = {
+        "_photo.data", "_pair.data", "_triplet.data", "_rayleigh.data", 0
+    };
+    string prefix = egsSnapshotPrefix(the_media->pxsec,16);
+    for (int j=0; pxsec_files[j]; j++) {
+        egsSnapshotHashFile(h,egsJoinPath(data_dir,prefix+pxsec_files[j]));
+    }
+    prefix = egsSnapshotPrefix(the_media->compxsec,16);
+    if (prefix.size()) {
+        egsSnapshotHashFile(h,egsJoinPath(data_dir,prefix+"_compton.data"));
+    }
+    prefix = egsSnapshotPrefix(the_media->photonucxsec,16);
+    if (prefix.size()) {
+        egsSnapshotHashFile(h,egsJoinPath(data_dir,prefix+"_photonuc.data"));
+    }
+    prefix = egsSnapshotPrefix(the_media->eiixsec,16);
+    if (prefix.size()) {
+        egsSnapshotHashFile(h,egsJoinPath(data_dir,"eii_"+prefix+".data"));
+    }
+    if (the_xoptions->iraylr > 1) {
+        for (int j=0; j<MXMED; j++) {
+            string ff = egsSnapshotPrefix(the_rayleigh->ff_file[j],128);
+            if (ff.size()) {
+                egsSnapshotHashFile(h,ff);
+            }
+        }
+    }
+
+    char buf[32];
+    sprintf(buf,"egsxs_%016llx",h);
+    return buf;
+}
+
+// Snapshot files contain the identifier, the data size, the data from
+// egsHatchData() and the identifier again to detect truncated files
+static bool egsReadHatchSnapshot(const string &fname) {
+    ifstream in(fname.c_str(),ios::binary);
+    if (!in) {
+        return false;
+    }
+    EGS_I64 size = egsHatchData(0,0), fsize;
+    char id[8];
+    in.read(id,8);
+    in.read((char *)&fsize,sizeof(fsize));
+    if (!in || memcmp(id,egs_hatch_snapshot_id,8) || fsize != size) {
+        return false;
+    }
+    char *data = new char [size];
+    in.read(data,size);
+    in.read(id,8);
+    bool ok = in && !memcmp(id,egs_hatch_snapshot_id,8);
+    if (ok) {
+        egsHatchData(2,data);
+    }
+    delete [] data;
+    return ok;
+}
+
+static bool egsWriteHatchSnapshot(const string &fname) {
+    EGS_I64 size = egsHatchData(0,0);
+    char *data = new char [size];
+    egsHatchData(1,data);
+    // Write to a temporary file first so that jobs running in
+    // parallel never see a partially written snapshot
+    char buf[32];
+    sprintf(buf,".%d",egsGetPid());
+    string tmp_file = fname + buf;
+    ofstream out(tmp_file.c_str(),ios::binary);
+    out.write(egs_hatch_snapshot_id,8);
+    out.write((const char *)&size,sizeof(size));
+    out.write(data,size);
+    out.write(egs_hatch_snapshot_id,8);
+    out.close();
+    delete [] data;
+    if (out.fail()) {
+        remove(tmp_file.c_str());
+        return false;
+    }
+    if (rename(tmp_file.c_str(),fname.c_str())) {
+        // Windows does not replace existing files
+        remove(fname.c_str());
+        if (rename(tmp_file.c_str(),fname.c_str())) {
+            remove(tmp_file.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifndef WIN32
+
+// Header of a shared memory segment with cross section data. The data
+// follows the header. ready is set by the job that created the segment
+// once the data is complete.
+struct EGS_HatchShmHeader {
+    char             id[8];
+    EGS_I64          size;
+    EGS_I32          pid;
+    volatile EGS_I32 ready;
+};
+
+static size_t egsHatchShmSize(EGS_I64 size) {
+    return sizeof(EGS_HatchShmHeader) + size;
+}
+
+// Creates the shared memory segment name. Returns the mapped segment or
+// null if the segment already exists or cannot be created.
+static EGS_HatchShmHeader *egsCreateHatchShm(const string &name) {
+    int fd = shm_open(name.c_str(),O_RDWR | O_CREAT | O_EXCL,0644);
+    if (fd < 0) {
+        return 0;
+    }
+    EGS_I64 size = egsHatchData(0,0);
+    size_t len = egsHatchShmSize(size);
+    void *p = MAP_FAILED;
+    if (!ftruncate(fd,len)) {
+        p = mmap(0,len,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+    }
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return 0;
+    }
+    EGS_HatchShmHeader *h = (EGS_HatchShmHeader *) p;
+    memcpy(h->id,egs_hatch_snapshot_id,8);
+    h->size = size;
+    h->pid = egsGetPid();
+    h->ready = 0;
+    return h;
+}
+
+// Copies the data initialized by HATCH into the segment h created by
+// egsCreateHatchShm() and marks it as ready for other jobs
+static void egsPublishHatchShm(EGS_HatchShmHeader *h) {
+    egsHatchData(1,(char *)(h+1));
+    __sync_synchronize();
+    h->ready = 1;
+    munmap(h,egsHatchShmSize(h->size));
+}
+
+// Attaches to the existing segment name, waits until the job that created
+// it has published the data and copies the data into the mortran common
+// blocks. Returns 1 on success, 0 if the data could not be attached within
+// max_wait seconds and -1 if the segment is stale, i.e., the job that
+// created it is no longer running and has not published the data.
+static int egsAttachHatchShm(const string &name, int max_wait) {
+    int fd = shm_open(name.c_str(),O_RDONLY,0);
+    if (fd < 0) {
+        return 0;
+    }
+    // The creating job sizes the segment right after creating it, a
+    // segment that is still empty after 10 seconds is left over from a
+    // job that died.
+    int status = -1;
+    struct stat st;
+    size_t len = 0;
+    void *p = MAP_FAILED;
+    for (int j=0; j<1000; j++) {
+        if (fstat(fd,&st)) {
+            status = 0;
+            break;
+        }
+        if (st.st_size >= (off_t)sizeof(EGS_HatchShmHeader)) {
+            len = st.st_size;
+            p = mmap(0,len,PROT_READ,MAP_SHARED,fd,0);
+            status = 0;
+            break;
+        }
+        usleep(10000);
+    }
+    close(fd);
+    if (p == MAP_FAILED) {
+        return status;
+    }
+    // Wait for the data before looking at the rest of the header, which
+    // may still be being initialized by the creating job
+    EGS_HatchShmHeader *h = (EGS_HatchShmHeader *) p;
+    for (int j=0; j<100*max_wait; j++) {
+        if (h->ready) {
+            status = 1;
+            break;
+        }
+        if (h->pid > 0 && kill(h->pid,0) && errno == ESRCH) {
+            // the creating job died, possibly right after publishing
+            __sync_synchronize();
+            status = h->ready ? 1 : -1;
+            break;
+        }
+        usleep(10000);
+    }
+    __sync_synchronize();
+    EGS_I64 size = egsHatchData(0,0);
+    if (status == 1 && (memcmp(h->id,egs_hatch_snapshot_id,8) ||
+                        h->size != size || len < egsHatchShmSize(size))) {
+        status = 0;
+    }
+    if (status == 1) {
+        egsHatchData(2,(char *)(h+1));
+    }
+    munmap(p,len);
+    return status;
+}
+
+// Gets the cross section data from the segment name. Returns true if the
+// data was attached from an existing segment. Otherwise shm is set to the
+// newly created segment in which the caller must publish the data after
+// calling HATCH, or to null if neither worked. A stale segment left by a
+// job that died before publishing is removed and created again.
+static bool egsOpenHatchShm(const string &name, int max_wait,
+                            EGS_HatchShmHeader *&shm) {
+    for (int attempt=0; attempt<2; attempt++) {
+        shm = egsCreateHatchShm(name);
+        if (shm) {
+            return false;
+        }
+        int status = egsAttachHatchShm(name,max_wait);
+        if (status >= 0) {
+            return status == 1;
+        }
+        egsWarning("initCrossSections(): removing stale shared memory %s\n",
+                   name.c_str());
+        shm_unlink(name.c_str());
+    }
+    return false;
+}
+
+#endif
+
 int EGS_AdvancedApplication::helpInit(EGS_Input *transportp, bool do_hatch) {
     if (!geometry) {
         egsWarning("initCrossSections(): no geometry?\n");
         return 1;
     }
     EGS_BaseGeometry::setActiveGeometryList(app_index);
+    if (do_hatch) {
+        clearRegionTables();
+    }
     int nmed_new = EGS_BaseGeometry::nMedia(), j;
     if (nmed_new < 1) {
         egsWarning("initCrossSections(): no media in this geometry?\n");
@@ -543,6 +915,11 @@ int EGS_AdvancedApplication::helpInit(EGS_Input *transportp, bool do_hatch) {
                               &the_etcontrol->bca_algorithm);
     bca.addOption("Exact");
     bca.addOption("PRESTA-I");
+    EGS_I32 use_snapshot = 0;
+    EGS_TransportProperty snapshot("Cross section snapshot",&use_snapshot);
+    snapshot.addOption("Off");
+    snapshot.addOption("On");
+    snapshot.addOption("Shared");
 
     if (transportp) {
         efield.getInput(transportp);
@@ -593,6 +970,7 @@ int EGS_AdvancedApplication::helpInit(EGS_Input *transportp, bool do_hatch) {
             the_etcontrol->transport_algorithm = 0;
         }
         bca.getInput(transportp);
+        snapshot.getInput(transportp);
 
         if (egsEquivStr(string("mcdf-xcom       "),
                         string(the_media->pxsec).substr(0,pxsec.size()))) {
@@ -623,7 +1001,62 @@ int EGS_AdvancedApplication::helpInit(EGS_Input *transportp, bool do_hatch) {
 
     if (do_hatch) {
 
-        egsHatch();
+        // Data initialized by HATCH is taken from a snapshot if available,
+        // otherwise the snapshot is created after calling HATCH
+        bool have_data = false;
+        string snapshot_file;
+        if (use_snapshot == 1) {
+            snapshot_file = egsJoinPath(app_dir,
+                                        hatchSnapshotKey(ind)+".snapshot");
+            have_data = egsReadHatchSnapshot(snapshot_file);
+            if (have_data) {
+                egsInformation("\nCross section data read from %s\n",
+                               snapshot_file.c_str());
+            }
+        }
+#ifndef WIN32
+        EGS_HatchShmHeader *shm = 0;
+        if (use_snapshot == 2) {
+            string shm_name = "/" + hatchSnapshotKey(ind);
+            have_data = egsOpenHatchShm(shm_name,600,shm);
+            if (shm) {
+                hatch_shm = shm_name;
+            }
+            else if (have_data) {
+                egsInformation("\nCross section data attached from "
+                               "shared memory %s\n",shm_name.c_str());
+            }
+            else {
+                egsWarning("initCrossSections(): failed to attach to "
+                           "shared memory %s\n",shm_name.c_str());
+            }
+        }
+#else
+        if (use_snapshot == 2) {
+            egsWarning("initCrossSections(): shared memory cross sections "
+                       "are not available on Windows\n");
+        }
+#endif
+        if (!have_data) {
+            egsHatch();
+            if (use_snapshot == 1) {
+                if (egsWriteHatchSnapshot(snapshot_file)) {
+                    egsInformation("\nCross section data stored in %s\n",
+                                   snapshot_file.c_str());
+                }
+                else {
+                    egsWarning("initCrossSections(): failed to write cross "
+                               "section snapshot %s\n",snapshot_file.c_str());
+                }
+            }
+#ifndef WIN32
+            if (shm) {
+                egsPublishHatchShm(shm);
+                egsInformation("\nCross section data published in shared "
+                               "memory %s\n",hatch_shm.c_str());
+            }
+#endif
+        }
         F77_OBJ_(set_elastic_parameter,SET_ELASTIC_PARAMETER)();
 
         the_bounds->ecut_new = the_bounds->ecut;
@@ -753,6 +1186,9 @@ int EGS_AdvancedApplication::helpInit(EGS_Input *transportp, bool do_hatch) {
     bca.info(nc);
     skind.info(nc);
     tran.info(nc);
+    if (use_snapshot) {
+        snapshot.info(nc);
+    }
     if (efield.size()==3) {
         efield.info(nc);
         the_emf->ExIN=efield_v[0];
@@ -886,6 +1322,14 @@ void EGS_AdvancedApplication::finishRun() {
 int EGS_AdvancedApplication::finishSimulation() {
     int err = EGS_Application::finishSimulation();
     egsInformation("finishSimulation(%s) %d\n",app_name.c_str(),err);
+#ifndef WIN32
+    // The shared memory cross section data is removed by the job that
+    // created it. Jobs that have already copied the data are not affected,
+    // jobs started later create a new segment.
+    if (!hatch_shm.empty()) {
+        shm_unlink(hatch_shm.c_str());
+    }
+#endif
     if (err <= 0) {
         return err;
     }
@@ -933,27 +1377,17 @@ int EGS_AdvancedApplication::outputData() {
     if (err) {
         return err;
     }
-    EGS_I32 np, ip;
-    egsGetRNGPointers(&np,&ip);
-    if (np < 1) {
-        return 11;
-    }
-    if (np > 10000000) {
-        egsWarning("EGS_AdvancedApplication::outputData(): egsGetRNGPointers"
-                   " returns a huge number? (%d)\n",np);
-        return 12;
-    }
-    EGS_Float *array = new EGS_Float [np];
-    egsGetRNGArray(array);
-    (*data_out) << "  " << np << "  " << ip << endl;
-    for (int j=0; j<np; j++) {
-        (*data_out) << array[j] << " ";
+    // The mortran random number array is the array of the RNG, which
+    // has already been stored by EGS_Application::outputData(). It is
+    // still written for compatibility with existing data files.
+    (*data_out) << "  " << EGS_NRANDOM << "  " << the_rng->rng_seed << endl;
+    for (int j=0; j<EGS_NRANDOM; j++) {
+        (*data_out) << the_rng->rng_array[j] << " ";
     }
     (*data_out) << endl;
     double ch_steps, all_steps;
     egsGetSteps(&ch_steps,&all_steps);
     (*data_out) << ch_steps << "  " << all_steps << endl;
-    delete [] array;
     return data_out->good() ? 0 : 13;
 }
 
@@ -972,15 +1406,15 @@ int EGS_AdvancedApplication::readData() {
                    "for the mortran random array? (%d)\n",np);
         return 12;
     }
-    EGS_Float *array = new EGS_Float [np];
+    // The mortran random number array was restored together with the
+    // state of the RNG by EGS_Application::readData() => skip it
+    EGS_Float tmp;
     for (int j=0; j<np; j++) {
-        (*data_in) >> array[j];
+        (*data_in) >> tmp;
     }
     if (!data_in->good()) {
         return 13;
     }
-    egsSetRNGState(&ip,array);
-    delete [] array;
     double ch_steps, all_steps;
     (*data_in) >> ch_steps >> all_steps;
     egsSetSteps(&ch_steps,&all_steps);
@@ -1003,15 +1437,15 @@ int EGS_AdvancedApplication::addState(istream &data) {
                    "for the mortran random array? (%d)\n",np);
         return 12;
     }
-    EGS_Float *array = new EGS_Float [np];
+    // The mortran random number array is part of the RNG state
+    // => skip it
+    EGS_Float tmp;
     for (int j=0; j<np; j++) {
-        data >> array[j];
+        data >> tmp;
     }
     if (!data.good()) {
         return 13;
     }
-    egsSetRNGState(&ip,array);
-    delete [] array;
     double ch_steps, all_steps;
     data >> ch_steps >> all_steps;
     double ch_steps_old, all_steps_old;
@@ -1028,16 +1462,6 @@ void EGS_AdvancedApplication::resetCounter() {
     egsSetSteps(&ch_steps,&all_steps);
 }
 
-EGS_I64 EGS_AdvancedApplication::randomNumbersUsed() const {
-    EGS_I64 nused = EGS_Application::randomNumbersUsed();
-    EGS_I32 np, ip;
-    egsGetRNGPointers(&np,&ip);
-    if (ip <= np) {
-        nused -= (np+1-ip);
-    }
-    return nused;
-}
-
 void EGS_AdvancedApplication::appInformation(const char *msg) {
     if (!msg) {
         return;
@@ -1085,85 +1509,77 @@ void EGS_AdvancedApplication::getElectronSteps(double &ch_steps,
 }
 
 void EGS_AdvancedApplication::startNewParticle() {
-    if (geometry->hasRhoScaling()) {
-        int ireg = the_stack->ir[the_stack->np-1] - 2;
-        EGS_Float rho = geometry->getRelativeRho(ireg);
-        the_useful->rhor = rho;
-        the_useful->rhor_new = rho;
-    }
-    else {
-        the_useful->rhor = 1;
-        the_useful->rhor_new = 1;
-    }
-    if (geometry->hasBScaling()) {
+    EGS_RegionTable *t = regionTable();
+    EGS_Float rho = 1, bf = 1;
+    if (t->has_rho || t->has_b) {
         int ireg = the_stack->ir[the_stack->np-1] - 2;
-        EGS_Float bf = geometry->getBScaling(ireg);
-        the_emf->Bx = bf*the_emf->BxIN;
-        the_emf->By = bf*the_emf->ByIN;
-        the_emf->Bz = bf*the_emf->BzIN;
-        the_emf->Bx_new = the_emf->Bx;
-        the_emf->By_new = the_emf->By;
-        the_emf->Bz_new = the_emf->Bz;
-    }
-    else {
-        the_emf->Bx = the_emf->BxIN;
-        the_emf->By = the_emf->ByIN;
-        the_emf->Bz = the_emf->BzIN;
-        the_emf->Bx_new = the_emf->Bx;
-        the_emf->By_new = the_emf->By;
-        the_emf->Bz_new = the_emf->Bz;
+        if (t->data.size()) {
+            const EGS_RegionData &d = t->data[ireg];
+            rho = d.rho;
+            bf = d.bscale;
+        }
+        else {
+            if (t->has_rho) {
+                rho = geometry->getRelativeRho(ireg);
+            }
+            if (t->has_b) {
+                bf = geometry->getBScaling(ireg);
+            }
+        }
     }
+    the_useful->rhor = rho;
+    the_useful->rhor_new = rho;
+    the_emf->Bx = bf*the_emf->BxIN;
+    the_emf->By = bf*the_emf->ByIN;
+    the_emf->Bz = bf*the_emf->BzIN;
+    the_emf->Bx_new = the_emf->Bx;
+    the_emf->By_new = the_emf->By;
+    the_emf->Bz_new = the_emf->Bz;
 }
 
 void EGS_AdvancedApplication::enterNewRegion() {
-    if (geometry->hasRhoScaling()) {
-        int ireg = the_epcont->irnew-2;
-        if (ireg >= 0) {
-            EGS_Float rho = geometry->getRelativeRho(ireg);
-            the_useful->rhor_new = rho;
-        }
-    }
-    else {
+    EGS_RegionTable *t = regionTable();
+    if (!t->has_rho && !t->has_b) {
         the_useful->rhor_new = 1;
+        the_emf->Bx_new = the_emf->BxIN;
+        the_emf->By_new = the_emf->ByIN;
+        the_emf->Bz_new = the_emf->BzIN;
+        return;
     }
-    if (geometry->hasBScaling()) {
-        int ireg = the_epcont->irnew-2;
-        if (ireg >= 0) {
-            EGS_Float bf = geometry->getBScaling(ireg);
-            the_emf->Bx_new = bf*the_emf->BxIN;
-            the_emf->By_new = bf*the_emf->ByIN;
-            the_emf->Bz_new = bf*the_emf->BzIN;
+    int ireg = the_epcont->irnew-2;
+    if (ireg < 0) {
+        if (!t->has_rho) {
+            the_useful->rhor_new = 1;
+        }
+        if (!t->has_b) {
+            the_emf->Bx_new = the_emf->BxIN;
+            the_emf->By_new = the_emf->ByIN;
+            the_emf->Bz_new = the_emf->BzIN;
         }
+        return;
+    }
+    EGS_Float rho, bf;
+    if (t->data.size()) {
+        const EGS_RegionData &d = t->data[ireg];
+        rho = d.rho;
+        bf = d.bscale;
     }
     else {
-        the_emf->Bx_new = the_emf->BxIN;
-        the_emf->By_new = the_emf->ByIN;
-        the_emf->Bz_new = the_emf->BzIN;
+        rho = t->has_rho ? geometry->getRelativeRho(ireg) : 1;
+        bf = t->has_b ? geometry->getBScaling(ireg) : 1;
     }
+    the_useful->rhor_new = rho;
+    the_emf->Bx_new = bf*the_emf->BxIN;
+    the_emf->By_new = bf*the_emf->ByIN;
+    the_emf->Bz_new = bf*the_emf->BzIN;
 }
 
 void EGS_AdvancedApplication::saveRNGState() {
     rndm->saveState();
-    int np,ip;
-    egsGetRNGPointers(&np,&ip);
-    if (n_rng_buffer > 0) {
-        if (np != n_rng_buffer) egsFatal("EGS_AdvancedApplication::saveRNGState:\n"
-                                             "  new buffer size (%d) is not the same as previous size(%d) ?\n",
-                                             np,n_rng_buffer);
-    }
-    else {
-        rng_buffer = new EGS_Float [np];
-        n_rng_buffer = np;
-    }
-    i_rng_buffer = ip;
-    egsGetRNGArray(rng_buffer);
 }
 
 void EGS_AdvancedApplication::resetRNGState() {
     rndm->resetState();
-    if (n_rng_buffer > 0) {
-        egsSetRNGState(&i_rng_buffer,rng_buffer);
-    }
 }
 
 //************************************************************
@@ -1198,6 +1614,18 @@ void EGS_AdvancedApplication::setRadiativeSplitting(const EGS_Float &nsplit) {
     the_egsvr->nbr_split = nsplit;
 }
 
+bool EGS_AdvancedApplication::setVRParameter(const string &name,
+        EGS_Float value) {
+    if (name == "radiative splitting") {
+        if (value < 1) {
+            return false;
+        }
+        setRadiativeSplitting(value);
+        return true;
+    }
+    return EGS_Application::setVRParameter(name,value);
+}
+
 //************************************************************
 // Utility function for ausgab phase space scoring objects
 //************************************************************
@@ -1206,6 +1634,82 @@ void EGS_AdvancedApplication::setLatch(int latch) {
     the_stack->latch[np] = latch;
 }
 
+//************************************************************
+// Utility functions for ausgab variance reduction objects
+//************************************************************
+int EGS_AdvancedApplication::getPreviousRegion() {
+    return the_epcont->irold-2;
+}
+
+void EGS_AdvancedApplication::setWeight(EGS_Float wt) {
+    int np = the_stack->np-1;
+    the_stack->wt[np] = wt;
+    top_p.wt = wt;
+}
+
+void EGS_AdvancedApplication::splitTopParticle(int nsplit) {
+    int np = the_stack->np-1;
+    if (np + nsplit > MXSTACK) {
+        egsFatal("splitTopParticle(): unable to add %d particles to the "
+                 "stack\n  increase MXSTACK in array_sizes.h\n",nsplit-1);
+    }
+    for (int i=np+1; i<np+nsplit; i++) {
+        the_stack->E[i] = the_stack->E[np];
+        the_stack->x[i] = the_stack->x[np];
+        the_stack->y[i] = the_stack->y[np];
+        the_stack->z[i] = the_stack->z[np];
+        the_stack->u[i] = the_stack->u[np];
+        the_stack->v[i] = the_stack->v[np];
+        the_stack->w[i] = the_stack->w[np];
+        the_stack->dnear[i] = the_stack->dnear[np];
+        the_stack->wt[i] = the_stack->wt[np];
+        the_stack->iq[i] = the_stack->iq[np];
+        the_stack->ir[i] = the_stack->ir[np];
+        the_stack->latch[i] = the_stack->latch[np];
+    }
+    the_stack->np += nsplit-1;
+}
+
+void EGS_AdvancedApplication::discardTopParticle() {
+    setWeight(0);
+    the_epcont->idisc = -1;
+}
+
+EGS_Float EGS_AdvancedApplication::getDnear() {
+    return the_stack->dnear[the_stack->np-1];
+}
+
+void EGS_AdvancedApplication::absorbTopParticle() {
+    the_epcont->idisc = the_stack->iq[the_stack->np-1] == 1 ? -99 : -1;
+}
+
+bool EGS_AdvancedApplication::getRangeInterpolator(int imed, int q,
+        EGS_Interpolator &range) {
+    if (imed < 0 || imed >= nmed || (q != -1 && q != 1)) {
+        return false;
+    }
+    EGS_Interpolator &dedx = q == -1 ? i_ededx[imed] : i_pdedx[imed];
+    EGS_Float log_emin = dedx.getXmin(), log_emax = dedx.getXmax();
+    int nbin = 512;
+    EGS_Float dloge = (log_emax - log_emin)/(nbin-1);
+    EGS_Float *r = new EGS_Float [nbin];
+    r[0] = 0;
+    EGS_Float dedx_old = dedx.interpolate(log_emin);
+    EGS_Float Eold = exp(log_emin), efak = exp(dloge);
+    for (int j=1; j<nbin; j++) {
+        EGS_Float E = Eold*efak;
+        EGS_Float dedx_new = dedx.interpolate(log_emin + dloge*j);
+        // use the smaller stopping power of the interval so that the
+        // range is not underestimated
+        r[j] = r[j-1] + (E-Eold)/(dedx_new < dedx_old ? dedx_new : dedx_old);
+        Eold = E;
+        dedx_old = dedx_new;
+    }
+    range.initialize(nbin,log_emin,log_emax,r);
+    delete [] r;
+    return true;
+}
+
 extern __extc__ void egsHowfar() {
     CHECK_GET_APPLICATION(app,"egsHowfar()");
     int np = the_stack->np-1;
@@ -1294,7 +1798,8 @@ extern __extc__ void egsStartParticle() {
         return;
     }
     the_epcont->idisc = 0;
-    the_useful->medium = app->getMedium(ir)+1;
+    the_useful->medium =
+        static_cast<EGS_AdvancedApplication *>(app)->regionMedium(ir)+1;
     //egsInformation("start particle: ir=%d medium=%d\n",ir,the_useful->medium);
     app->startNewParticle();
 }
@@ -56,6 +56,27 @@ class EGS_Interpolator;
   class description for a quick guideline on writing EGSnrc C++ applications.
 
  */
+/*! \brief Per-region data used by EGS_AdvancedApplication during transport.
+
+  See EGS_AdvancedApplication::regionTable().
+*/
+struct EGS_RegionData {
+    EGS_Float   rho;    //!< relative mass density
+    EGS_Float   bscale; //!< magnetic field scaling factor
+    int         med;    //!< medium index (-1 for vacuum)
+};
+
+/*! \brief The per-region data of a geometry.
+
+  See EGS_AdvancedApplication::regionTable().
+*/
+struct EGS_RegionTable {
+    EGS_BaseGeometry        *g;      //!< the geometry
+    bool                    has_rho; //!< does \a g use density scaling ?
+    bool                    has_b;   //!< does \a g use B-field scaling ?
+    vector<EGS_RegionData>  data;    //!< the data (empty if not tabulated)
+};
+
 class APP_EXPORT EGS_AdvancedApplication : public EGS_Application {
 
 public:
@@ -73,7 +94,7 @@ public:
 
     /*! \brief Destructor.
 
-      Does nothing in addition to the EGS_Application destructor.
+      Deletes the per-region data tables (see regionTable()).
     */
     virtual ~EGS_AdvancedApplication();
 
@@ -148,13 +169,6 @@ public:
      */
     void describeSimulation();
 
-    /*! \brief Get the number of random numbers used.
-
-      Re-implemented to take into account the random numbers used by
-      the mortran back-end.
-    */
-    EGS_I64 randomNumbersUsed() const;
-
     /*! \brief Get the number of condensed history and all electron steps.
 
       Implemented using the egsGetSteps() function provided by the
@@ -162,7 +176,12 @@ public:
      */
     void getElectronSteps(double &ch_steps, double &all_steps) const;
 
-    /*! Save the state of the RNG */
+    /*! \brief Save the state of the RNG
+
+      As the mortran back-end draws its random numbers from the array of
+      the RNG (see initEGSnrcBackEnd()), this also saves the state of the
+      random numbers used by the EGSnrc transport.
+    */
     virtual void saveRNGState();
 
     /*! Reset the RNG state */
@@ -184,8 +203,48 @@ public:
      quantities varying on a region-by-region bases.
     */
     void startNewParticle();
+
+    /*! \brief Called when a particle is about to enter a new region.
+
+     The default implementation passes the relative mass density and the
+     magnetic field scaling of the new region to the Mortran back-end.
+    */
     void enterNewRegion();
 
+    /*! \brief Returns the per-region data table of the current geometry.
+
+     startNewParticle(), enterNewRegion() and the medium lookup done when
+     a new particle starts are called many times per history, in
+     particular in voxel geometries. Instead of calling the virtual
+     geometry methods medium(), getRelativeRho() and getBScaling() (which
+     in composite geometries recursively call the methods of the
+     constituent geometries) each time, the data of
+     all regions is collected in a single contiguous table the first time
+     a geometry is used. Applications that switch between several
+     geometries (e.g. for correlated sampling) get one table per geometry.
+     Geometries with more than #max_table_regions regions are not
+     tabulated (the \a data vector of the returned table is empty) and
+     the geometry methods are used instead.
+    */
+    inline EGS_RegionTable *regionTable() {
+        if (rtable && rtable->g == geometry) {
+            return rtable;
+        }
+        return findRegionTable();
+    };
+
+    /*! \brief Returns the medium index in region \a ireg using C-style
+      indexing. Same as getMedium() but uses regionTable().
+    */
+    inline int regionMedium(int ireg) {
+        EGS_RegionTable *t = regionTable();
+        return t->data.size() ? t->data[ireg].med : geometry->medium(ireg);
+    };
+
+    /*! \brief Maximum number of regions for which the per-region data
+      is tabulated (see regionTable()) */
+    static int max_table_regions;
+
     /*! \brief Custom Rayleigh data setup.
 
      Set media and corresponding ff file names for
@@ -203,6 +262,23 @@ public:
     */
     void setEIIData(EGS_I32 len);
 
+    /*! \brief Cross section snapshot key.
+
+    Returns the name used for the file or the shared memory segment that
+    stores the data initialized by \c HATCH for the media with back-end
+    indices \a ind. The name contains a hash of everything the
+    cross section initialization depends on: the media, the transport
+    parameter and cross section options, the PEGS4 file (or the
+    pegsless media definitions) and the size and modification time of
+    the data files. A snapshot is therefore only reused if none of these
+    has changed. See initCrossSections().
+    */
+    string hatchSnapshotKey(const int *ind);
+
+    /*! \brief Shared memory segment with cross section data created by
+        this job (if any) */
+    string hatch_shm;
+
     //************************************************************
     // Utility functions for use with ausgab dose scoring objects
     //************************************************************
@@ -217,11 +293,30 @@ public:
     //************************************************************
     void setLatch(int latch);
 
+    //************************************************************
+    // Utility functions for ausgab variance reduction objects
+    //************************************************************
+    int getPreviousRegion();
+    void setWeight(EGS_Float wt);
+    void splitTopParticle(int nsplit);
+    void discardTopParticle();
+    EGS_Float getDnear();
+    void absorbTopParticle();
+    bool getRangeInterpolator(int imed, int q, EGS_Interpolator &range);
+
     /* Needed by some sources */
     EGS_Float getRM();
     /* Turn ON/OFF radiative splitting */
     void setRadiativeSplitting(const EGS_Float &nsplit);
 
+    /*! \brief Set a variance reduction parameter during tuning.
+
+    Supports <code>radiative splitting</code> (the number of
+    bremsstrahlung photons per event, must be at least 1). Other
+    parameters are passed to EGS_Application::setVRParameter().
+    */
+    bool setVRParameter(const string &name, EGS_Float value);
+
 protected:
 
     int              nmed;      //!< number of media
@@ -239,10 +334,6 @@ protected:
     EGS_Interpolator *i_cohe;   //!< photon Rayleigh interpolator
     EGS_Interpolator *i_photonuc;   //!< photonuclear interpolator
 
-    int n_rng_buffer;           //!< Size of the RNG buffer
-    int i_rng_buffer;           //!< Pointer to the RNG buffer
-    EGS_Float *rng_buffer;      //!< RNG buffer
-
     /*! \brief Initialize the EGSnrc mortran back-end.
 
       This function transfers the various file and directory names,
@@ -250,6 +341,10 @@ protected:
       interactive run flag, obtained in the EGS_Application constructor
       from the command line arguments, to the appropriate EGSnrc
       common block and calls the \c egs_init1 mortran subroutine.
+      The random number array of the mortran back-end is made the array
+      of the RNG #rndm using EGS_RandomGenerator::setExternalArray(), so
+      that the EGSnrc transport and all egspp objects draw random numbers
+      from a single sequence without copying them between the two.
       If the simulation is a batch run and therefore all output should
       go to a log file instead of standard output/error, the egsInformation,
       egsWarning and egsFatal variables are changed to point to functions
@@ -271,6 +366,36 @@ protected:
       about the media found in the geometry along with their cutoff energies
       and the values of all transport parameter and cross section
       options are printed using egsInformation.
+
+      Initializing the cross section data can take a significant fraction
+      of the time of short simulations or of parallel jobs with many
+      media. Using
+      \verbatim
+      Cross section snapshot = On
+      \endverbatim
+      in the transport parameter input, the data initialized by \c HATCH
+      is written to a binary file in the application directory after the
+      first initialization (see hatchSnapshotKey()) and read back instead
+      of calling \c HATCH in subsequent runs with the same media, options
+      and data files. Snapshot files can be deleted at any time; they are
+      recreated when needed. With
+      \verbatim
+      Cross section snapshot = Shared
+      \endverbatim
+      the first job of a parallel run on a node calls \c HATCH and
+      publishes the data in POSIX shared memory. Jobs started later on the
+      same node (or while the first job is still initializing) copy the
+      data from the shared memory instead of calling \c HATCH. Each job
+      copies the data into its own cross section arrays, so this only saves
+      the initialization time and does not reduce the memory used by the
+      jobs. The shared memory is removed when the job that created it
+      finishes, jobs started after that create it again. A segment left behind
+      by a job that died before publishing the data is removed and created
+      again by the next job, and jobs wait at most 10 minutes for the
+      data before calling \c HATCH themselves. This is not available
+      on Windows. On systems with a GNU C library older than 2.34, \c -lrt
+      must be added to the libraries of the application. The default is
+      \c Off.
     */
     int initCrossSections();
 
@@ -294,6 +419,16 @@ protected:
 
     int    io_flag; //!< determines how to write info
 
+    /*! \brief Finds or creates the per-region table of the current
+      geometry. Used by regionTable(). */
+    EGS_RegionTable *findRegionTable();
+
+    /*! \brief Deletes all per-region tables. */
+    void clearRegionTables();
+
+    EGS_RegionTable          *rtable;        //!< the last used table
+    vector<EGS_RegionTable *> region_tables; //!< tables of all geometries
+
 };
 
 #endif
@@ -39,6 +39,11 @@
 #include "egs_alias_table.h"
 #include "egs_functions.h"
 
+#include <cstring>
+#include <fstream>
+#include <vector>
+using namespace std;
+
 void EGS_AliasTable::clear() {
     if (n > 0) {
         delete [] fi;
@@ -115,7 +120,6 @@ void EGS_AliasTable::initialize(int N, const EGS_Float *x,
 
 void EGS_AliasTable::make() {
     EGS_Float *fcum = new EGS_Float[np];
-    bool *not_done = new bool[np];
     EGS_Float sum = 0, sum1 = 0;
     int i;
     for (i=0; i<np; i++) {
@@ -132,8 +136,6 @@ void EGS_AliasTable::make() {
         sum += fcum[i];
         wi[i] = 1;
         bin[i] = 0;
-        not_done[i] = true;
-        wi[i] = 1;
         if (type == 0) {
             sum1 += fcum[i]*xi[i];
         }
@@ -151,29 +153,32 @@ void EGS_AliasTable::make() {
         fi[np] /= sum;
     }
     sum /= np;
-    int jh, jl;
-    //egsWarning("np = %d sum = %g average = %g\n",np,sum,average);
-    for (i=0; i<np-1; i++) {
-        for (jh=0; jh<np-1; jh++) {
-            if (not_done[jh] && fcum[jh] > sum) {
-                break;
-            }
+    // Vose's method: bins below and above the average are paired up
+    // in a single pass using two work lists
+    vector<int> below, above;
+    below.reserve(np);
+    above.reserve(np);
+    for (i=0; i<np; i++) {
+        if (fcum[i] < sum) {
+            below.push_back(i);
         }
-        for (jl=0; jl<np-1; jl++) {
-            if (not_done[jl] && fcum[jl] < sum) {
-                break;
-            }
+        else {
+            above.push_back(i);
         }
-        //egsWarning(" fcum[%d] = %g fcum[%d] = %g\n",jh,fcum[jh],jl,fcum[jl]);
-        EGS_Float aux = sum - fcum[jl];
-        fcum[jh] -= aux;
-        not_done[jl] = false;
+    }
+    while (!below.empty() && !above.empty()) {
+        int jl = below.back();
+        below.pop_back();
+        int jh = above.back();
+        fcum[jh] -= sum - fcum[jl];
         wi[jl] = fcum[jl]/sum;
         bin[jl] = jh;
-        //egsWarning(" for %d wi = %g jh = %d\n",jl,wi[jl],bin[jl]);
+        if (fcum[jh] < sum) {
+            above.pop_back();
+            below.push_back(jh);
+        }
     }
     delete [] fcum;
-    delete [] not_done;
 }
 
 #define AT_NCHECK 3
@@ -300,39 +305,35 @@ EGS_SimpleAliasTable::EGS_SimpleAliasTable(int N, const EGS_Float *f) : n(0) {
         bins[i] = n+1;
     }
     sum /= n;
-    int jh, jl;
-    //egsInformation("n=%d sum=%g\n",n,sum);
-    int jh_old = 0, jl_old = 0;
-    for (i=0; i<n-1; ++i) {
-        for (jh=jh_old; jh<n-1; jh++) {
-            if (bins[jh] > n && fcum[jh] > sum) {
-                break;
-            }
-        }
-        if (fcum[jh_old] < sum && jh_old < jl_old) {
-            jl = jh_old;
+    // Vose's method, see EGS_AliasTable::make()
+    vector<int> below, above;
+    below.reserve(n);
+    above.reserve(n);
+    for (i=0; i<n; ++i) {
+        if (fcum[i] < sum) {
+            below.push_back(i);
         }
         else {
-            for (jl=jl_old; jl<n-1; jl++) {
-                if (bins[jl] > n && fcum[jl] < sum) {
-                    break;
-                }
-            }
-            jl_old = jl;
+            above.push_back(i);
         }
-        double aux = sum - fcum[jl];
-        fcum[jh] -= aux;
+    }
+    while (!below.empty() && !above.empty()) {
+        int jl = below.back();
+        below.pop_back();
+        int jh = above.back();
+        fcum[jh] -= sum - fcum[jl];
         wi[jl] = fcum[jl]/sum;
         bins[jl] = jh;
-        //egsInformation("i=%d jh=%d jl=%d w=%g\n",i,jh,jl,wi[jl]);
-        jh_old = jh; //jl_old = jl;
+        if (fcum[jh] < sum) {
+            above.pop_back();
+            below.push_back(jh);
+        }
     }
     for (i=0; i<n; ++i) {
         if (bins[i] > n) {
             bins[i] = i;
             wi[i] = 1;
         }
-        //egsInformation("alias table: %d %d %g\n",i,bins[i],wi[i]);
     }
     delete [] fcum;
 }
@@ -344,3 +345,80 @@ EGS_SimpleAliasTable::~EGS_SimpleAliasTable() {
     }
 }
 
+
+EGS_I64 EGS_SimpleAliasTable::hashProbabilities(int N, const EGS_Float *f) {
+    // 64-bit FNV-1a hash of the number of bins and the probabilities
+    unsigned long long h = 14695981039346656037ULL;
+    const unsigned long long prime = 1099511628211ULL;
+    const unsigned char *c = (const unsigned char *) &N;
+    for (size_t j=0; j<sizeof(int); ++j) {
+        h = (h ^ c[j])*prime;
+    }
+    c = (const unsigned char *) f;
+    size_t nbytes = ((size_t)N)*sizeof(EGS_Float);
+    for (size_t j=0; j<nbytes; ++j) {
+        h = (h ^ c[j])*prime;
+    }
+    return (EGS_I64) h;
+}
+
+static const char egs_alias_cache_id[8] = {'E','G','S','A','L','T','1','\0'};
+
+bool EGS_SimpleAliasTable::writeTable(const string &fname, EGS_I64 key) const {
+    if (n < 1) {
+        return false;
+    }
+    ofstream out(fname.c_str(),ios::binary);
+    if (!out) {
+        return false;
+    }
+    int fsize = sizeof(EGS_Float);
+    out.write(egs_alias_cache_id,8);
+    out.write((const char *)&key,sizeof(EGS_I64));
+    out.write((const char *)&fsize,sizeof(int));
+    out.write((const char *)&n,sizeof(int));
+    out.write((const char *)wi,((size_t)n)*sizeof(EGS_Float));
+    out.write((const char *)bins,((size_t)n)*sizeof(int));
+    return out.good();
+}
+
+bool EGS_SimpleAliasTable::readTable(const string &fname, EGS_I64 key) {
+    ifstream in(fname.c_str(),ios::binary);
+    if (!in) {
+        return false;
+    }
+    char id[8];
+    EGS_I64 fkey;
+    int fsize, N;
+    in.read(id,8);
+    in.read((char *)&fkey,sizeof(EGS_I64));
+    in.read((char *)&fsize,sizeof(int));
+    in.read((char *)&N,sizeof(int));
+    if (in.fail() || memcmp(id,egs_alias_cache_id,8) || fkey != key ||
+            fsize != sizeof(EGS_Float) || N < 1) {
+        return false;
+    }
+    EGS_Float *w = new EGS_Float [N];
+    int *b = new int [N];
+    in.read((char *)w,((size_t)N)*sizeof(EGS_Float));
+    in.read((char *)b,((size_t)N)*sizeof(int));
+    bool ok = !in.fail();
+    for (int i=0; ok && i<N; ++i) {
+        if (b[i] < 0 || b[i] >= N) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        delete [] w;
+        delete [] b;
+        return false;
+    }
+    if (n > 0) {
+        delete [] wi;
+        delete [] bins;
+    }
+    n = N;
+    wi = w;
+    bins = b;
+    return true;
+}
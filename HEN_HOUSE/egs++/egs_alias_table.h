@@ -40,6 +40,9 @@
 #include "egs_libconfig.h"
 #include "egs_rndm.h"
 
+#include <string>
+using namespace std;
+
 typedef EGS_Float(*EGS_AtFunction)(EGS_Float,void *);
 
 /*! \brief A class for sampling random values from a given probability
@@ -189,6 +192,12 @@ public:
     */
     EGS_SimpleAliasTable(int N, const EGS_Float *f);
 
+    /*! \brief Construct an empty alias table
+
+    The table must be filled using readTable() before sampling from it.
+    */
+    EGS_SimpleAliasTable() : n(0) {};
+
     /*! \brief Destructor */
     ~EGS_SimpleAliasTable();
 
@@ -201,6 +210,33 @@ public:
         return rndm->getUniform() < wi[bin] ? bin : bins[bin];
     };
 
+    /*! \brief The number of bins */
+    int size() const {
+        return n;
+    };
+
+    /*! \brief Returns a hash of the \a N probabilities \a f
+
+    The hash can be used as the key for writeTable() and readTable() to
+    make sure that a table stored on disk was built from the same
+    probabilities.
+    */
+    static EGS_I64 hashProbabilities(int N, const EGS_Float *f);
+
+    /*! \brief Write the table to the binary file \a fname
+
+    The key \a key is stored with the table. Returns \c true on success.
+    */
+    bool writeTable(const string &fname, EGS_I64 key) const;
+
+    /*! \brief Read a table written with writeTable() from the file \a fname
+
+    Returns \c false, leaving the table unchanged, if the file can not be
+    read, was written with a different key, or was written by a build
+    using a different floating point type.
+    */
+    bool readTable(const string &fname, EGS_I64 key);
+
 private:
 
     int       n;          //!< number of subintervals
@@ -47,10 +47,12 @@
 #include "egs_base_source.h"
 #include "egs_simple_container.h"
 #include "egs_ausgab_object.h"
+#include "egs_timer.h"
 
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
 #include <vector>
 #include <fstream>
 #include <sys/types.h>
@@ -777,6 +779,10 @@ int EGS_Application::runSimulation() {
         return 1;
     }
 
+    if (run->getRestart() == 0) {
+        tuneVarianceReduction();
+    }
+
     int start_status = run->startSimulation();
     if (start_status) {
         if (start_status < 0) {
@@ -835,6 +841,126 @@ int EGS_Application::runSimulation() {
     return 0;
 }
 
+int EGS_Application::tuneVarianceReduction() {
+    if (!input) {
+        return 0;
+    }
+    EGS_Input *ivr = input->getInputItem("variance reduction tuning");
+    if (!ivr) {
+        return 0;
+    }
+    vector<string> names;
+    vector<vector<EGS_Float> > values;
+    EGS_Input *ip;
+    while ((ip = ivr->takeInputItem("parameter")) != 0) {
+        string name;
+        vector<EGS_Float> v;
+        int err1 = ip->getInput("name",name);
+        int err2 = ip->getInput("values",v);
+        if (err1 || err2 || v.size() < 1) {
+            egsWarning("tuneVarianceReduction: a parameter needs a name and"
+                       " at least one value -> ignoring it\n");
+        }
+        else if (!setVRParameter(name,v[0])) {
+            egsWarning("tuneVarianceReduction: '%s' is not a tunable"
+                       " parameter of this application -> ignoring it\n",
+                       name.c_str());
+        }
+        else {
+            names.push_back(name);
+            values.push_back(v);
+        }
+        delete ip;
+    }
+    EGS_I64 nhist = 0;
+    int err = ivr->getInput("histories",nhist);
+    delete ivr;
+    if (err || nhist < 2) {
+        egsWarning("tuneVarianceReduction: missing or invalid number of"
+                   " histories per pilot run -> no tuning\n");
+        return 0;
+    }
+    int npar = names.size();
+    if (npar < 1) {
+        return 0;
+    }
+
+    int ntot = 1;
+    for (int j=0; j<npar; j++) {
+        ntot *= values[j].size();
+    }
+    egsInformation("\nVariance reduction tuning: %d pilot runs with %lld"
+                   " histories each\n",ntot,nhist);
+    egsInformation("===================================================="
+                   "===================\n");
+    for (int j=0; j<npar; j++) {
+        egsInformation("%-20s ",names[j].c_str());
+    }
+    egsInformation("%12s %12s %12s\n","rel. unc.","cpu time","efficiency");
+
+    vector<size_t> index(npar,0), best(npar,0);
+    double best_eff = -1;
+    int nrun = 0;
+    for (int irun=0; irun<ntot; irun++) {
+        for (int j=0; j<npar; j++) {
+            setVRParameter(names[j],values[j][index[j]]);
+        }
+        resetCounter();
+        EGS_Timer timer;
+        timer.start();
+        bool ok = true;
+        for (EGS_I64 icase=0; icase<nhist; icase++) {
+            if (simulateSingleShower()) {
+                ok = false;
+                break;
+            }
+        }
+        double cpu = timer.time();
+        ++nrun;
+        double sum=0, sum2=0, norm=1, count=0;
+        getCurrentResult(sum,sum2,norm,count);
+        double eff = -1, r2 = -1;
+        if (ok && sum > 0 && count > 1) {
+            r2 = (count*sum2/(sum*sum) - 1)/(count - 1);
+            if (r2 > 0 && cpu > 0) {
+                eff = 1/(r2*cpu);
+            }
+        }
+        for (int j=0; j<npar; j++) {
+            egsInformation("%-20g ",values[j][index[j]]);
+        }
+        if (eff > 0) {
+            egsInformation("%11.4f%% %12.3f %12.4g\n",100*sqrt(r2),cpu,eff);
+            if (eff > best_eff) {
+                best_eff = eff;
+                best = index;
+            }
+        }
+        else {
+            egsInformation("%12s %12.3f %12s\n","-",cpu,"-");
+        }
+        for (int j=npar-1; j>=0; j--) {
+            if (++index[j] < values[j].size()) {
+                break;
+            }
+            index[j] = 0;
+        }
+    }
+
+    if (best_eff <= 0) {
+        egsWarning("tuneVarianceReduction: no pilot run produced a usable"
+                   " result -> using the first parameter values\n");
+    }
+    egsInformation("\nUsing ");
+    for (int j=0; j<npar; j++) {
+        setVRParameter(names[j],values[j][best[j]]);
+        egsInformation("%s = %g%s",names[j].c_str(),values[j][best[j]],
+                       j < npar-1 ? ", " : "\n\n");
+    }
+    resetCounter();
+    return nrun;
+}
+
 int EGS_Application::simulateSingleShower() {
     int ireg;
     int ntry = 0;
@@ -849,6 +975,7 @@ int EGS_Application::simulateSingleShower() {
         }
         current_case =
             source->getNextParticle(rndm,p.q,p.latch,p.E,p.wt,p.x,p.u);
+        EGS_BaseGeometry::setMU(getMU());
         ireg = geometry->isWhere(p.x);
         if (ireg < 0) {
             EGS_Float t = veryFar;
@@ -872,6 +999,7 @@ int EGS_Application::simulateSingleShower() {
 }
 
 int EGS_Application::startNewShower() {
+    EGS_BaseGeometry::setMU(getMU());
     if (current_case != last_case) {
         for (int j=0; j<a_objects_list.size(); ++j) {
             a_objects_list[j]->setCurrentCase(current_case);
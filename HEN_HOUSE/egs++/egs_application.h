@@ -54,6 +54,7 @@ class EGS_RandomGenerator;
 class EGS_RunControl;
 class EGS_GeometryHistory;
 class EGS_AusgabObject;
+class EGS_Interpolator;
 //template <class T> class EGS_SimpleContainer;
 
 /*! \brief A structure holding the information of one particle
@@ -340,9 +341,55 @@ public:
      non-zero status.
      The loop over batches is terminated if either
      startBatch() or finishBatch() returns a non-zero status.
+     For fresh calculations, tuneVarianceReduction() is called before
+     the simulation is started.
     */
     virtual int runSimulation();
 
+    /*! \brief Select variance reduction parameters using short pilot runs.
+
+     If the input contains
+     \verbatim
+     :start variance reduction tuning:
+         :start parameter:
+             name   = name of a variance reduction parameter
+             values = list of values to try
+         :stop parameter:
+         # more parameters as needed
+         histories = number of histories per pilot run
+     :stop variance reduction tuning:
+     \endverbatim
+     a pilot run with the given number of histories is done for each
+     combination of the parameter values. The efficiency
+     \f$\epsilon = 1/(s^2 T)\f$, where \f$s\f$ is the relative uncertainty of the
+     result reported by getCurrentResult() and \f$T\f$ the CPU time of the pilot
+     run, is computed for each combination, the parameters are set to
+     the combination with the highest efficiency and the application is reset
+     with resetCounter() before the production run.
+     The parameters are set using setVRParameter(), so only parameters
+     supported by the application can be tuned. EGS_AdvancedApplication
+     supports <code>radiative splitting</code>. egs_chamber adds
+     <code>photon splitting</code> and <code>XCSE factor</code>, and
+     egs_cbct adds <code>primary splitting</code>, <code>secondary
+     splitting</code> and <code>PDIS splitting factor</code>. The
+     egs_chamber and egs_cbct parameters can only be tuned if the technique
+     is turned on in the variance reduction input. In parallel runs each job
+     does its own pilot runs. Returns the number of pilot runs done.
+    */
+    int tuneVarianceReduction();
+
+    /*! \brief Set the variance reduction parameter \a name to \a value.
+
+     This virtual function should be re-implemented in derived classes
+     that have variance reduction parameters which can be tuned with
+     tuneVarianceReduction(). It must return true if \a name is a
+     parameter of the application and \a value an acceptable value, false
+     otherwise. The default implementation returns false.
+    */
+    virtual bool setVRParameter(const string &name, EGS_Float value) {
+        return false;
+    };
+
     /*! \brief Analyze and output the results.
 
      The default implementation of this function calls
@@ -1134,6 +1181,51 @@ public:
     //************************************************************
     virtual void setLatch(int latch) {};
 
+    //************************************************************
+    // Utility functions for ausgab variance reduction objects
+    //************************************************************
+    /*! \brief Returns the region of the top particle before the last step
+      (-1 if outside the geometry) */
+    virtual int getPreviousRegion() {
+        return -1;
+    };
+    /*! \brief Sets the statistical weight of the top particle */
+    virtual void setWeight(EGS_Float wt) {};
+    /*! \brief Splits the top particle into \a nsplit identical particles.
+
+      The weight of the particles is not changed.
+    */
+    virtual void splitTopParticle(int nsplit) {};
+    /*! \brief Discards the top particle at the end of the current step
+      without depositing its energy. */
+    virtual void discardTopParticle() {};
+    /*! \brief Returns the random number generator of this application */
+    EGS_RandomGenerator *getRNG() {
+        return rndm;
+    };
+    /*! \brief Returns a lower bound of the distance from the top particle
+      to the boundaries of its region */
+    virtual EGS_Float getDnear() {
+        return 0;
+    };
+    /*! \brief Discards the top charged particle at the end of the current
+      step depositing its kinetic energy locally (positrons annihilate) */
+    virtual void absorbTopParticle() {};
+    /*! \brief Initializes \a range to interpolate the restricted CSDA range
+      in cm of electrons (\a q = -1) or positrons (\a q = 1) in medium
+      \a imed as a function of the logarithm of the kinetic energy.
+
+      Returns false if the stopping powers are not available.
+    */
+    virtual bool getRangeInterpolator(int imed, int q,
+                                      EGS_Interpolator &range) {
+        return false;
+    };
+    /*! \brief Returns the relative mass density in region \a ireg */
+    EGS_Float getRelativeRho(int ireg) {
+        return geometry->getRelativeRho(ireg);
+    };
+
 };
 
 #define APP_MAIN(app_name) \
@@ -49,6 +49,8 @@
 
 #include <algorithm>
 #include <vector>
+#include <map>
+#include <set>
 #include <cstdio>
 #include <cstdarg>
 #include <cstdlib>
@@ -69,7 +71,10 @@ public:
     int nnow, ntot;
     EGS_BaseGeometry **geoms;
     vector<string> media;
+    map<string,EGS_BaseGeometry *> gindex;  // geometries by name
+    map<string,int> mindex;                 // media indices by name
     vector<EGS_Library *> glibs;
+    map<string,EGS_Library *> glib_index;   // loaded libraries by name
     static string geom_delimeter;
     static string libkey;
     static string create_key;
@@ -127,6 +132,7 @@ public:
 
     void clearGeometries() {
         media.clear();
+        mindex.clear();
         if (!ntot) {
             return;
         }
@@ -174,40 +180,69 @@ public:
         if (!g) {
             return -1;
         }
-        for (int j=0; j<nnow; j++) {
-            if (geoms[j]->getName() == g->getName()) {
-                return -1;
-            }
+        if (getGeometry(g->getName())) {
+            return -1;
         }
         if (nnow >= ntot) {
-            grow(10);
+            grow(ntot > 10 ? ntot : 10);
         }
+        gindex[g->getName()] = g;
         geoms[nnow++] = g;
         return nnow-1;
 
     };
 
+    /*! Update the name index after \a g was renamed from \a oldname.
+        If another geometry already has the new name, the index keeps
+        pointing to the geometry added first (createGeometry() treats
+        duplicate names as a fatal error).
+     */
+    void renameGeometry(EGS_BaseGeometry *g, const string &oldname) {
+        map<string,EGS_BaseGeometry *>::iterator it = gindex.find(oldname);
+        if (it != gindex.end() && it->second == g) {
+            gindex.erase(it);
+        }
+        EGS_BaseGeometry *&entry = gindex[g->getName()];
+        if (!entry || entry->getName() != g->getName()) {
+            entry = g;
+        }
+    };
+
     void removeGeometry(EGS_BaseGeometry *g) {
-        ntot--;
-        EGS_BaseGeometry **tmp = new EGS_BaseGeometry* [ntot];
+        const string &name = g->getName();
+        map<string,EGS_BaseGeometry *>::iterator it = gindex.find(name);
+        bool reindex = it != gindex.end() && it->second == g;
+        if (reindex) {
+            gindex.erase(it);
+        }
         int i=0;
         for (int j=0; j<nnow; j++) {
             if (geoms[j] != g) {
-                tmp[i++] = geoms[j];
+                if (reindex && geoms[j]->getName() == name) {
+                    gindex[name] = geoms[j];
+                    reindex = false;
+                }
+                geoms[i++] = geoms[j];
             }
         }
-        if (geoms) {
-            delete [] geoms;
-        }
-        nnow--;
-        geoms = tmp;
+        nnow = i;
     };
 
     EGS_BaseGeometry *getGeometry(const string &name) {
+        map<string,EGS_BaseGeometry *>::iterator it = gindex.find(name);
+        if (it == gindex.end()) {
+            return 0;
+        }
+        if (it->second->getName() == name) {
+            return it->second;
+        }
+        // the name was changed without going through setName()
         for (int j=0; j<nnow; j++)
             if (geoms[j]->getName() == name) {
+                it->second = geoms[j];
                 return geoms[j];
             }
+        gindex.erase(it);
         return 0;
     };
 
@@ -215,20 +250,18 @@ public:
         if (EGS_Input::compare(Name,"vacuum")) {
             return -1;
         }
-        for (unsigned int j=0; j<media.size(); j++)
-            if (media[j] == Name) {
-                return j;
-            }
+        map<string,int>::iterator it = mindex.find(Name);
+        if (it != mindex.end()) {
+            return it->second;
+        }
         media.push_back(Name);
+        mindex[Name] = media.size()-1;
         return media.size()-1;
     };
 
     int getMediumIndex(const string &Name) {
-        for (unsigned int j=0; j<media.size(); j++)
-            if (media[j] == Name) {
-                return j;
-            }
-        return -1;
+        map<string,int>::iterator it = mindex.find(Name);
+        return it != mindex.end() ? it->second : -1;
     };
 
     int nMedia() const {
@@ -317,6 +350,8 @@ static char buf_unique[32];
 
 int EGS_BaseGeometry::error_flag = 0;
 
+EGS_Float EGS_BaseGeometry::current_mu = -1;
+
 #ifndef SKIP_DOXYGEN
 EGS_BaseGeometry *EGS_GeometryPrivate::createSingleGeometry(EGS_Input *i) {
     string libname;
@@ -331,11 +366,9 @@ EGS_BaseGeometry *EGS_GeometryPrivate::createSingleGeometry(EGS_Input *i) {
         return 0;
     }
     EGS_Library *lib = 0;
-    for (unsigned int j=0; j<glibs.size(); j++) {
-        if (libname == glibs[j]->libraryName()) {
-            lib = glibs[j];
-            break;
-        }
+    map<string,EGS_Library *>::iterator it = glib_index.find(libname);
+    if (it != glib_index.end()) {
+        lib = it->second;
     }
     if (!lib) {
         lib = new EGS_Library(libname.c_str(),dso_path.c_str());
@@ -346,6 +379,7 @@ EGS_BaseGeometry *EGS_GeometryPrivate::createSingleGeometry(EGS_Input *i) {
             return 0;
         }
         glibs.push_back(lib);
+        glib_index.insert(make_pair(string(lib->libraryName()),lib));
     }
     EGS_GeometryCreationFunction gcreate = (EGS_GeometryCreationFunction)
                                            lib->resolve(EGS_GeometryPrivate::create_key.c_str());
@@ -566,17 +600,13 @@ EGS_BaseGeometry *EGS_BaseGeometry::createGeometry(EGS_Input *input) {
         delete ij;
     }
     // Check to make sure that geometries have unique names
+    set<string> gnames;
     for (int j=0; j<egs_geometries[active_glist].nnow; j++) {
-        string gname = egs_geometries[active_glist].geoms[j]->getName();
-        for (int k=0; k<egs_geometries[active_glist].nnow; k++) {
-            if (k == j) {
-                continue;
-            }
-            if (gname == egs_geometries[active_glist].geoms[k]->getName()) {
-                egsFatal("\ncreateGeometry: Error: multiple geometries with"
-                         " the same name exist: %s\n\n", gname.c_str());
-                return 0;
-            }
+        const string &gname = egs_geometries[active_glist].geoms[j]->getName();
+        if (!gnames.insert(gname).second) {
+            egsFatal("\ncreateGeometry: Error: multiple geometries with"
+                     " the same name exist: %s\n\n", gname.c_str());
+            return 0;
         }
     }
     if (error) {
@@ -607,10 +637,14 @@ string EGS_BaseGeometry::getUniqueName() {
 }
 
 void EGS_BaseGeometry::setName(EGS_Input *i) {
+    string oldname(name);
     int err = i->getInput("name",name);
     if (err) {
         name = getUniqueName();
     }
+    if (name != oldname) {
+        egs_geometries[active_glist].renameGeometry(this,oldname);
+    }
     EGS_Input *inp;
     int irep=0;
     while ((inp = i->takeInputItem("replica"))) {
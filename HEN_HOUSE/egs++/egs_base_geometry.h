@@ -703,6 +703,24 @@ public:
         error_flag = 0;
     };
 
+    /*! \brief Set the synchronization parameter \f$\mu\f$ of the current
+      history.
+
+      This is called by the application once per history with the \f$\mu\f$
+      value of the source (or -1 if the source does not provide one), so
+      that geometries moving with a dynamic source
+      (see EGS_TransformedGeometry) can update their position without
+      querying the application on every step.
+    */
+    static void setMU(EGS_Float mu) {
+        current_mu = mu;
+    };
+
+    /*! \brief Get the synchronization parameter \f$\mu\f$ set with setMU() */
+    static EGS_Float getMU() {
+        return current_mu;
+    };
+
     /*! \brief Get the value of the boundary tolerance */
     EGS_Float getBoundaryTolerance() {
         return boundaryTolerance;
@@ -839,6 +857,9 @@ protected:
     /*! \brief Set to non-zero status if a geometry problem is encountered */
     static int       error_flag;
 
+    /*! \brief The \f$\mu\f$ of the current history (see setMU()) */
+    static EGS_Float current_mu;
+
     /*! \brief Labels
 
         This variable holds the list of labels for the geometry. Each label
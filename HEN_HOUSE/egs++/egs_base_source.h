@@ -45,6 +45,7 @@
 #include "egs_functions.h"
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include "egs_math.h"
 
@@ -53,6 +54,103 @@ using namespace std;
 class EGS_Input;
 class EGS_RandomGenerator;
 
+/*! \brief A block of source particles.
+
+  \ingroup egspp_main
+
+  Stores the parameters of a number of source particles in a structure
+  of arrays layout, so that operations applied to all particles (\em e.g.
+  transformations of positions and directions) can be performed in
+  tight loops over contiguous arrays. Filled by
+  EGS_BaseSource::getNextParticles().
+*/
+class EGS_EXPORT EGS_ParticleBlock {
+
+public:
+
+    EGS_ParticleBlock() : n(0) {};
+
+    /*! \brief Set the number of particles in the block to \a N */
+    void resize(int N) {
+        if (N > (int)E.size()) {
+            q.resize(N);
+            latch.resize(N);
+            E.resize(N);
+            wt.resize(N);
+            x.resize(N);
+            y.resize(N);
+            z.resize(N);
+            u.resize(N);
+            v.resize(N);
+            w.resize(N);
+            ncase.resize(N);
+        }
+        n = N;
+    };
+
+    /*! \brief The number of particles in the block */
+    int size() const {
+        return n;
+    };
+
+    /*! \brief Set the parameters of particle \a j */
+    void set(int j, int Q, int Latch, EGS_Float e, EGS_Float Wt,
+             const EGS_Vector &X, const EGS_Vector &U, EGS_I64 Ncase) {
+        q[j] = Q;
+        latch[j] = Latch;
+        E[j] = e;
+        wt[j] = Wt;
+        x[j] = X.x;
+        y[j] = X.y;
+        z[j] = X.z;
+        u[j] = U.x;
+        v[j] = U.y;
+        w[j] = U.z;
+        ncase[j] = Ncase;
+    };
+
+    /*! \brief Set particle \a j to particle \a k of block \a b */
+    void copy(int j, const EGS_ParticleBlock &b, int k) {
+        q[j] = b.q[k];
+        latch[j] = b.latch[k];
+        E[j] = b.E[k];
+        wt[j] = b.wt[k];
+        x[j] = b.x[k];
+        y[j] = b.y[k];
+        z[j] = b.z[k];
+        u[j] = b.u[k];
+        v[j] = b.v[k];
+        w[j] = b.w[k];
+        ncase[j] = b.ncase[k];
+    };
+
+    /*! \brief Get the parameters of particle \a j */
+    EGS_I64 get(int j, int &Q, int &Latch, EGS_Float &e, EGS_Float &Wt,
+                EGS_Vector &X, EGS_Vector &U) const {
+        Q = q[j];
+        Latch = latch[j];
+        e = E[j];
+        Wt = wt[j];
+        X = EGS_Vector(x[j],y[j],z[j]);
+        U = EGS_Vector(u[j],v[j],w[j]);
+        return ncase[j];
+    };
+
+    vector<int>       q;     //!< Charges
+    vector<int>       latch; //!< Latches
+    vector<EGS_Float> E;     //!< Kinetic energies
+    vector<EGS_Float> wt;    //!< Statistical weights
+    vector<EGS_Float> x, y, z; //!< Positions
+    vector<EGS_Float> u, v, w; //!< Directions
+    /*! Number of statistically independent particles sampled so far
+        after each particle (the return value of getNextParticle()) */
+    vector<EGS_I64>   ncase;
+
+protected:
+
+    int n;
+};
+
 /*! \brief Base source class. All particle sources must be derived from
   this class.
 
@@ -133,6 +231,31 @@ public:
                                     EGS_Float &E, EGS_Float &wt,       // energy and weight
                                     EGS_Vector &x, EGS_Vector &u) = 0; // position and direction
 
+    /*! \brief Sample the next \a n source particles into the block \a p.
+     *
+     *  Returns the number of statistically independent particles sampled
+     *  so far after the last particle in the block (\a n must be positive).
+     *  The default implementation calls getNextParticle() \a n times.
+     *  Derived classes can re-implement this method to avoid the
+     *  per-particle overhead (\em e.g. by transforming all particles of
+     *  the block at once). The particles need not be the same as the ones
+     *  that \a n calls to getNextParticle() would produce, but must be
+     *  sampled from the same distribution.
+     */
+    virtual EGS_I64 getNextParticles(EGS_RandomGenerator *rndm, int n,
+                                     EGS_ParticleBlock &p) {
+        p.resize(n);
+        EGS_I64 c = 0;
+        int q, latch;
+        EGS_Float E, wt;
+        EGS_Vector x, u;
+        for (int j=0; j<n; j++) {
+            c = getNextParticle(rndm,q,latch,E,wt,x,u);
+            p.set(j,q,latch,E,wt,x,u,c);
+        }
+        return c;
+    };
+
     /*! \brief Set the next simulation chunk to start at \a nstart and
       to consist of \a nrun particles.
 
@@ -616,6 +739,32 @@ public:
         return ++count;
     };
 
+    /*! \brief Sample the next \a n source particles into the block \a p.
+     *
+     * Same as getNextParticle() for \a n particles, but without the
+     * per-particle virtual call overhead. The particles are identical to
+     * the ones obtained from \a n calls to getNextParticle().
+     */
+    virtual EGS_I64 getNextParticles(EGS_RandomGenerator *rndm, int n,
+                                     EGS_ParticleBlock &p) {
+        p.resize(n);
+        EGS_Vector x, u;
+        for (int j=0; j<n; j++) {
+            p.q[j] = q;
+            p.E[j] = s->sampleEnergy(rndm);
+            getPositionDirection(rndm,x,u,p.wt[j]);
+            setLatch(p.latch[j]);
+            p.x[j] = x.x;
+            p.y[j] = x.y;
+            p.z[j] = x.z;
+            p.u[j] = u.x;
+            p.v[j] = u.y;
+            p.w[j] = u.z;
+            p.ncase[j] = ++count;
+        }
+        return count;
+    };
+
     /*! \brief Sample a particle position and direction.
      *
      * This pure virtual function must be implemented in classes deriving
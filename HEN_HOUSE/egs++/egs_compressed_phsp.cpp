@@ -0,0 +1,741 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ compressed phase space files
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+*/
+
+
+/*! \file egs_compressed_phsp.cpp
+ *  \brief Reading and writing compressed, indexed phase space files
+ */
+
+#include "egs_compressed_phsp.h"
+#include "egs_functions.h"
+
+#include <cstring>
+#include <cmath>
+
+#ifndef SKIP_DOXYGEN
+
+// The file starts with a fixed size header:
+//   char[8]  magic
+//   int      version, byte order marker, block size, energy bits
+//   float    position and direction resolution
+//   EGS_I64  number of particles, number of photons
+//   float    emax, emin, pinc
+//   EGS_I64  offset of the block index
+//   int      number of blocks
+// followed by the compressed blocks and the index (nblock+1 offsets).
+static const char    phspz_magic[] = "EGSPHSPZ";
+static const int     phspz_version = 1;
+static const int     phspz_header_size = 72;
+static const int     phspz_nfield = 7;
+
+union __egs_phspz_data32 {
+    int      i;
+    unsigned u;
+    float    f;
+};
+
+static inline unsigned zigzag(int i) {
+    return (((unsigned) i) << 1) ^ ((unsigned)(i >> 31));
+}
+
+static inline int unzigzag(unsigned u) {
+    return (int)(u >> 1) ^ -((int)(u & 1));
+}
+
+/*  An adaptive binary range coder (the same scheme as used in LZMA).
+    Bytes are coded bit by bit with a binary tree of probabilities,
+    using a separate tree for each byte of each particle field.
+*/
+class EGS_LOCAL EGS_PhspzModel {
+public:
+    unsigned short p[phspz_nfield][4][256];
+    EGS_PhspzModel() {
+        for (int i=0; i<phspz_nfield; i++) for (int j=0; j<4; j++)
+                for (int k=0; k<256; k++) {
+                    p[i][j][k] = 1024;
+                }
+    };
+};
+
+class EGS_LOCAL EGS_PhspzEncoder {
+public:
+    EGS_PhspzEncoder(vector<unsigned char> &Out) : out(Out), low(0),
+        range(0xffffffff), cache(0), cache_size(1) {};
+    void encodeBit(unsigned short &prob, int bit) {
+        unsigned bound = (range >> 11)*prob;
+        if (!bit) {
+            range = bound;
+            prob += (2048 - prob) >> 5;
+        }
+        else {
+            low += bound;
+            range -= bound;
+            prob -= prob >> 5;
+        }
+        while (range < 16777216U) {
+            range <<= 8;
+            shiftLow();
+        }
+    };
+    void encodeByte(unsigned short *probs, int byte) {
+        int m = 1;
+        for (int j=7; j>=0; j--) {
+            int bit = (byte >> j) & 1;
+            encodeBit(probs[m],bit);
+            m = (m << 1) | bit;
+        }
+    };
+    void finish() {
+        for (int j=0; j<5; j++) {
+            shiftLow();
+        }
+    };
+private:
+    vector<unsigned char> &out;
+    unsigned long long low;
+    unsigned range;
+    unsigned char cache;
+    EGS_I64 cache_size;
+    void shiftLow() {
+        if ((unsigned) low < 0xff000000U || (low >> 32) != 0) {
+            unsigned char carry = (unsigned char)(low >> 32);
+            unsigned char tmp = cache;
+            do {
+                out.push_back((unsigned char)(tmp + carry));
+                tmp = 0xff;
+            }
+            while (--cache_size != 0);
+            cache = (unsigned char)(((unsigned) low) >> 24);
+        }
+        cache_size++;
+        low = (low & 0x00ffffffU) << 8;
+    };
+};
+
+class EGS_LOCAL EGS_PhspzDecoder {
+public:
+    EGS_PhspzDecoder(const unsigned char *Data, const unsigned char *End) :
+        data(Data), end(End), range(0xffffffff), code(0) {
+        for (int j=0; j<5; j++) {
+            code = (code << 8) | nextByte();
+        }
+    };
+    int decodeBit(unsigned short &prob) {
+        unsigned bound = (range >> 11)*prob;
+        int bit;
+        if (code < bound) {
+            range = bound;
+            prob += (2048 - prob) >> 5;
+            bit = 0;
+        }
+        else {
+            code -= bound;
+            range -= bound;
+            prob -= prob >> 5;
+            bit = 1;
+        }
+        while (range < 16777216U) {
+            range <<= 8;
+            code = (code << 8) | nextByte();
+        }
+        return bit;
+    };
+    int decodeByte(unsigned short *probs) {
+        int m = 1;
+        for (int j=0; j<8; j++) {
+            m = (m << 1) | decodeBit(probs[m]);
+        }
+        return m - 256;
+    };
+    bool overrun() const {
+        return data > end + 4;
+    };
+private:
+    const unsigned char *data, *end;
+    unsigned range, code;
+    unsigned nextByte() {
+        // reading past the end returns zeros, overrun() detects corrupted data
+        return data < end ? *data++ : (data++, 0);
+    };
+};
+
+static inline unsigned quantize(float x, float res) {
+    __egs_phspz_data32 d;
+    if (res > 0) {
+        double t = floor(x/res + 0.5);
+        d.i = t > 2147483647. ? 2147483647 : t < -2147483647. ? -2147483647 : (int) t;
+        return zigzag(d.i);
+    }
+    d.f = x;
+    return d.u;
+}
+
+static inline float dequantize(unsigned q, float res) {
+    __egs_phspz_data32 d;
+    if (res > 0) {
+        return unzigzag(q)*res;
+    }
+    d.u = q;
+    return d.f;
+}
+
+static void encodeParticles(const EGS_CompressedPhspInfo &info,
+                            const EGS_PhspRecord *p, int n,
+                            vector<unsigned char> &out) {
+    out.clear();
+    out.reserve(16*n+16);
+    // the number of particles in the block, followed by the coded data
+    __egs_phspz_data32 d;
+    d.i = n;
+    for (int j=0; j<4; j++) {
+        out.push_back((unsigned char)(d.u >> (8*j)));
+    }
+    EGS_PhspzModel *model = new EGS_PhspzModel;
+    EGS_PhspzEncoder enc(out);
+    int eshift = 23 - info.e_bits;
+    unsigned eround = eshift > 0 ? 1U << (eshift-1) : 0;
+    int last_latch = 0;
+    unsigned last_wt = 0;
+    unsigned q[phspz_nfield];
+    for (int i=0; i<n; i++) {
+        q[0] = zigzag((int)((unsigned) p[i].latch - (unsigned) last_latch));
+        last_latch = p[i].latch;
+        d.f = p[i].E;
+        unsigned sign = d.u >> 31, ebits = d.u & 0x7fffffffU;
+        if (eshift > 0) {
+            ebits = ebits + eround < 0x7f800000U ? (ebits + eround) >> eshift :
+                    ebits >> eshift;
+        }
+        q[1] = (ebits << 1) | sign;
+        q[2] = quantize(p[i].x,info.pos_res);
+        q[3] = quantize(p[i].y,info.pos_res);
+        q[4] = quantize(p[i].u,info.dir_res);
+        q[5] = quantize(p[i].v,info.dir_res);
+        d.f = p[i].wt;
+        q[6] = zigzag((int)(d.u - last_wt));
+        last_wt = d.u;
+        for (int k=0; k<phspz_nfield; k++) for (int j=3; j>=0; j--) {
+                enc.encodeByte(model->p[k][j],(q[k] >> (8*j)) & 0xff);
+            }
+    }
+    enc.finish();
+    delete model;
+}
+
+#endif
+
+/*************************************************************************
+  Writer
+ *************************************************************************/
+
+EGS_CompressedPhspWriter::EGS_CompressedPhspWriter() : data_end(0) {
+    memset(&info,0,sizeof(info));
+}
+
+EGS_CompressedPhspWriter::~EGS_CompressedPhspWriter() {
+    close();
+}
+
+bool EGS_CompressedPhspWriter::open(const string &fname, int block_size,
+                                    float pos_res, float dir_res, int e_bits) {
+    close();
+    the_file.open(fname.c_str(),ios::binary|ios::out|ios::in|ios::trunc);
+    if (!the_file) {
+        egsWarning("EGS_CompressedPhspWriter::open: failed to open %s for "
+                   "writing\n",fname.c_str());
+        return false;
+    }
+    file_name = fname;
+    memset(&info,0,sizeof(info));
+    info.block_size = block_size > 0 ? block_size : 16384;
+    info.pos_res = pos_res > 0 ? pos_res : 0;
+    info.dir_res = dir_res > 0 ? dir_res : 0;
+    info.e_bits = e_bits < 1 ? 1 : e_bits > 23 ? 23 : e_bits;
+    info.emin = 0;
+    info.emax = 0;
+    offsets.clear();
+    pending.clear();
+    data_end = phspz_header_size;
+    return flush(0,0,0,0);
+}
+
+bool EGS_CompressedPhspWriter::openForAppend(const string &fname) {
+    close();
+    EGS_CompressedPhspReader reader;
+    if (!reader.open(fname)) {
+        return false;
+    }
+    info = reader.getInfo();
+    int nblock = reader.getNblock();
+    offsets.clear();
+    pending.clear();
+    // complete blocks are kept, the particles of the last incomplete
+    // block are decoded and written again with the new particles
+    int ncomplete = nblock;
+    if (nblock > 0 && reader.getBlockNparticle(nblock-1) < info.block_size) {
+        ncomplete = nblock - 1;
+        int n = reader.getBlockNparticle(nblock-1);
+        vector<unsigned char> data;
+        pending.resize(n);
+        if (!reader.readBlockData(nblock-1,data) ||
+                !EGS_CompressedPhspReader::decodeBlock(info,data,n,&pending[0])) {
+            egsWarning("EGS_CompressedPhspWriter::openForAppend: failed to read "
+                       "the last block of %s\n",fname.c_str());
+            return false;
+        }
+    }
+    offsets.resize(ncomplete);
+    for (int ib=0; ib<ncomplete; ib++) {
+        offsets[ib] = reader.getBlockOffset(ib);
+    }
+    data_end = reader.getBlockOffset(ncomplete);
+    reader.close();
+    the_file.open(fname.c_str(),ios::binary|ios::out|ios::in);
+    if (!the_file) {
+        egsWarning("EGS_CompressedPhspWriter::openForAppend: failed to open %s\n",
+                   fname.c_str());
+        return false;
+    }
+    info.nparticle = ((EGS_I64)ncomplete)*info.block_size;
+    file_name = fname;
+    return true;
+}
+
+bool EGS_CompressedPhspWriter::write(const EGS_PhspRecord *p, int n) {
+    if (!the_file.is_open()) {
+        return false;
+    }
+    for (int j=0; j<n; j++) {
+        pending.push_back(p[j]);
+        if ((int)pending.size() == info.block_size) {
+            if (!writeBlock(&pending[0],pending.size())) {
+                return false;
+            }
+            offsets.push_back(data_end);
+            data_end += buf.size();
+            info.nparticle += pending.size();
+            pending.clear();
+        }
+    }
+    return true;
+}
+
+bool EGS_CompressedPhspWriter::writeBlock(const EGS_PhspRecord *p, int n) {
+    encodeParticles(info,p,n,buf);
+    the_file.seekp(data_end,ios::beg);
+    the_file.write((const char *) &buf[0],buf.size());
+    if (!the_file) {
+        egsWarning("EGS_CompressedPhspWriter: failed to write to %s\n",
+                   file_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool EGS_CompressedPhspWriter::flush(EGS_I64 nphoton, float emax, float emin,
+                                     float pinc) {
+    if (!the_file.is_open()) {
+        return false;
+    }
+    info.nphoton = nphoton;
+    info.emax = emax;
+    info.emin = emin;
+    info.pinc = pinc;
+    // the incomplete block goes after the complete blocks and gets
+    // overwritten by the next complete block
+    EGS_I64 index_pos = data_end;
+    int nblock = offsets.size();
+    if (pending.size() > 0) {
+        if (!writeBlock(&pending[0],pending.size())) {
+            return false;
+        }
+        index_pos += buf.size();
+        nblock++;
+    }
+    the_file.seekp(index_pos,ios::beg);
+    for (int ib=0; ib<(int)offsets.size(); ib++) {
+        the_file.write((const char *) &offsets[ib],sizeof(EGS_I64));
+    }
+    if (pending.size() > 0) {
+        the_file.write((const char *) &data_end,sizeof(EGS_I64));
+    }
+    the_file.write((const char *) &index_pos,sizeof(EGS_I64));
+
+    the_file.seekp(0,ios::beg);
+    int version = phspz_version, byte_order = 1;
+    EGS_I64 np = info.nparticle + pending.size();
+    the_file.write(phspz_magic,8);
+    the_file.write((const char *) &version,sizeof(int));
+    the_file.write((const char *) &byte_order,sizeof(int));
+    the_file.write((const char *) &info.block_size,sizeof(int));
+    the_file.write((const char *) &info.e_bits,sizeof(int));
+    the_file.write((const char *) &info.pos_res,sizeof(float));
+    the_file.write((const char *) &info.dir_res,sizeof(float));
+    the_file.write((const char *) &np,sizeof(EGS_I64));
+    the_file.write((const char *) &info.nphoton,sizeof(EGS_I64));
+    the_file.write((const char *) &info.emax,sizeof(float));
+    the_file.write((const char *) &info.emin,sizeof(float));
+    the_file.write((const char *) &info.pinc,sizeof(float));
+    the_file.write((const char *) &index_pos,sizeof(EGS_I64));
+    the_file.write((const char *) &nblock,sizeof(int));
+    the_file.flush();
+    if (!the_file) {
+        egsWarning("EGS_CompressedPhspWriter::flush: failed to write to %s\n",
+                   file_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+void EGS_CompressedPhspWriter::close() {
+    if (the_file.is_open()) {
+        flush(info.nphoton,info.emax,info.emin,info.pinc);
+        the_file.close();
+    }
+    offsets.clear();
+    pending.clear();
+}
+
+/*************************************************************************
+  Reader
+ *************************************************************************/
+
+EGS_CompressedPhspReader::EGS_CompressedPhspReader() : cur_block(-1) {
+    memset(&info,0,sizeof(info));
+}
+
+EGS_CompressedPhspReader::~EGS_CompressedPhspReader() {
+    close();
+}
+
+bool EGS_CompressedPhspReader::isCompressedPhsp(const string &fname) {
+    ifstream in(fname.c_str(),ios::binary);
+    char magic[8];
+    if (!in.read(magic,8)) {
+        return false;
+    }
+    return !strncmp(magic,phspz_magic,8);
+}
+
+void EGS_CompressedPhspReader::close() {
+    if (the_file.is_open()) {
+        the_file.close();
+    }
+    offsets.clear();
+    block.clear();
+    cur_block = -1;
+}
+
+bool EGS_CompressedPhspReader::open(const string &fname) {
+    close();
+    the_file.open(fname.c_str(),ios::binary|ios::in);
+    if (!the_file) {
+        egsWarning("EGS_CompressedPhspReader::open: failed to open %s\n",
+                   fname.c_str());
+        return false;
+    }
+    char magic[8];
+    int version, byte_order, nblock;
+    EGS_I64 index_pos;
+    the_file.read(magic,8);
+    the_file.read((char *) &version,sizeof(int));
+    the_file.read((char *) &byte_order,sizeof(int));
+    if (!the_file || strncmp(magic,phspz_magic,8)) {
+        egsWarning("EGS_CompressedPhspReader::open: %s is not a compressed "
+                   "phase space file\n",fname.c_str());
+        close();
+        return false;
+    }
+    if (byte_order != 1 || version != phspz_version) {
+        egsWarning("EGS_CompressedPhspReader::open: %s was written on a "
+                   "machine with different endianness or with an unsupported "
+                   "version of the format (%d)\n",fname.c_str(),version);
+        close();
+        return false;
+    }
+    the_file.read((char *) &info.block_size,sizeof(int));
+    the_file.read((char *) &info.e_bits,sizeof(int));
+    the_file.read((char *) &info.pos_res,sizeof(float));
+    the_file.read((char *) &info.dir_res,sizeof(float));
+    the_file.read((char *) &info.nparticle,sizeof(EGS_I64));
+    the_file.read((char *) &info.nphoton,sizeof(EGS_I64));
+    the_file.read((char *) &info.emax,sizeof(float));
+    the_file.read((char *) &info.emin,sizeof(float));
+    the_file.read((char *) &info.pinc,sizeof(float));
+    the_file.read((char *) &index_pos,sizeof(EGS_I64));
+    the_file.read((char *) &nblock,sizeof(int));
+    if (!the_file || info.block_size < 1 || nblock < 0 || info.nparticle < 0 ||
+            info.nparticle > ((EGS_I64)nblock)*info.block_size) {
+        egsWarning("EGS_CompressedPhspReader::open: the header of %s contains "
+                   "meaningless values\n",fname.c_str());
+        close();
+        return false;
+    }
+    offsets.resize(nblock+1);
+    the_file.seekg(index_pos,ios::beg);
+    for (int ib=0; ib<=nblock; ib++) {
+        the_file.read((char *) &offsets[ib],sizeof(EGS_I64));
+    }
+    if (!the_file || offsets[nblock] != index_pos) {
+        egsWarning("EGS_CompressedPhspReader::open: failed to read the block "
+                   "index of %s\n",fname.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+int EGS_CompressedPhspReader::getBlockNparticle(int ib) const {
+    int nblock = getNblock();
+    if (ib < 0 || ib >= nblock) {
+        return 0;
+    }
+    if (ib < nblock-1) {
+        return info.block_size;
+    }
+    return info.nparticle - ((EGS_I64)ib)*info.block_size;
+}
+
+bool EGS_CompressedPhspReader::readBlockData(int ib,
+        vector<unsigned char> &data) {
+    if (ib < 0 || ib >= getNblock()) {
+        return false;
+    }
+    EGS_I64 nbyte = offsets[ib+1] - offsets[ib];
+    data.resize(nbyte);
+    the_file.clear();
+    the_file.seekg(offsets[ib],ios::beg);
+    the_file.read((char *) &data[0],nbyte);
+    if (!the_file) {
+        egsWarning("EGS_CompressedPhspReader: I/O error while reading block %d\n",
+                   ib);
+        return false;
+    }
+    return true;
+}
+
+bool EGS_CompressedPhspReader::decodeBlock(const EGS_CompressedPhspInfo &info,
+        const vector<unsigned char> &data, int n, EGS_PhspRecord *p) {
+    if (data.size() < 4) {
+        return false;
+    }
+    __egs_phspz_data32 d;
+    d.u = 0;
+    for (int j=0; j<4; j++) {
+        d.u |= ((unsigned) data[j]) << (8*j);
+    }
+    if (d.i != n) {
+        egsWarning("EGS_CompressedPhspReader::decodeBlock: expected %d "
+                   "particles but the block contains %d\n",n,d.i);
+        return false;
+    }
+    EGS_PhspzModel *model = new EGS_PhspzModel;
+    EGS_PhspzDecoder dec(&data[4],&data[0]+data.size());
+    int eshift = 23 - info.e_bits;
+    int last_latch = 0;
+    unsigned last_wt = 0;
+    unsigned q[phspz_nfield];
+    for (int i=0; i<n; i++) {
+        for (int k=0; k<phspz_nfield; k++) {
+            q[k] = 0;
+            for (int j=3; j>=0; j--) {
+                q[k] |= ((unsigned) dec.decodeByte(model->p[k][j])) << (8*j);
+            }
+        }
+        p[i].latch = (int)((unsigned) last_latch + (unsigned) unzigzag(q[0]));
+        last_latch = p[i].latch;
+        d.u = ((q[1] >> 1) << eshift) | (q[1] << 31);
+        p[i].E = d.f;
+        p[i].x = dequantize(q[2],info.pos_res);
+        p[i].y = dequantize(q[3],info.pos_res);
+        p[i].u = dequantize(q[4],info.dir_res);
+        p[i].v = dequantize(q[5],info.dir_res);
+        last_wt += (unsigned) unzigzag(q[6]);
+        d.u = last_wt;
+        p[i].wt = d.f;
+    }
+    delete model;
+    if (dec.overrun()) {
+        egsWarning("EGS_CompressedPhspReader::decodeBlock: corrupted data\n");
+        return false;
+    }
+    return true;
+}
+
+bool EGS_CompressedPhspReader::loadBlock(int ib) {
+    int n = getBlockNparticle(ib);
+    if (n < 1) {
+        return false;
+    }
+    block.resize(n);
+    if (!readBlockData(ib,buf) || !decodeBlock(info,buf,n,&block[0])) {
+        cur_block = -1;
+        return false;
+    }
+    cur_block = ib;
+    return true;
+}
+
+#ifdef TEST
+
+// Write particles to a compressed file, append to it and read them
+// back. Compile with
+//   g++ -DTEST -I../lib/$my_machine egs_compressed_phsp.cpp
+// and run with the name of a scratch file as argument.
+
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+
+void egs_warning(const char *msg,...) {
+    va_list ap;
+    va_start(ap, msg);
+    vfprintf(stderr, msg, ap);
+    va_end(ap);
+}
+
+EGS_InfoFunction egsWarning = egs_warning;
+
+static unsigned int test_seed = 12345;
+static float testRandom() {
+    test_seed = 1664525*test_seed + 1013904223;
+    return (test_seed >> 8)*(1.f/16777216.f);
+}
+
+static void makeParticles(vector<EGS_PhspRecord> &p) {
+    for (unsigned int j=0; j<p.size(); j++) {
+        int q = j%3;
+        p[j].latch = (q == 1 ? 0 : q == 0 ? (1 << 30) : (1 << 29)) | (j%17);
+        p[j].E = 0.01 + 20*testRandom();
+        if (j%5 == 0) {
+            p[j].E = -p[j].E;
+        }
+        p[j].x = 40*testRandom() - 20;
+        p[j].y = 40*testRandom() - 20;
+        p[j].u = 2*testRandom() - 1;
+        p[j].v = (1 - fabs(p[j].u))*(2*testRandom() - 1);
+        p[j].wt = j%7 == 0 ? -0.5 : 0.5;
+    }
+}
+
+static int checkFile(const char *fname, const vector<EGS_PhspRecord> &p,
+                     float pos_res, float dir_res, int e_bits) {
+    EGS_CompressedPhspReader reader;
+    if (!reader.open(fname)) {
+        printf("failed to open %s for reading\n",fname);
+        return 1;
+    }
+    const EGS_CompressedPhspInfo &info = reader.getInfo();
+    if (info.nparticle != (EGS_I64)p.size() || info.nphoton != 42 ||
+            info.emax != 20 || info.emin != 0.5 || info.pinc != 1000) {
+        printf("wrong header: nparticle=%lld nphoton=%lld emax=%g emin=%g "
+               "pinc=%g\n",info.nparticle,info.nphoton,info.emax,info.emin,
+               info.pinc);
+        return 1;
+    }
+    float etol = ldexp(1.,-e_bits);
+    int nerr = 0;
+    // read backwards so that every block is sought to
+    for (int j=p.size()-1; j>=0; j--) {
+        EGS_PhspRecord r;
+        if (!reader.getParticle(j,r)) {
+            printf("failed to read particle %d\n",j);
+            return 1;
+        }
+        if (r.latch != p[j].latch || r.wt != p[j].wt ||
+                fabs(r.E - p[j].E) > etol*fabs(p[j].E) ||
+                fabs(r.x - p[j].x) > 0.5001*pos_res + 1e-5*fabs(p[j].x) ||
+                fabs(r.y - p[j].y) > 0.5001*pos_res + 1e-5*fabs(p[j].y) ||
+                fabs(r.u - p[j].u) > 0.5001*dir_res + 1e-6 ||
+                fabs(r.v - p[j].v) > 0.5001*dir_res + 1e-6) {
+            if (nerr++ < 10) {
+                printf("particle %d differs: latch %d %d E %g %g x %g %g "
+                       "y %g %g u %g %g v %g %g wt %g %g\n",j,p[j].latch,
+                       r.latch,p[j].E,r.E,p[j].x,r.x,p[j].y,r.y,p[j].u,r.u,
+                       p[j].v,r.v,p[j].wt,r.wt);
+            }
+        }
+        if (pos_res == 0 && dir_res == 0 && e_bits == 23 &&
+                (r.E != p[j].E || r.x != p[j].x || r.y != p[j].y ||
+                 r.u != p[j].u || r.v != p[j].v)) {
+            if (nerr++ < 10) {
+                printf("particle %d is not stored without loss\n",j);
+            }
+        }
+    }
+    return nerr ? 1 : 0;
+}
+
+static int testFormat(const char *fname, float pos_res, float dir_res,
+                      int e_bits) {
+    vector<EGS_PhspRecord> p(1234);
+    makeParticles(p);
+    EGS_CompressedPhspWriter writer;
+    // small blocks so that the file has complete and incomplete blocks
+    if (!writer.open(fname,100,pos_res,dir_res,e_bits)) {
+        return 1;
+    }
+    writer.write(&p[0],450);
+    writer.flush(42,20,0.5,1000);
+    writer.write(&p[450],350);
+    writer.close();
+    // append to the file as is done on restarts
+    if (!writer.openForAppend(fname) || writer.getNparticle() != 800) {
+        printf("failed to open %s for appending\n",fname);
+        return 1;
+    }
+    writer.write(&p[800],p.size()-800);
+    writer.flush(42,20,0.5,1000);
+    writer.close();
+    return checkFile(fname,p,pos_res,dir_res,e_bits);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("usage: %s scratch_file\n",argv[0]);
+        return 1;
+    }
+    int err = 0;
+    if (testFormat(argv[1],0,0,23)) {
+        printf("lossless compression test failed\n");
+        err++;
+    }
+    if (testFormat(argv[1],1e-4,9.5367431640625e-7,16)) {
+        printf("lossy compression test failed\n");
+        err++;
+    }
+    remove(argv[1]);
+    if (!err) {
+        printf("compressed phase space tests passed\n");
+    }
+    return err;
+}
+
+#endif
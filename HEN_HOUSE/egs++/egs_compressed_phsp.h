@@ -0,0 +1,247 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ compressed phase space file headers
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+*/
+
+
+/*! \file egs_compressed_phsp.h
+ *  \brief Reading and writing compressed, indexed phase space files
+ */
+
+#ifndef EGS_COMPRESSED_PHSP_
+#define EGS_COMPRESSED_PHSP_
+
+#include "egs_libconfig.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*! \brief A phase space particle record
+
+  \ingroup egspp_main
+
+  The fields have the same meaning as in a MODE0 EGSnrc phase space file:
+  bits 29 and 30 of \a latch encode the charge, a negative energy marks
+  the first particle of a new primary history, \a E is the total energy
+  for charged particles and the sign of \a wt is the sign of the
+  z-direction cosine.
+*/
+struct EGS_EXPORT EGS_PhspRecord {
+    int   latch;
+    float E, x, y, u, v, wt;
+};
+
+/*! \brief Header information of a compressed phase space file
+
+  \ingroup egspp_main
+*/
+struct EGS_EXPORT EGS_CompressedPhspInfo {
+    EGS_I64 nparticle;  //!< Number of particles in the file
+    EGS_I64 nphoton;    //!< Number of photons in the file
+    float   emax;       //!< Maximum kinetic energy
+    float   emin;       //!< Minimum kinetic energy of charged particles
+    float   pinc;       //!< Number of primary histories represented
+    float   pos_res;    //!< Position quantization step (0 = lossless)
+    float   dir_res;    //!< Direction cosine quantization step (0 = lossless)
+    int     e_bits;     //!< Number of energy mantissa bits kept (23 = lossless)
+    int     block_size; //!< Number of particles per block
+};
+
+/*! \brief A class for writing compressed, indexed phase space files
+
+  \ingroup egspp_main
+
+  A compressed phase space file (extension \c .egsphspz) stores the
+  same information as a MODE0 EGSnrc phase space file. Particles are
+  grouped into blocks of \a block_size particles. In each block the
+  particle fields are quantized (positions and direction cosines to a
+  fixed step, energies to a given number of mantissa bits), the latch
+  and weight are delta-encoded with respect to the previous particle,
+  and the resulting integers are compressed with an adaptive binary
+  range coder that uses a separate model for each byte of each field.
+  Blocks are independent of each other and an index of the block
+  offsets is stored at the end of the file. This makes it possible to
+  decompress blocks in parallel and to seek to any particle by reading
+  a single block.
+
+  The file is kept consistent after each call to flush(): the last,
+  partially filled block, the index and the header are rewritten
+  every time so that a file being written during a run can be used
+  for a restart.
+*/
+class EGS_EXPORT EGS_CompressedPhspWriter {
+
+public:
+
+    EGS_CompressedPhspWriter();
+    ~EGS_CompressedPhspWriter();
+
+    /*! \brief Create the file \a fname for writing
+
+      \a pos_res and \a dir_res are the quantization steps for positions
+      and direction cosines (a value of 0 stores them without loss),
+      \a e_bits is the number of energy mantissa bits to keep.
+      Returns \c false if the file can not be opened.
+    */
+    bool open(const string &fname, int block_size = 16384,
+              float pos_res = 1e-4, float dir_res = 9.5367431640625e-7,
+              int e_bits = 16);
+
+    /*! \brief Open the existing file \a fname for appending particles
+
+      The quantization parameters are taken from the file.
+    */
+    bool openForAppend(const string &fname);
+
+    /*! \brief Add \a n particles from \a p to the file */
+    bool write(const EGS_PhspRecord *p, int n);
+
+    /*! \brief Write pending data, the index and the header
+
+      \a nphoton, \a emax, \a emin and \a pinc are stored in the header,
+      the number of particles is the number of particles written so far.
+    */
+    bool flush(EGS_I64 nphoton, float emax, float emin, float pinc);
+
+    /*! \brief Flush and close the file */
+    void close();
+
+    /*! \brief Number of particles written so far */
+    EGS_I64 getNparticle() const {
+        return info.nparticle + pending.size();
+    };
+
+    /*! \brief The header information of the file */
+    const EGS_CompressedPhspInfo &getInfo() const {
+        return info;
+    };
+
+    bool isOpen() const {
+        return the_file.is_open();
+    };
+
+protected:
+
+    fstream                 the_file;
+    string                  file_name;
+    EGS_CompressedPhspInfo  info;
+    vector<EGS_I64>         offsets;   //!< Offsets of the complete blocks
+    EGS_I64                 data_end;  //!< End of the last complete block
+    vector<EGS_PhspRecord>  pending;   //!< Particles of the incomplete block
+    vector<unsigned char>   buf;       //!< Encoding buffer
+
+    bool writeBlock(const EGS_PhspRecord *p, int n);
+};
+
+/*! \brief A class for reading compressed, indexed phase space files
+
+  \ingroup egspp_main
+
+  See EGS_CompressedPhspWriter for a description of the format.
+  Particles are accessed with getParticle() using their 0-based index
+  in the file. The block containing the particle is decompressed when
+  needed and kept until a particle from a different block is requested,
+  so that sequential reading decompresses each block once and seeking
+  to an arbitrary particle costs the decompression of a single block.
+  readBlockData() and the static decodeBlock() can be used to decompress
+  several blocks concurrently.
+*/
+class EGS_EXPORT EGS_CompressedPhspReader {
+
+public:
+
+    EGS_CompressedPhspReader();
+    ~EGS_CompressedPhspReader();
+
+    /*! \brief Returns \c true if \a fname is a compressed phase space file */
+    static bool isCompressedPhsp(const string &fname);
+
+    /*! \brief Open the file \a fname. Returns \c false on failure. */
+    bool open(const string &fname);
+
+    void close();
+
+    /*! \brief The header information of the file */
+    const EGS_CompressedPhspInfo &getInfo() const {
+        return info;
+    };
+
+    /*! \brief Number of blocks in the file */
+    int getNblock() const {
+        return offsets.size() > 0 ? offsets.size()-1 : 0;
+    };
+
+    /*! \brief Number of particles in block \a ib */
+    int getBlockNparticle(int ib) const;
+
+    /*! \brief Position of block \a ib in the file
+
+      For \a ib equal to the number of blocks, the position of the index
+      (i.e. the end of the compressed data) is returned.
+    */
+    EGS_I64 getBlockOffset(int ib) const {
+        return offsets[ib];
+    };
+
+    /*! \brief Get particle \a i (0-based). Returns \c false on error. */
+    bool getParticle(EGS_I64 i, EGS_PhspRecord &p) {
+        int ib = i/info.block_size;
+        if (ib != cur_block && !loadBlock(ib)) {
+            return false;
+        }
+        p = block[i - ((EGS_I64)ib)*info.block_size];
+        return true;
+    };
+
+    /*! \brief Read the compressed data of block \a ib into \a data */
+    bool readBlockData(int ib, vector<unsigned char> &data);
+
+    /*! \brief Decompress \a n particles from \a data into \a p
+
+      This function does not use any state and can therefore be called
+      concurrently from several threads.
+    */
+    static bool decodeBlock(const EGS_CompressedPhspInfo &info,
+                            const vector<unsigned char> &data, int n,
+                            EGS_PhspRecord *p);
+
+protected:
+
+    ifstream                the_file;
+    EGS_CompressedPhspInfo  info;
+    vector<EGS_I64>         offsets;   //!< Block offsets (nblock+1 entries)
+    int                     cur_block; //!< The currently decoded block
+    vector<EGS_PhspRecord>  block;     //!< The decoded particles of cur_block
+    vector<unsigned char>   buf;
+
+    bool loadBlock(int ib);
+};
+
+#endif
@@ -0,0 +1,202 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ control point tables
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+*/
+
+
+/*! \file egs_control_points.cpp
+ *  \brief Control points for dynamic sources and geometries
+ */
+
+#include "egs_control_points.h"
+#include "egs_input.h"
+#include "egs_functions.h"
+#include "egs_math.h"
+
+#include <sstream>
+
+EGS_RotationMatrix EGS_ControlPointTable::getRotation(EGS_Float theta,
+        EGS_Float phi, EGS_Float phicol) {
+    return EGS_RotationMatrix::rotZ(phi*M_PI/180)*
+           EGS_RotationMatrix::rotY(theta*M_PI/180)*
+           EGS_RotationMatrix::rotZ(phicol*M_PI/180);
+}
+
+void EGS_ControlPointTable::setControlPoints(
+    const vector<EGS_ControlPoint> &cpts) {
+    seg.clear();
+    grid.clear();
+    nseg = 0;
+    int npts = cpts.size();
+    for (int i=1; i<npts; i++) {
+        const EGS_ControlPoint &a = cpts[i-1], &b = cpts[i];
+        if (b.mu <= a.mu) {
+            continue;    // zero length segments are never sampled
+        }
+        Segment s;
+        s.mu0 = a.mu;
+        s.mu1 = b.mu;
+        s.dmui = 1/(b.mu - a.mu);
+        s.p0 = a;
+        s.dp.iso = b.iso - a.iso;
+        s.dp.dsource = b.dsource - a.dsource;
+        s.dp.theta = b.theta - a.theta;
+        s.dp.phi = b.phi - a.phi;
+        s.dp.phicol = b.phicol - a.phicol;
+        s.dp.mu = b.mu - a.mu;
+        s.rotates = s.dp.theta || s.dp.phi || s.dp.phicol;
+        if (!s.rotates) {
+            s.R = getRotation(a.theta,a.phi,a.phicol);
+        }
+        seg.push_back(s);
+    }
+    nseg = seg.size();
+    if (!nseg) {
+        return;
+    }
+    int nbin = 4*nseg > 64 ? 4*nseg : 64;
+    grid.resize(nbin);
+    int k = 0;
+    for (int j=0; j<nbin; j++) {
+        EGS_Float mu = ((EGS_Float)j)/nbin;
+        while (k < nseg-1 && mu >= seg[k].mu1) {
+            k++;
+        }
+        grid[j] = k;
+    }
+}
+
+int EGS_ControlPointTable::findSegment(EGS_Float mu) const {
+    if (!nseg || mu < seg[0].mu0 || mu >= seg[nseg-1].mu1) {
+        return -1;
+    }
+    int nbin = grid.size();
+    int j = (int)(mu*nbin);
+    if (j >= nbin) {
+        j = nbin-1;
+    }
+    int k = j >= 0 ? grid[j] : 0;
+    while (mu >= seg[k].mu1) {
+        k++;
+    }
+    return k;
+}
+
+bool EGS_ControlPointTable::getControlPoint(EGS_Float mu,
+        EGS_ControlPoint &p) const {
+    int k = findSegment(mu);
+    if (k < 0) {
+        return false;
+    }
+    const Segment &s = seg[k];
+    EGS_Float f = (mu - s.mu0)*s.dmui;
+    p.iso = s.p0.iso + s.dp.iso*f;
+    p.dsource = s.p0.dsource + s.dp.dsource*f;
+    p.theta = s.p0.theta + s.dp.theta*f;
+    p.phi = s.p0.phi + s.dp.phi*f;
+    p.phicol = s.p0.phicol + s.dp.phicol*f;
+    p.mu = mu;
+    return true;
+}
+
+bool EGS_ControlPointTable::getTransformation(EGS_Float mu,
+        EGS_AffineTransform &T) const {
+    int k = findSegment(mu);
+    if (k < 0) {
+        return false;
+    }
+    const Segment &s = seg[k];
+    EGS_Float f = (mu - s.mu0)*s.dmui;
+    EGS_RotationMatrix R = s.rotates ? getRotation(s.p0.theta + s.dp.theta*f,
+                           s.p0.phi + s.dp.phi*f, s.p0.phicol + s.dp.phicol*f) : s.R;
+    EGS_Vector iso = s.p0.iso + s.dp.iso*f;
+    EGS_Float dsource = s.p0.dsource + s.dp.dsource*f;
+    T = EGS_AffineTransform(R, iso - R*EGS_Vector(0,0,dsource));
+    return true;
+}
+
+bool EGS_ControlPointTable::getControlPoints(EGS_Input *inp,
+        vector<EGS_ControlPoint> &cpts, const char *caller) {
+    cpts.clear();
+    bool valid = true;
+    vector<EGS_Float> point;
+    EGS_ControlPoint cpt;
+    int ncpts = 0;
+    int icpts = 1;
+    for (EGS_I64 loopCount=0; loopCount<=loopMax; ++loopCount) {
+        if (loopCount == loopMax) {
+            egsFatal("%s: Too many iterations were required! Input may be invalid, or consider increasing loopMax.",caller);
+            return false;
+        }
+        ostringstream itos;
+        itos << "control point " << icpts;
+        if (inp->getInput(itos.str(),point)) {
+            break;
+        }
+        if (point.size()!=8) {
+            egsWarning("%s: control point %i does not specify 8 values.\n",caller,icpts);
+            valid = false;
+            break;
+        }
+        if (ncpts>0 && point[7] < cpts[ncpts-1].mu) {
+            egsWarning("%s: mu index of control point %i < mu index of control point %i\n",caller,icpts,ncpts);
+            valid = false;
+            break;
+        }
+        if (point[7] < 0.) {
+            egsWarning("%s: mu index of control point %i < 0.0\n",caller,icpts);
+            valid = false;
+            break;
+        }
+        ncpts++;
+        if (ncpts == 1 && point[7] > 0.0) {
+            egsWarning("%s: mu index of control point 1 > 0.0.  This will generate many warning messages.\n",caller);
+        }
+        cpt.iso = EGS_Vector(point[0],point[1],point[2]);
+        cpt.dsource = point[3];
+        cpt.theta = point[4];
+        cpt.phi = point[5];
+        cpt.phicol = point[6];
+        cpt.mu = point[7];
+        cpts.push_back(cpt);
+        icpts++;
+    }
+    if (ncpts <= 1) {
+        egsWarning("%s: not enough or missing control points.\n",caller);
+        return false;
+    }
+    if (cpts[ncpts-1].mu == 0.0) {
+        egsWarning("%s: mu index of last control point = 0.  Something's wrong.\n",caller);
+        return false;
+    }
+    EGS_Float mu_max = cpts[ncpts-1].mu;
+    for (int i=0; i<ncpts; i++) {
+        cpts[i].mu /= mu_max;
+    }
+    return valid;
+}
@@ -0,0 +1,141 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ control point tables headers
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+*/
+
+
+/*! \file egs_control_points.h
+ *  \brief Control points for dynamic sources and geometries
+ */
+
+#ifndef EGS_CONTROL_POINTS_
+#define EGS_CONTROL_POINTS_
+
+#include "egs_libconfig.h"
+#include "egs_vector.h"
+#include "egs_transformations.h"
+
+#include <vector>
+using namespace std;
+
+class EGS_Input;
+
+/*! \brief A control point of a dynamic motion
+
+  \ingroup egspp_main
+
+  See EGS_DynamicSource for the meaning of the parameters.
+*/
+struct EGS_EXPORT EGS_ControlPoint {
+    EGS_Vector iso;     //!< isocentre position
+    EGS_Float  dsource; //!< source-isocentre distance
+    EGS_Float  theta;   //!< angle of rotation about the Y-axis (degrees)
+    EGS_Float  phi;     //!< angle of rotation about the Z-axis (degrees)
+    EGS_Float  phicol;  //!< angle of rotation in the source plane (degrees)
+    EGS_Float  mu;      //!< monitor unit index of the control point
+};
+
+/*! \brief A precomputed interpolation table for a list of control points
+
+  \ingroup egspp_main
+
+  The table converts a monitor unit index \f$\mu\f$ into the affine
+  transformation
+  \f$T(\vec{x}) = R_\phi R_\theta R_{\phi_{col}} (\vec{x} - d_{source}\hat{z}) +
+  \vec{x}_{iso}\f$, where the parameters are linearly interpolated between
+  the control points bracketing \f$\mu\f$. The segment containing
+  \f$\mu\f$ is found with a uniform grid over the normalized monitor
+  unit range, the slopes of all parameters are stored per segment, and the
+  rotation matrix of segments in which the angles do not change is built
+  once when the table is set up. The cost of getTransformation() is
+  therefore independent of the number of control points.
+*/
+class EGS_EXPORT EGS_ControlPointTable {
+
+public:
+
+    EGS_ControlPointTable() : nseg(0) {};
+
+    /*! \brief Set up the table for the control points \a cpts
+
+      The monitor unit indices must be non-decreasing and normalized
+      such that the last control point has \f$\mu=1\f$.
+    */
+    void setControlPoints(const vector<EGS_ControlPoint> &cpts);
+
+    /*! \brief The number of control point segments */
+    int getNsegment() const {
+        return nseg;
+    };
+
+    /*! \brief Get the interpolated parameters \a p for \a mu
+
+      Returns \c false if \a mu is outside of the range covered by the
+      control points.
+    */
+    bool getControlPoint(EGS_Float mu, EGS_ControlPoint &p) const;
+
+    /*! \brief Get the transformation \a T for \a mu
+
+      Returns \c false if \a mu is outside of the range covered by the
+      control points.
+    */
+    bool getTransformation(EGS_Float mu, EGS_AffineTransform &T) const;
+
+    /*! \brief Read control points from the input \a inp
+
+      Reads the <code>control point 1, control point 2, ...</code> keys,
+      each consisting of the 8 values
+      <code>xiso yiso ziso dsource theta phi phicol mu</code>, checks that
+      the monitor unit indices are non-decreasing and normalizes them to
+      the value of the last control point. \a caller is used in warning
+      messages. Returns \c false if the input is invalid.
+    */
+    static bool getControlPoints(EGS_Input *inp, vector<EGS_ControlPoint> &cpts,
+                                 const char *caller);
+
+protected:
+
+    struct EGS_LOCAL Segment {
+        EGS_Float           mu0, mu1; //!< monitor unit range
+        EGS_Float           dmui;     //!< 1/(mu1-mu0)
+        EGS_ControlPoint    p0, dp;   //!< start values and differences
+        bool                rotates;  //!< the angles change
+        EGS_RotationMatrix  R;        //!< the rotation if !rotates
+    };
+
+    int              nseg;  //!< number of segments
+    vector<Segment>  seg;   //!< the segments
+    vector<int>      grid;  //!< first segment for each grid bin
+
+    int  findSegment(EGS_Float mu) const;
+    static EGS_RotationMatrix getRotation(EGS_Float theta, EGS_Float phi,
+                                          EGS_Float phicol);
+};
+
+#endif
@@ -37,6 +37,9 @@
 
 #include "egs_ensdf.h"
 
+#include <cstdio>
+#include <cstring>
+
 map<string, unsigned short int> getElementMap() {
     map<string, unsigned short int> elementTable;
     elementTable["H"] = 1;
@@ -193,11 +196,36 @@ unsigned short int setZ(string id) {
     return Z;
 }
 
-EGS_Ensdf::EGS_Ensdf(const string nuclide, const string ensdf_filename, const string relaxType, const bool allowMultiTrans, int verbosity) {
+// 64-bit FNV-1a hash of the ensdf data and the options that change the
+// decay structure. Used to validate the binary cache.
+static EGS_I64 egsEnsdfHash(const vector<string> &ensdf,
+                            const string &relaxType, bool allowMultiTrans) {
+    unsigned long long h = 14695981039346656037ULL;
+    const unsigned long long prime = 1099511628211ULL;
+    for (vector<string>::const_iterator it = ensdf.begin();
+            it != ensdf.end(); it++) {
+        for (size_t j=0; j<it->size(); ++j) {
+            h = (h ^ (unsigned char)(*it)[j])*prime;
+        }
+        h = (h ^ (unsigned char)'\n')*prime;
+    }
+    for (size_t j=0; j<relaxType.size(); ++j) {
+        h = (h ^ (unsigned char)relaxType[j])*prime;
+    }
+    h = (h ^ (unsigned char)(allowMultiTrans ? 1 : 0))*prime;
+    return (EGS_I64) h;
+}
+
+EGS_Ensdf::EGS_Ensdf(const string nuclide, const string ensdf_filename, const string relaxType, const bool allowMultiTrans, int verbosity, const bool useCache) {
 
     verbose = verbosity;
     relaxationType = relaxType;
     allowMultiTransition = allowMultiTrans;
+    previousParent = 0;
+    decayDiscrepancy = 0;
+    cacheKey = 0;
+    cached = false;
+    normalized = false;
 
     if (ensdf_file.is_open()) {
         ensdf_file.close();
@@ -231,6 +259,20 @@ EGS_Ensdf::EGS_Ensdf(const string nuclide, const string ensdf_filename, const st
         ensdf_file.close();
     }
 
+    // Restore the decay data from the cache if it was built from the
+    // same ensdf data
+    if (useCache) {
+        cacheFile = ensdf_filename + ".egsensdf";
+        cacheKey = egsEnsdfHash(ensdf, relaxationType, allowMultiTransition);
+        if (readCache()) {
+            egsInformation("EGS_Ensdf::EGS_Ensdf: Using decay data from %s\n",
+                           cacheFile.c_str());
+            cached = true;
+            normalized = true;
+            return;
+        }
+    }
+
     // Parse the ensdf data
     parseEnsdf(ensdf);
 }
@@ -239,7 +281,10 @@ EGS_Ensdf::~EGS_Ensdf() {
     if (ensdf_file.is_open()) {
         ensdf_file.close();
     }
+    deleteRecords();
+}
 
+void EGS_Ensdf::deleteRecords() {
     for (vector<ParentRecord * >::iterator it = myParentRecords.begin();
             it!=myParentRecords.end(); it++) {
         delete *it;
@@ -302,6 +347,14 @@ EGS_Ensdf::~EGS_Ensdf() {
         *it=0;
     }
     myUncorrelatedGammaRecords.clear();
+    for (vector<LevelRecord * >::iterator it =
+                myCachedLevelRecords.begin();
+            it!=myCachedLevelRecords.end(); it++) {
+        delete *it;
+        *it=0;
+    }
+    myCachedLevelRecords.clear();
+    myBetaRecords.clear();
 }
 
 string egsRemoveWhite(string myString) {
@@ -324,6 +377,407 @@ string egsTrimString(string myString) {
     return myString.substr(start,end-start+1);
 }
 
+// Binary cache of the decay data
+static const char egs_ensdf_cache_id[8] = {'E','G','S','E','N','S','1','\0'};
+
+template <class T> static void egsCacheWrite(ostream &out, const T &v) {
+    out.write((const char *)&v,sizeof(T));
+}
+
+template <class T> static void egsCacheWrite(ostream &out,
+        const vector<T> &v) {
+    int n = v.size();
+    egsCacheWrite(out,n);
+    if (n) {
+        out.write((const char *)&v[0],((size_t)n)*sizeof(T));
+    }
+}
+
+template <class T> static bool egsCacheRead(istream &in, T &v) {
+    in.read((char *)&v,sizeof(T));
+    return !in.fail();
+}
+
+template <class T> static bool egsCacheRead(istream &in, vector<T> &v) {
+    int n;
+    if (!egsCacheRead(in,n) || n < 0 || n > 10000000) {
+        return false;
+    }
+    v.resize(n);
+    if (n) {
+        in.read((char *)&v[0],((size_t)n)*sizeof(T));
+    }
+    return !in.fail();
+}
+
+template <class T> static int egsCacheIndex(const vector<T *> &v,
+        const T *p) {
+    for (unsigned int j=0; j<v.size(); ++j) {
+        if (v[j] == p) {
+            return j;
+        }
+    }
+    return -1;
+}
+
+template <class T> static bool egsCacheLink(istream &in,
+        const vector<T *> &v, T *&p) {
+    int j;
+    if (!egsCacheRead(in,j) || j < -1 || j >= (int)v.size()) {
+        return false;
+    }
+    p = j >= 0 ? v[j] : 0;
+    return true;
+}
+
+bool EGS_Ensdf::writeCache() const {
+    if (!cacheFile.size() || cached) {
+        return false;
+    }
+
+    // All levels referenced by the records. Records without a level in
+    // the ensdf file refer to levels not in myLevelRecords
+    vector<LevelRecord *> levels = myLevelRecords;
+    for (vector<BetaRecordLeaf *>::const_iterator it = myBetaRecords.begin();
+            it != myBetaRecords.end(); it++) {
+        if (egsCacheIndex(levels,(*it)->getLevelRecord()) < 0) {
+            levels.push_back((*it)->getLevelRecord());
+        }
+    }
+    for (vector<AlphaRecord *>::const_iterator it = myAlphaRecords.begin();
+            it != myAlphaRecords.end(); it++) {
+        if (egsCacheIndex(levels,(*it)->getLevelRecord()) < 0) {
+            levels.push_back((*it)->getLevelRecord());
+        }
+    }
+    const vector<GammaRecord *> *gammas[3] = {&myGammaRecords,
+                                              &myMetastableGammaRecords, &myUncorrelatedGammaRecords
+                                             };
+    for (int k=0; k<3; ++k) {
+        for (vector<GammaRecord *>::const_iterator it = gammas[k]->begin();
+                it != gammas[k]->end(); it++) {
+            if (egsCacheIndex(levels,(*it)->getLevelRecord()) < 0) {
+                levels.push_back((*it)->getLevelRecord());
+            }
+        }
+    }
+
+    // Write to a temporary file first so that jobs running in parallel
+    // never see a partially written cache
+    char buf[32];
+    sprintf(buf,".%d",egsGetPid());
+    string tmpFile = cacheFile + buf;
+    ofstream out(tmpFile.c_str(),ios::binary);
+    if (!out) {
+        return false;
+    }
+    int fsize = sizeof(EGS_Float);
+    out.write(egs_ensdf_cache_id,8);
+    egsCacheWrite(out,cacheKey);
+    egsCacheWrite(out,fsize);
+    egsCacheWrite(out,decayDiscrepancy);
+    egsCacheWrite(out,xrayEnergies);
+    egsCacheWrite(out,xrayIntensities);
+    egsCacheWrite(out,augerEnergies);
+    egsCacheWrite(out,augerIntensities);
+
+    int n = levels.size(), nl = myLevelRecords.size();
+    egsCacheWrite(out,n);
+    egsCacheWrite(out,nl);
+    for (int j=0; j<n; ++j) {
+        egsCacheWrite(out,levels[j]->energy);
+        egsCacheWrite(out,levels[j]->halfLife);
+        egsCacheWrite(out,levels[j]->disintegrationIntensity);
+        egsCacheWrite(out,levels[j]->canDecay);
+    }
+
+    n = myParentRecords.size();
+    egsCacheWrite(out,n);
+    for (int j=0; j<n; ++j) {
+        egsCacheWrite(out,myParentRecords[j]->halfLife);
+        egsCacheWrite(out,myParentRecords[j]->Q);
+    }
+
+    n = myNormalizationRecords.size();
+    egsCacheWrite(out,n);
+    for (int j=0; j<n; ++j) {
+        const NormalizationRecord *norm = myNormalizationRecords[j];
+        egsCacheWrite(out,egsCacheIndex(myParentRecords,norm->getParentRecord()));
+        egsCacheWrite(out,norm->normalizeRelative);
+        egsCacheWrite(out,norm->normalizeTransition);
+        egsCacheWrite(out,norm->normalizeBranch);
+        egsCacheWrite(out,norm->normalizeBeta);
+        egsCacheWrite(out,norm->Z);
+    }
+
+    int nminus = myBetaMinusRecords.size(), nplus = myBetaPlusRecords.size();
+    egsCacheWrite(out,nminus);
+    egsCacheWrite(out,nplus);
+    for (int j=0; j<nminus+nplus; ++j) {
+        const BetaRecordLeaf *beta = j < nminus ?
+                                     (BetaRecordLeaf *)myBetaMinusRecords[j] :
+                                     (BetaRecordLeaf *)myBetaPlusRecords[j-nminus];
+        egsCacheWrite(out,egsCacheIndex(myParentRecords,beta->getParentRecord()));
+        egsCacheWrite(out,egsCacheIndex(myNormalizationRecords,beta->getNormalizationRecord()));
+        egsCacheWrite(out,egsCacheIndex(levels,beta->getLevelRecord()));
+        egsCacheWrite(out,beta->finalEnergy);
+        egsCacheWrite(out,beta->betaIntensity);
+        egsCacheWrite(out,beta->Z);
+        egsCacheWrite(out,beta->A);
+        egsCacheWrite(out,beta->forbidden);
+        egsCacheWrite(out,beta->ecShellIntensity);
+        egsCacheWrite(out,beta->spectrumEnergies);
+        egsCacheWrite(out,beta->spectrumValues);
+        if (j < nminus) {
+            egsCacheWrite(out,myBetaMinusRecords[j]->betaIntensityUnc);
+        }
+        else {
+            const BetaPlusRecord *bp = myBetaPlusRecords[j-nminus];
+            egsCacheWrite(out,bp->ecIntensity);
+            egsCacheWrite(out,bp->positronIntensity);
+            egsCacheWrite(out,bp->ecIntensityUnc);
+            egsCacheWrite(out,bp->positronIntensityUnc);
+        }
+    }
+
+    n = myAlphaRecords.size();
+    egsCacheWrite(out,n);
+    for (int j=0; j<n; ++j) {
+        const AlphaRecord *alpha = myAlphaRecords[j];
+        egsCacheWrite(out,egsCacheIndex(myParentRecords,alpha->getParentRecord()));
+        egsCacheWrite(out,egsCacheIndex(myNormalizationRecords,alpha->getNormalizationRecord()));
+        egsCacheWrite(out,egsCacheIndex(levels,alpha->getLevelRecord()));
+        egsCacheWrite(out,alpha->finalEnergy);
+        egsCacheWrite(out,alpha->alphaIntensity);
+        egsCacheWrite(out,alpha->alphaIntensityUnc);
+    }
+
+    for (int k=0; k<3; ++k) {
+        n = gammas[k]->size();
+        egsCacheWrite(out,n);
+        for (int j=0; j<n; ++j) {
+            const GammaRecord *gamma = (*gammas[k])[j];
+            egsCacheWrite(out,egsCacheIndex(myParentRecords,gamma->getParentRecord()));
+            egsCacheWrite(out,egsCacheIndex(myNormalizationRecords,gamma->getNormalizationRecord()));
+            egsCacheWrite(out,egsCacheIndex(levels,gamma->getLevelRecord()));
+            egsCacheWrite(out,egsCacheIndex(levels,(const LevelRecord *)gamma->finalLevel));
+            egsCacheWrite(out,gamma->decayEnergy);
+            egsCacheWrite(out,gamma->transitionIntensity);
+            egsCacheWrite(out,gamma->multipleTransitionProb);
+            egsCacheWrite(out,gamma->gammaIntensity);
+            egsCacheWrite(out,gamma->gammaIntensityUnc);
+            egsCacheWrite(out,gamma->icCoeff);
+            egsCacheWrite(out,gamma->icCoeffUnc);
+            egsCacheWrite(out,gamma->ipCoeff);
+            egsCacheWrite(out,gamma->ipCoeffUnc);
+            egsCacheWrite(out,gamma->q);
+            egsCacheWrite(out,gamma->icIntensity);
+        }
+    }
+    out.write(egs_ensdf_cache_id,8);
+    out.close();
+    if (out.fail()) {
+        remove(tmpFile.c_str());
+        return false;
+    }
+    if (rename(tmpFile.c_str(),cacheFile.c_str())) {
+        // Windows does not replace existing files
+        remove(cacheFile.c_str());
+        if (rename(tmpFile.c_str(),cacheFile.c_str())) {
+            remove(tmpFile.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EGS_Ensdf::readCache() {
+    ifstream in(cacheFile.c_str(),ios::binary);
+    if (!in) {
+        return false;
+    }
+    char id[8];
+    EGS_I64 key;
+    int fsize;
+    in.read(id,8);
+    if (!egsCacheRead(in,key) || !egsCacheRead(in,fsize) ||
+            memcmp(id,egs_ensdf_cache_id,8) || key != cacheKey ||
+            fsize != sizeof(EGS_Float)) {
+        return false;
+    }
+
+    bool ok = egsCacheRead(in,decayDiscrepancy) &&
+              egsCacheRead(in,xrayEnergies) && egsCacheRead(in,xrayIntensities) &&
+              egsCacheRead(in,augerEnergies) && egsCacheRead(in,augerIntensities);
+
+    int n = 0, nl = 0;
+    vector<LevelRecord *> levels;
+    ok = ok && egsCacheRead(in,n) && egsCacheRead(in,nl) &&
+         n >= 0 && nl >= 0 && nl <= n && n < 1000000;
+    for (int j=0; ok && j<n; ++j) {
+        LevelRecord *level = new LevelRecord();
+        if (j < nl) {
+            myLevelRecords.push_back(level);
+        }
+        else {
+            myCachedLevelRecords.push_back(level);
+        }
+        levels.push_back(level);
+        ok = egsCacheRead(in,level->energy) && egsCacheRead(in,level->halfLife) &&
+             egsCacheRead(in,level->disintegrationIntensity) &&
+             egsCacheRead(in,level->canDecay);
+    }
+
+    ok = ok && egsCacheRead(in,n) && n >= 0 && n < 1000000;
+    for (int j=0; ok && j<n; ++j) {
+        ParentRecord *parent = new ParentRecord();
+        myParentRecords.push_back(parent);
+        ok = egsCacheRead(in,parent->halfLife) && egsCacheRead(in,parent->Q);
+    }
+
+    ok = ok && egsCacheRead(in,n) && n >= 0 && n < 1000000;
+    for (int j=0; ok && j<n; ++j) {
+        ParentRecord *parent;
+        if (!egsCacheLink(in,myParentRecords,parent)) {
+            ok = false;
+            break;
+        }
+        NormalizationRecord *norm = new NormalizationRecord(parent);
+        myNormalizationRecords.push_back(norm);
+        ok = egsCacheRead(in,norm->normalizeRelative) &&
+             egsCacheRead(in,norm->normalizeTransition) &&
+             egsCacheRead(in,norm->normalizeBranch) &&
+             egsCacheRead(in,norm->normalizeBeta) &&
+             egsCacheRead(in,norm->Z);
+        if (ok) {
+            norm->loadRelaxations();
+        }
+    }
+
+    int nminus = 0, nplus = 0;
+    ok = ok && egsCacheRead(in,nminus) && egsCacheRead(in,nplus) &&
+         nminus >= 0 && nplus >= 0 && nminus+nplus < 1000000;
+    for (int j=0; ok && j<nminus+nplus; ++j) {
+        ParentRecord *parent;
+        NormalizationRecord *norm;
+        LevelRecord *level;
+        if (!egsCacheLink(in,myParentRecords,parent) ||
+                !egsCacheLink(in,myNormalizationRecords,norm) ||
+                !egsCacheLink(in,levels,level)) {
+            ok = false;
+            break;
+        }
+        BetaRecordLeaf *beta;
+        if (j < nminus) {
+            myBetaMinusRecords.push_back(new BetaMinusRecord(parent,norm,level));
+            beta = myBetaMinusRecords.back();
+        }
+        else {
+            myBetaPlusRecords.push_back(new BetaPlusRecord(parent,norm,level));
+            beta = myBetaPlusRecords.back();
+        }
+        ok = egsCacheRead(in,beta->finalEnergy) &&
+             egsCacheRead(in,beta->betaIntensity) &&
+             egsCacheRead(in,beta->Z) && egsCacheRead(in,beta->A) &&
+             egsCacheRead(in,beta->forbidden) &&
+             egsCacheRead(in,beta->ecShellIntensity) &&
+             egsCacheRead(in,beta->spectrumEnergies) &&
+             egsCacheRead(in,beta->spectrumValues) &&
+             beta->spectrumEnergies.size() == beta->spectrumValues.size();
+        if (!ok) {
+            break;
+        }
+        if (j < nminus) {
+            ok = egsCacheRead(in,myBetaMinusRecords.back()->betaIntensityUnc);
+        }
+        else {
+            BetaPlusRecord *bp = myBetaPlusRecords.back();
+            ok = egsCacheRead(in,bp->ecIntensity) &&
+                 egsCacheRead(in,bp->positronIntensity) &&
+                 egsCacheRead(in,bp->ecIntensityUnc) &&
+                 egsCacheRead(in,bp->positronIntensityUnc);
+        }
+    }
+
+    ok = ok && egsCacheRead(in,n) && n >= 0 && n < 1000000;
+    for (int j=0; ok && j<n; ++j) {
+        ParentRecord *parent;
+        NormalizationRecord *norm;
+        LevelRecord *level;
+        if (!egsCacheLink(in,myParentRecords,parent) ||
+                !egsCacheLink(in,myNormalizationRecords,norm) ||
+                !egsCacheLink(in,levels,level)) {
+            ok = false;
+            break;
+        }
+        AlphaRecord *alpha = new AlphaRecord(parent,norm,level);
+        myAlphaRecords.push_back(alpha);
+        ok = egsCacheRead(in,alpha->finalEnergy) &&
+             egsCacheRead(in,alpha->alphaIntensity) &&
+             egsCacheRead(in,alpha->alphaIntensityUnc);
+    }
+
+    vector<GammaRecord *> *gammas[3] = {&myGammaRecords,
+                                        &myMetastableGammaRecords, &myUncorrelatedGammaRecords
+                                       };
+    for (int k=0; ok && k<3; ++k) {
+        ok = egsCacheRead(in,n) && n >= 0 && n < 1000000;
+        for (int j=0; ok && j<n; ++j) {
+            ParentRecord *parent;
+            NormalizationRecord *norm;
+            LevelRecord *level, *finalLevel;
+            if (!egsCacheLink(in,myParentRecords,parent) ||
+                    !egsCacheLink(in,myNormalizationRecords,norm) ||
+                    !egsCacheLink(in,levels,level) ||
+                    !egsCacheLink(in,levels,finalLevel)) {
+                ok = false;
+                break;
+            }
+            GammaRecord *gamma = new GammaRecord(parent,norm,level);
+            gammas[k]->push_back(gamma);
+            gamma->finalLevel = finalLevel;
+            ok = egsCacheRead(in,gamma->decayEnergy) &&
+                 egsCacheRead(in,gamma->transitionIntensity) &&
+                 egsCacheRead(in,gamma->multipleTransitionProb) &&
+                 egsCacheRead(in,gamma->gammaIntensity) &&
+                 egsCacheRead(in,gamma->gammaIntensityUnc) &&
+                 egsCacheRead(in,gamma->icCoeff) &&
+                 egsCacheRead(in,gamma->icCoeffUnc) &&
+                 egsCacheRead(in,gamma->ipCoeff) &&
+                 egsCacheRead(in,gamma->ipCoeffUnc) &&
+                 egsCacheRead(in,gamma->q) &&
+                 egsCacheRead(in,gamma->icIntensity);
+        }
+    }
+
+    if (ok) {
+        in.read(id,8);
+        ok = !in.fail() && !memcmp(id,egs_ensdf_cache_id,8);
+    }
+    if (!ok) {
+        egsWarning("EGS_Ensdf::readCache: the cache file %s is corrupt and"
+                   " will be replaced\n",cacheFile.c_str());
+        deleteRecords();
+        decayDiscrepancy = 0;
+        xrayEnergies.clear();
+        xrayIntensities.clear();
+        augerEnergies.clear();
+        augerIntensities.clear();
+        return false;
+    }
+
+    // Combine the beta- and beta+ records together
+    for (vector<BetaMinusRecord * >::iterator it = myBetaMinusRecords.begin();
+            it!=myBetaMinusRecords.end(); it++) {
+        myBetaRecords.push_back(*it);
+    }
+    for (vector<BetaPlusRecord * >::iterator it = myBetaPlusRecords.begin();
+            it!=myBetaPlusRecords.end(); it++) {
+        myBetaRecords.push_back(*it);
+    }
+    return true;
+}
+
 // Parse an ensdf file to create a decay structure
 void EGS_Ensdf::parseEnsdf(vector<string> ensdf) {
     /* IDs of recordStack
@@ -853,6 +1307,12 @@ void EGS_Ensdf::buildRecords() {
 
 // Normalize intensities for alpha, beta, gamma objects
 void EGS_Ensdf::normalizeIntensities() {
+    // The intensities of cached data are already normalized
+    if (normalized) {
+        return;
+    }
+    normalized = true;
+
     if (verbose) {
         egsInformation("EGS_Ensdf::normalizeIntensities: Normalizing the "
                        "emission intensities to allow for spectrum sampling "
@@ -1987,6 +2447,11 @@ ParentRecord::ParentRecord(vector<string> ensdf):Record(ensdf) {
     processEnsdf();
 }
 
+ParentRecord::ParentRecord():Record() {
+    halfLife = 0;
+    Q = 0;
+}
+
 void ParentRecord::processEnsdf() {
     halfLife = parseHalfLife(40, 49);
 
@@ -2027,6 +2492,17 @@ NormalizationRecord::NormalizationRecord(vector<string> ensdf,
     processEnsdf();
 }
 
+NormalizationRecord::NormalizationRecord(ParentRecord *myParent):
+    Record(), ParentRecordLeaf(myParent) {
+    normalizeRelative = 1;
+    normalizeTransition = 1;
+    normalizeBranch = 1;
+    normalizeBeta = 1;
+    relaxations = 0;
+    nshell = 0;
+    Z = 0;
+}
+
 void NormalizationRecord::processEnsdf() {
     normalizeRelative = recordToDouble(10, 19);
     normalizeTransition = recordToDouble(22, 29);
@@ -2054,6 +2530,10 @@ void NormalizationRecord::processEnsdf() {
     // Get the Z
     Z = setZ(element);
 
+    loadRelaxations();
+}
+
+void NormalizationRecord::loadRelaxations() {
     // Load atomic relaxations
     relaxations = new EGS_AtomicRelaxations();
     relaxations->loadData(Z);
@@ -2125,11 +2605,13 @@ LevelRecord::LevelRecord() {
     energy = 0;
     halfLife = 0;
     disintegrationIntensity = 0;
+    canDecay = false;
 }
 LevelRecord::LevelRecord(vector<string> ensdf):
     Record(ensdf) {
     processEnsdf();
     disintegrationIntensity = 0;
+    canDecay = false;
 }
 
 void LevelRecord::processEnsdf() {
@@ -2185,6 +2667,7 @@ BetaRecordLeaf::BetaRecordLeaf(vector<string> ensdf,
     LevelRecordLeaf(myLevel) {
 
     numSampled = 0;
+    spectrum = 0;
 
     // Set the Z and atomic weight for the daughter of this decay
     string id = egsRemoveWhite(lines.front().substr(0,5));
@@ -2211,6 +2694,25 @@ BetaRecordLeaf::BetaRecordLeaf(vector<string> ensdf,
         forbidden = 0;
     }
 }
+
+BetaRecordLeaf::BetaRecordLeaf(ParentRecord *myParent,
+                               NormalizationRecord *myNormalization,
+                               LevelRecord *myLevel):
+    Record(),
+    ParentRecordLeaf(myParent),
+    NormalizationRecordLeaf(myNormalization),
+    LevelRecordLeaf(myLevel) {
+
+    numSampled = 0;
+    finalEnergy = 0;
+    betaIntensity = 0;
+    q = 0;
+    Z = 0;
+    A = 0;
+    forbidden = 0;
+    spectrum = 0;
+}
+
 int BetaRecordLeaf::getCharge() const {
     return q;
 }
@@ -2239,6 +2741,20 @@ void BetaRecordLeaf::setSpectrum(EGS_AliasTable *bspec) {
     spectrum = bspec;
 }
 
+void BetaRecordLeaf::setSpectrumTable(const vector<EGS_Float> &e,
+                                      const vector<EGS_Float> &f) {
+    spectrumEnergies = e;
+    spectrumValues = f;
+}
+
+const vector<EGS_Float> &BetaRecordLeaf::getSpectrumEnergies() const {
+    return spectrumEnergies;
+}
+
+const vector<EGS_Float> &BetaRecordLeaf::getSpectrumValues() const {
+    return spectrumValues;
+}
+
 EGS_AliasTable *BetaRecordLeaf::getSpectrum() const {
     return spectrum;
 }
@@ -2255,6 +2771,14 @@ BetaMinusRecord::BetaMinusRecord(vector<string> ensdf,
     myLevel->cumulDisintegrationIntensity(betaIntensity);
 }
 
+BetaMinusRecord::BetaMinusRecord(ParentRecord *myParent,
+                                 NormalizationRecord *myNormalization,
+                                 LevelRecord *myLevel):
+    BetaRecordLeaf(myParent, myNormalization, myLevel) {
+    q = -1;
+    betaIntensityUnc = 0;
+}
+
 void BetaMinusRecord::processEnsdf() {
     finalEnergy = recordToDouble(10, 19) / 1000.; // Convert keV to MeV
     betaIntensity = recordToDouble(22, 29);
@@ -2303,6 +2827,17 @@ BetaPlusRecord::BetaPlusRecord(vector<string> ensdf,
     myLevel->cumulDisintegrationIntensity(betaIntensity);
 }
 
+BetaPlusRecord::BetaPlusRecord(ParentRecord *myParent,
+                               NormalizationRecord *myNormalization,
+                               LevelRecord *myLevel):
+    BetaRecordLeaf(myParent, myNormalization, myLevel) {
+    q = 1;
+    ecIntensity = 0;
+    positronIntensity = 0;
+    ecIntensityUnc = 0;
+    positronIntensityUnc = 0;
+}
+
 void BetaPlusRecord::processEnsdf() {
     finalEnergy = recordToDouble(10, 19) / 1000.; // Convert keV to MeV
     positronIntensity = recordToDouble(22, 29);
@@ -2500,6 +3035,29 @@ GammaRecord::GammaRecord(vector<string> ensdf,
     multipleTransitionProb = 0;
 }
 
+GammaRecord::GammaRecord(ParentRecord *myParent,
+                         NormalizationRecord *myNormalization,
+                         LevelRecord *myLevel):
+    Record(),
+    ParentRecordLeaf(myParent),
+    NormalizationRecordLeaf(myNormalization),
+    LevelRecordLeaf(myLevel) {
+    q = 0;
+    numGammaSampled = 0;
+    numICSampled = 0;
+    numIPSampled = 0;
+    decayEnergy = 0;
+    transitionIntensity = 0;
+    multipleTransitionProb = 0;
+    gammaIntensity = 0;
+    gammaIntensityUnc = 0;
+    icCoeff = 0;
+    icCoeffUnc = 0;
+    ipCoeff = 0;
+    ipCoeffUnc = 0;
+    finalLevel = 0;
+}
+
 GammaRecord::GammaRecord(GammaRecord *gamma):
     Record(),
     ParentRecordLeaf(gamma->getParentRecord()),
@@ -2796,6 +3354,19 @@ AlphaRecord::AlphaRecord(vector<string> ensdf,
     myLevel->cumulDisintegrationIntensity(alphaIntensity);
 }
 
+AlphaRecord::AlphaRecord(ParentRecord *myParent,
+                         NormalizationRecord *myNormalization,
+                         LevelRecord *myLevel):
+    Record(),
+    ParentRecordLeaf(myParent), NormalizationRecordLeaf(myNormalization),
+    LevelRecordLeaf(myLevel) {
+    q = 2;
+    numSampled = 0;
+    finalEnergy = 0;
+    alphaIntensity = 0;
+    alphaIntensityUnc = 0;
+}
+
 void AlphaRecord::processEnsdf() {
     finalEnergy = recordToDouble(10, 19) / 1000.; // Convert keV to MeV
     alphaIntensity = recordToDouble(22, 29);
@@ -185,12 +185,15 @@ private:
 
 // Parent Record
 class ParentRecord : public Record, public Branch<Leaf<ParentRecord> > {
+    friend class EGS_Ensdf;
 public:
     ParentRecord(vector<string> ensdf);
     double getHalfLife() const;
     double getQ() const;
 
 protected:
+    ParentRecord();
+
     double  halfLife,
             Q;
 
@@ -207,6 +210,7 @@ public:
 // Normalization Record
 class NormalizationRecord : public Record, public
     Branch<Leaf<NormalizationRecord> >, public ParentRecordLeaf {
+    friend class EGS_Ensdf;
 public:
     NormalizationRecord(vector<string> ensdf, ParentRecord *parent);
     double getRelativeMultiplier() const;
@@ -222,6 +226,8 @@ public:
                EGS_SimpleContainer<EGS_RelaxationParticle> &particles);
 
 protected:
+    NormalizationRecord(ParentRecord *parent);
+
     double normalizeRelative;
     double normalizeTransition;
     double normalizeBeta;
@@ -229,6 +235,7 @@ protected:
 
 private:
     void processEnsdf();
+    void loadRelaxations();
     EGS_AtomicRelaxations *relaxations;
     int nshell, Z;
 };
@@ -241,6 +248,7 @@ public:
 
 // Level Record
 class EGS_EXPORT LevelRecord : public Record, public Branch<Leaf<LevelRecord> > {
+    friend class EGS_Ensdf;
 public:
     LevelRecord();
     LevelRecord(vector<string> ensdf);
@@ -271,6 +279,7 @@ public:
 // Generic beta record
 class EGS_EXPORT BetaRecordLeaf : public Record, public ParentRecordLeaf, public
     NormalizationRecordLeaf, public LevelRecordLeaf {
+    friend class EGS_Ensdf;
 public:
     BetaRecordLeaf(vector<string> ensdf, ParentRecord *myParent,
                    NormalizationRecord *myNormalization, LevelRecord *myLevel);
@@ -296,9 +305,16 @@ public:
     unsigned short int getForbidden() const;
     void setSpectrum(EGS_AliasTable *bspec);
     EGS_AliasTable *getSpectrum() const;
+    void setSpectrumTable(const vector<EGS_Float> &e,
+                          const vector<EGS_Float> &f);
+    const vector<EGS_Float> &getSpectrumEnergies() const;
+    const vector<EGS_Float> &getSpectrumValues() const;
     vector<double> ecShellIntensity;
 
 protected:
+    BetaRecordLeaf(ParentRecord *myParent,
+                   NormalizationRecord *myNormalization, LevelRecord *myLevel);
+
     EGS_I64 numSampled;
     double finalEnergy;
     double betaIntensity;
@@ -307,10 +323,13 @@ protected:
     unsigned short int A;
     unsigned short int forbidden;
     EGS_AliasTable *spectrum;
+    vector<EGS_Float> spectrumEnergies,
+           spectrumValues;
 };
 
 // Beta- record
 class EGS_EXPORT BetaMinusRecord : public BetaRecordLeaf {
+    friend class EGS_Ensdf;
 public:
     BetaMinusRecord(vector<string> ensdf, ParentRecord *myParent,
                     NormalizationRecord *myNormalization, LevelRecord *myLevel);
@@ -320,6 +339,10 @@ public:
     double getBetaIntensityUnc() const;
     void setBetaIntensity(double newIntensity);
 
+protected:
+    BetaMinusRecord(ParentRecord *myParent,
+                    NormalizationRecord *myNormalization, LevelRecord *myLevel);
+
 private:
     void processEnsdf();
     double betaIntensityUnc;
@@ -327,6 +350,7 @@ private:
 
 // Beta+ Record (and Electron Capture)
 class EGS_EXPORT BetaPlusRecord : public BetaRecordLeaf {
+    friend class EGS_Ensdf;
 public:
     BetaPlusRecord(vector<string> ensdf, ParentRecord *myParent,
                    NormalizationRecord *myNormalization, LevelRecord *myLevel);
@@ -344,6 +368,9 @@ public:
                EGS_SimpleContainer<EGS_RelaxationParticle> &particles);
 
 protected:
+    BetaPlusRecord(ParentRecord *myParent,
+                   NormalizationRecord *myNormalization, LevelRecord *myLevel);
+
     double  ecIntensity,
             positronIntensity,
             ecIntensityUnc,
@@ -356,6 +383,7 @@ private:
 // Gamma record
 class EGS_EXPORT GammaRecord : public Record, public ParentRecordLeaf,
     public NormalizationRecordLeaf, public LevelRecordLeaf {
+    friend class EGS_Ensdf;
 public:
     GammaRecord(vector<string> ensdf, ParentRecord *myParent,
                 NormalizationRecord *myNormalization,
@@ -392,6 +420,9 @@ public:
                EGS_SimpleContainer<EGS_RelaxationParticle> &particles);
 
 protected:
+    GammaRecord(ParentRecord *myParent,
+                NormalizationRecord *myNormalization, LevelRecord *myLevel);
+
     EGS_I64 numGammaSampled, numICSampled, numIPSampled;
     double  decayEnergy;
     double  transitionIntensity,
@@ -412,6 +443,7 @@ private:
 // Alpha record
 class EGS_EXPORT AlphaRecord : public Record, public ParentRecordLeaf, public
     NormalizationRecordLeaf, public LevelRecordLeaf {
+    friend class EGS_Ensdf;
 public:
     AlphaRecord(vector<string> ensdf, ParentRecord *myParent,
                 NormalizationRecord *myNormalization, LevelRecord *myLevel);
@@ -425,6 +457,9 @@ public:
     EGS_I64 getNumSampled() const;
 
 protected:
+    AlphaRecord(ParentRecord *myParent,
+                NormalizationRecord *myNormalization, LevelRecord *myLevel);
+
     EGS_I64 numSampled;
     double  finalEnergy,
             alphaIntensity,
@@ -484,6 +519,16 @@ would be used.
 221FR T        16.752-17.799                     XLG
 \endverbatim
 
+The parsed and normalized decay data can be cached in a binary file,
+<code>{ensdf file}.egsensdf</code>, by constructing the object with
+\a useCache set to \c true. The cache is validated with a hash of the
+ensdf file contents and the relaxation and multiple transition options.
+If it is valid, the records are restored from it instead of parsing
+the ensdf file and normalizeIntensities() does nothing. Otherwise the
+file is parsed as usual and writeCache() can be used to store the
+data once the intensities are normalized and the beta spectra are
+tabulated (see BetaRecordLeaf::setSpectrumTable()).
+
 The ensdf class has been tested on radionuclide data from
 <a href="http://www.nucleide.org/DDEP_WG/DDEPdata.htm">LNHB DDEP</a>.
 
@@ -497,7 +542,8 @@ public:
      *
      */
     EGS_Ensdf(const string nuclide, const string ensdf_filename="",
-              const string relaxType="eadl", const bool allowMultiTrans=false, int verbosity=1);
+              const string relaxType="eadl", const bool allowMultiTrans=false, int verbosity=1,
+              const bool useCache=false);
 
     /*! \brief Destructor. */
     ~EGS_Ensdf();
@@ -524,8 +570,23 @@ public:
 
     void normalizeIntensities();
 
+    /*! \brief Returns \c true if the data was restored from the cache */
+    bool isCached() const {
+        return cached;
+    };
+
+    /*! \brief Write the decay data to the cache file
+
+      Returns \c false if caching was not requested or the file could
+      not be written.
+    */
+    bool writeCache() const;
+
 protected:
 
+    bool readCache();
+    void deleteRecords();
+
     unsigned short int findAtomicWeight(string element);
     void parseEnsdf(vector<string> ensdf);
     void buildRecords();
@@ -547,6 +608,12 @@ protected:
     vector<GammaRecord * > myGammaRecords;
     vector<GammaRecord * > myMetastableGammaRecords;
     vector<GammaRecord * > myUncorrelatedGammaRecords;
+    vector<LevelRecord * > myCachedLevelRecords;
+
+    string cacheFile;   //!< Cache file name, empty if not caching
+    EGS_I64 cacheKey;   //!< Hash of the ensdf data and options
+    bool cached;        //!< Data was restored from the cache
+    bool normalized;    //!< normalizeIntensities() has been called
 
 private:
 
@@ -50,7 +50,9 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <fstream>
+#include <map>
 
 using namespace std;
 
@@ -63,6 +65,11 @@ static char indent_space[] = "    ";
 #ifndef SKIP_DOXYGEN
 /*! \brief Private implementation of the EGS_Input functionality.
 
+    The children of an input item are indexed by their normalized key
+    (see normalizeKey()), so that looking up or taking an item does not
+    require comparing the keys of all children. The index is built when
+    first needed and kept up to date by addChild() and takeInputItem().
+
     \internwarning
 */
 class EGS_LOCAL EGS_InputPrivate {
@@ -72,11 +79,22 @@ public:
     vector<EGS_InputPrivate *> children;
     int nref;
 
-    EGS_InputPrivate() : nref(0) {};
+    /*! The children with the same normalized key in input order. Taken
+        items before first are no longer children. */
+    struct KeyList {
+        vector<EGS_InputPrivate *> items;
+        unsigned int first;
+        KeyList() : first(0) {};
+    };
+    typedef map<string, KeyList> KeyIndex;
+    mutable KeyIndex index;   //!< children by normalized key
+    mutable bool     indexed; //!< true if index is valid
+
+    EGS_InputPrivate() : nref(0), indexed(false) {};
     EGS_InputPrivate(const string &Key, const string &Val = "") : key(Key),
-        value(Val), children(), nref(0) { };
+        value(Val), children(), nref(0), indexed(false) { };
     EGS_InputPrivate(const EGS_InputPrivate &p, bool deep=false) :
-        key(p.key), value(p.value), children(), nref(0) {
+        key(p.key), value(p.value), children(), nref(0), indexed(false) {
         for (unsigned int j=0; j<p.children.size(); j++) {
             if (deep) {
                 children.push_back(new EGS_InputPrivate(*p.children[j],deep));
@@ -103,42 +121,72 @@ public:
     int addContentFromFile(const char *fname);
     int addContentFromString(string &input);
     int addContent(istream &input);
+    int addContent(const char *text, size_t n);
 
     void processInputLoop(EGS_InputPrivate *p);
 
     void addItem(EGS_InputPrivate *p) {
         p->nref++;
+        addChild(p);
+    };
+
+    void addChild(EGS_InputPrivate *p) {
         children.push_back(p);
+        if (indexed) {
+            index[normalizeKey(p->key)].items.push_back(p);
+        }
+    };
+
+    void clearChildren() {
+        for (unsigned int j=0; j<children.size(); j++) {
+            delete children[j];
+        }
+        children.erase(children.begin(),children.end());
+        index.clear();
+        indexed = false;
+    };
+
+    void buildIndex() const {
+        index.clear();
+        for (unsigned int j=0; j<children.size(); j++) {
+            index[normalizeKey(children[j]->key)].items.push_back(children[j]);
+        }
+        indexed = true;
+    };
+
+    /*! The first child with a key matching \a Key or 0 if none */
+    EGS_InputPrivate *findChild(const string &Key) const {
+        if (!indexed) {
+            buildIndex();
+        }
+        KeyIndex::const_iterator it = index.find(normalizeKey(Key));
+        if (it == index.end() || it->second.first >= it->second.items.size()) {
+            return 0;
+        }
+        return it->second.items[it->second.first];
     };
 
     EGS_InputPrivate *takeInputItem(const string &key, bool self=true) {
         if (self && isA(key)) {
             return this;
         }
-        for (vector<EGS_InputPrivate *>::iterator it=children.begin();
-                it != children.end(); it++) {
-            if (compareKeys((*it)->key,key)) {
-                EGS_InputPrivate *res = *it;
-                children.erase(it);
-                return res;
-            }
-            //if( (*it)->key == key ) {
-            //    EGS_InputPrivate *res = *it;
-            //    children.erase(it); return res;
-            //}
+        if (!indexed) {
+            buildIndex();
         }
-        return 0;
+        KeyIndex::iterator it = index.find(normalizeKey(key));
+        if (it == index.end() || it->second.first >= it->second.items.size()) {
+            return 0;
+        }
+        EGS_InputPrivate *res = it->second.items[it->second.first++];
+        children.erase(std::find(children.begin(),children.end(),res));
+        return res;
     };
 
     EGS_InputPrivate *getInputItem(const string &Key) {
         if (isA(Key)) {
             return this;
         }
-        for (unsigned int j=0; j<children.size(); j++)
-            if (compareKeys(children[j]->key,Key)) {
-                return children[j];
-            }
-        return 0;
+        return findChild(Key);
     };
 
     bool isA(const string &Key) const {
@@ -155,10 +203,11 @@ public:
                         const string &end_string, const string &input, int &ie);
 
     static bool compareKeys(const string &s1, const string &s2);
+    static string normalizeKey(const string &s);
 
     void print(int nind, ostream &) const;
 
-    void removeEmptyLines(string &input);
+    static void removeEmptyLines(string &input);
 
     static void deleteItem(EGS_InputPrivate *p) {
         if (p) {
@@ -294,13 +343,7 @@ get_input(const EGS_InputPrivate *p, const string &key, vector<T> &values) {
         p1 = p;
     }
     else {
-        for (unsigned int j=0; j<p->children.size(); j++) {
-            p1 = p->children[j];
-            if (p1->isA(key)) {
-                break;
-            }
-            p1 = 0;
-        }
+        p1 = p->findChild(key);
         if (!p1) {
             return -1;
         }
@@ -359,13 +402,7 @@ get_input(const EGS_InputPrivate *p, const string &key, T &value) {
         p1 = p;
     }
     else {
-        for (unsigned int j=0; j<p->children.size(); j++) {
-            p1 = p->children[j];
-            if (p1->isA(key)) {
-                break;
-            }
-            p1 = 0;
-        }
+        p1 = p->findChild(key);
         if (!p1) {
             return -1;
         }
@@ -506,57 +543,70 @@ int EGS_InputPrivate::addContentFromFile(const char *fname) {
 }
 
 int EGS_InputPrivate::setContentFromString(string &input) {
-    S_STREAM in(input.c_str());
-    return setContent(in);
+    clearChildren();
+    return addContent(input.c_str(),strlen(input.c_str()));
 }
 
 int EGS_InputPrivate::addContentFromString(string &input) {
-    S_STREAM in(input.c_str());
-    return addContent(in);
+    return addContent(input.c_str(),strlen(input.c_str()));
 }
 
+/* Removes all text from start up to end (or up to but not including end
+   if newline is true). The result is the same as erasing the comments one
+   by one, but the text is copied only once, so that the time needed is
+   linear in the input size. */
 void EGS_InputPrivate::removeComment(const string &start, const string &end,
                                      string &input, bool newline) {
-    string::size_type spos=0, epos=0;
-    while ((epos = input.find(end,spos)) < input.size()) {
-        spos = input.find(start,spos);
+    string res;
+    res.reserve(input.size());
+    string::size_type spos=0, epos=0, pos=0;
+    bool first = true;
+    for (;;) {
+        // the next occurences of end and start are only searched for
+        // again once pos has moved past them
+        if (first || (epos != string::npos && epos < pos)) {
+            epos = input.find(end,pos);
+        }
+        if (epos == string::npos) {
+            break;
+        }
+        if (first || (spos != string::npos && spos < pos)) {
+            spos = input.find(start,pos);
+        }
+        first = false;
         if (spos < epos) {
-            string::size_type len = epos - spos;
-            if (!newline) {
-                len += end.size();
-            }
-            input.erase(spos,len);
+            res.append(input,pos,spos-pos);
             if (newline) {
-                spos += end.size();
+                res.append(input,epos,end.size());
             }
+            pos = epos + end.size();
         }
         else {
-            spos = epos+1;
+            res.append(input,pos,epos+1-pos);
+            pos = epos+1;
         }
     }
+    res.append(input,pos,string::npos);
+    input.swap(res);
 }
 
 int EGS_InputPrivate::setContent(istream &in) {
-    for (unsigned int j=0; j<children.size(); j++) {
-        delete children[j];
-    }
-    children.erase(children.begin(),children.end());
+    clearChildren();
     return addContent(in);
 }
 
-bool EGS_InputPrivate::compareKeys(const string &s1, const string &s2) {
-    string t1, t2;
-    unsigned int j;
-    for (j=0; j<s1.size(); j++)
-        if (!isspace(s1[j])) {
-            t1 += ::toupper(s1[j]);
+string EGS_InputPrivate::normalizeKey(const string &s) {
+    string t;
+    t.reserve(s.size());
+    for (unsigned int j=0; j<s.size(); j++)
+        if (!isspace(s[j])) {
+            t += ::toupper(s[j]);
         }
-    for (j=0; j<s2.size(); j++)
-        if (!isspace(s2[j])) {
-            t2 += ::toupper(s2[j]);
-        }
-    return (t1 == t2);
+    return t;
+}
 
+bool EGS_InputPrivate::compareKeys(const string &s1, const string &s2) {
+    return (normalizeKey(s1) == normalizeKey(s2));
 }
 
 #ifdef INPUT_DEBUG
@@ -579,6 +629,11 @@ int EGS_InputPrivate::replace(const string &replace_what,
     for (int j=0; j<children.size(); j++) {
         nr += children[j]->replace(replace_what,replace_with);
     }
+    if (nr) {
+        // the keys of the children may have changed
+        index.clear();
+        indexed = false;
+    }
     return nr;
 }
 #endif
@@ -863,7 +918,7 @@ void EGS_InputPrivate::processInputLoop(EGS_InputPrivate *p) {
                 pnew->replace(ivars[ivar]->getVarNameReplacement(),
                               ivars[ivar]->getVarReplacement());
             }
-            children.push_back(pnew);
+            addChild(pnew);
         }
     }
 
@@ -874,7 +929,6 @@ void EGS_InputPrivate::processInputLoop(EGS_InputPrivate *p) {
 
 int EGS_InputPrivate::addContent(istream &in) {
     string input;
-    bool last_was_space = false;
     for (EGS_I64 loopCount=0; loopCount<=loopMax; ++loopCount) {
         if (loopCount == loopMax) {
             egsFatal("EGS_InputPrivate::addContent: Too many iterations were required! Input may be invalid, or consider increasing loopMax.");
@@ -885,6 +939,21 @@ int EGS_InputPrivate::addContent(istream &in) {
         if (in.eof() || !in.good()) {
             break;
         }
+        input += c;
+    }
+    return addContent(input.c_str(),input.size());
+}
+
+/* Parses the n characters of text in a single pass: after removing
+   comments and empty lines, the text is scanned once for :start and :stop
+   delimiters. The content of each block is parsed recursively and the text
+   outside of the blocks is collected for the key = value pairs. */
+int EGS_InputPrivate::addContent(const char *text, size_t n) {
+    string input;
+    input.reserve(n);
+    bool last_was_space = false;
+    for (size_t k=0; k<n; k++) {
+        char c = text[k];
         bool take_it = true;
         if (isspace(c)) {
             if (last_was_space && c != '\n') {
@@ -904,12 +973,14 @@ int EGS_InputPrivate::addContent(istream &in) {
     removeComment("//","\n",input,true);
     removeComment("/*","*/",input,false);
     removeEmptyLines(input);
-    vector<string> start_keys, stop_keys;
     int p = 0;
-    int ep = input.size();
+    int last = 0;   // start of the text not yet copied to rest
+    string rest;    // the input without the blocks
+    rest.reserve(input.size());
     string what;
     int ie;
-    while ((p=findStart(p,ep,start_key_begin,start_key_end,input,what,ie))>=0) {
+    while ((p=findStart(p,input.size(),start_key_begin,start_key_end,input,
+                        what,ie))>=0) {
         string the_start = start_key_begin;
         string the_end = stop_key_begin;
         for (int j=0; j<what.size(); j++) {
@@ -927,14 +998,18 @@ int EGS_InputPrivate::addContent(istream &in) {
             EGS_InputPrivate *ip = new EGS_InputPrivate(what);
             string content;
             content.assign(input,ie+1,p1-ie-1);
-            input.erase(p,ep-p);
-            ip->setContentFromString(content);
+            // everything up to, but not including, the last character of
+            // the stop delimiter is removed from the input
+            rest.append(input,last,p-last);
+            last = ep;
+            p = ep;
+            ip->addContentFromString(content);
             if (ip->isA("input loop")) {
                 processInputLoop(ip);
                 delete ip;
             }
             else {
-                children.push_back(ip);
+                addChild(ip);
             }
         }
         else {
@@ -942,6 +1017,8 @@ int EGS_InputPrivate::addContent(istream &in) {
             return -1;
         }
     }
+    rest.append(input,last,string::npos);
+    input.swap(rest);
     p = 0;
     string::size_type p1;
     while ((p1=input.find('\n',p)) < input.size()) {
@@ -957,7 +1034,10 @@ int EGS_InputPrivate::addContent(istream &in) {
     }
     p=0;
     while ((p1=input.find('\n',p)) < input.size()) {
-        string::size_type p2 = input.find('=',p);
+        string::size_type p2 = p;
+        while (p2 < p1 && input[p2] != '=') {
+            ++p2;
+        }
         if (p2 < p1) {
             string what;
             what.assign(input,p,p2-p);
@@ -977,7 +1057,7 @@ int EGS_InputPrivate::addContent(istream &in) {
             }
             else {
                 EGS_InputPrivate *ip = new EGS_InputPrivate(what,value);
-                children.push_back(ip);
+                addChild(ip);
             }
         }
         p = p1+1;
@@ -1105,27 +1185,24 @@ void EGS_InputPrivate::print(int indent, ostream &out) const {
 }
 
 void EGS_InputPrivate::removeEmptyLines(string &input) {
-    int pos=0, pos1;
+    string res;
+    res.reserve(input.size());
+    string::size_type pos=0, pos1;
     while ((pos1=input.find('\n',pos)) < input.size()) {
-        if (pos1 == pos) {
-            input.erase(pos,1);
-        }
-        else {
-            bool is_only_space = true;
-            for (int j=pos; j<pos1; j++) {
-                if (!isspace(input[j])) {
-                    is_only_space = false;
-                    break;
-                }
-            }
-            if (is_only_space) {
-                input.erase(pos,pos1+1-pos);
-            }
-            else {
-                pos = pos1+1;
+        bool is_only_space = true;
+        for (string::size_type j=pos; j<pos1; j++) {
+            if (!isspace(input[j])) {
+                is_only_space = false;
+                break;
             }
         }
+        if (!is_only_space) {
+            res.append(input,pos,pos1+1-pos);
+        }
+        pos = pos1+1;
     }
+    res.append(input,pos,string::npos);
+    input.swap(res);
 }
 #endif
 
@@ -1155,10 +1232,99 @@ void egs_warning(const char *msg,...) {
     va_end(ap);
 }
 
+void egs_fatal(const char *msg,...) {
+    va_list ap;
+    va_start(ap, msg);
+    vfprintf(stderr, msg, ap);
+    va_end(ap);
+    exit(1);
+}
+
 EGS_InfoFunction egsWarning = egs_warning;
+EGS_InfoFunction egsFatal = egs_fatal;
 
-int main() {
+static int nfail = 0;
 
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr,"FAILED: %s\n",what);
+        ++nfail;
+    }
+}
+
+// The value of p without white space
+static string valueOf(EGS_InputPrivate *p) {
+    if (!p) {
+        return "(null)";
+    }
+    string v;
+    for (unsigned int j=0; j<p->value.size(); j++) {
+        if (!isspace(p->value[j])) {
+            v += p->value[j];
+        }
+    }
+    return v;
+}
+
+// Checks the key index: items with duplicate keys (differing in case
+// and white space) must be found and taken in input order, also when
+// items are added after the index was built.
+static int testIndex() {
+    string input =
+        "a = 1\n"
+        "b = 4\n"
+        "A = 2\n"
+        " a  = 3\n"
+        ":start geometry:\n    name = g1\n:stop geometry:\n"
+        ":start Geometry:\n    name = g2\n:stop Geometry:\n";
+    EGS_InputPrivate p("test");
+    p.setContentFromString(input);
+    check(p.children.size() == 6,"number of items");
+
+    check(valueOf(p.getInputItem("a")) == "1","get first duplicate");
+    check(valueOf(p.getInputItem(" A")) == "1","get is case insensitive");
+    EGS_InputPrivate *t = p.takeInputItem("a");
+    check(valueOf(t) == "1","take first duplicate");
+    EGS_InputPrivate::deleteItem(t);
+    check(valueOf(p.getInputItem("a")) == "2","get after take");
+
+    EGS_InputPrivate *extra = new EGS_InputPrivate("a","5");
+    p.addChild(extra);
+    const char *order[] = {"2", "3", "5"};
+    for (int j=0; j<3; j++) {
+        t = p.takeInputItem("a");
+        check(valueOf(t) == order[j],"take duplicates in input order");
+        EGS_InputPrivate::deleteItem(t);
+    }
+    check(!p.takeInputItem("a"),"take after all duplicates are taken");
+    check(!p.getInputItem("a"),"get after all duplicates are taken");
+    check(valueOf(p.getInputItem("b")) == "4","other keys are kept");
+
+    for (int j=0; j<2; j++) {
+        t = p.takeInputItem("geometry");
+        check(t && valueOf(t->getInputItem("name")) == (j ? "g2" : "g1"),
+              "take blocks in input order");
+        EGS_InputPrivate::deleteItem(t);
+    }
+    check(p.children.size() == 1 && p.children[0]->isA("b"),
+          "remaining items");
+
+    if (nfail) {
+        fprintf(stderr,"%d checks failed\n",nfail);
+        return 1;
+    }
+    fprintf(stderr,"all checks passed\n");
+    return 0;
+}
+
+// Prints the input read from standard input or, with -t, runs the
+// checks in testIndex(). Compile with
+//   g++ -DTEST -I../lib/$my_machine egs_input.cpp
+int main(int argc, char **argv) {
+
+    if (argc > 1 && !strcmp(argv[1],"-t")) {
+        return testIndex();
+    }
     EGS_InputPrivate p("test");
     p.setContent(cin);
     p.print(0,cout);
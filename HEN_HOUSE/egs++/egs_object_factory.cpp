@@ -37,6 +37,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cctype>
 
 #include "egs_object_factory.h"
 #include "egs_library.h"
@@ -44,6 +45,20 @@
 
 static unsigned int object_count = 0;
 
+// The key of the object type t in the known object index. Types are
+// compared as input keys (see EGS_Input::compare()), i.e., ignoring
+// case and white space.
+static string typeKey(const string &t) {
+    string key;
+    key.reserve(t.size());
+    for (unsigned int j=0; j<t.size(); j++) {
+        if (!isspace(t[j])) {
+            key += ::toupper(t[j]);
+        }
+    }
+    return key;
+}
+
 EGS_Object::EGS_Object(const string &Name, EGS_ObjectFactory *f) :
     name(Name), otype("EGS_Object"), nref(0), factory(f) {
     object_count++;
@@ -90,7 +105,16 @@ string EGS_Object::getUniqueName(const EGS_Object *o) {
     return result;
 }
 
+void EGS_Object::setObjectName(const string &Name) {
+    string oldname(name);
+    name = Name;
+    if (factory && name != oldname) {
+        factory->renameObject(this,oldname);
+    }
+}
+
 void EGS_Object::setName(EGS_Input *input) {
+    string oldname(name);
     int err = 1;
     if (input) {
         err = input->getInput("name",name);
@@ -98,6 +122,9 @@ void EGS_Object::setName(EGS_Input *input) {
     if (err) {
         name = getUniqueName(this);
     }
+    if (factory && name != oldname) {
+        factory->renameObject(this,oldname);
+    }
 }
 
 EGS_ObjectFactory::EGS_ObjectFactory(const string &dsoPath, int where) {
@@ -138,11 +165,48 @@ EGS_ObjectFactory::~EGS_ObjectFactory() {
 }
 
 void EGS_ObjectFactory::removeObject(EGS_Object *o) {
+    bool found = false;
     for (vector<EGS_Object *>::iterator i = objects.begin();
             i != objects.end(); i++) {
         if (o == *i) {
             // why not calling o->deref() here ?
             objects.erase(i);
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        return;
+    }
+    pair<multimap<string,EGS_Object *>::iterator,
+         multimap<string,EGS_Object *>::iterator> r =
+             index.equal_range(o->getObjectName());
+    for (multimap<string,EGS_Object *>::iterator i = r.first;
+            i != r.second; i++) {
+        if (i->second == o) {
+            index.erase(i);
+            return;
+        }
+    }
+    // the name was changed without going through setObjectName()
+    for (multimap<string,EGS_Object *>::iterator i = index.begin();
+            i != index.end(); i++) {
+        if (i->second == o) {
+            index.erase(i);
+            return;
+        }
+    }
+}
+
+void EGS_ObjectFactory::renameObject(EGS_Object *o, const string &oldname) {
+    pair<multimap<string,EGS_Object *>::iterator,
+         multimap<string,EGS_Object *>::iterator> r =
+             index.equal_range(oldname);
+    for (multimap<string,EGS_Object *>::iterator i = r.first;
+            i != r.second; i++) {
+        if (i->second == o) {
+            index.erase(i);
+            index.insert(make_pair(o->getObjectName(),o));
             break;
         }
     }
@@ -193,6 +257,14 @@ EGS_Object *EGS_ObjectFactory::createObjects(EGS_Input *i,
     return o;
 }
 
+void EGS_ObjectFactory::addKnownObject(EGS_Object *o) {
+    if (o) {
+        o->ref();
+        known_objects.push_back(o);
+        known_index.insert(make_pair(typeKey(o->getObjectType()),o));
+    }
+}
+
 EGS_Object *EGS_ObjectFactory::createSingleObject(EGS_Input *i,
         const char *funcname, bool unique) {
     if (!i) {
@@ -202,15 +274,14 @@ EGS_Object *EGS_ObjectFactory::createSingleObject(EGS_Input *i,
     string type;
     int err = i->getInput("type",type);
     if (!err) {
-        for (unsigned int j=0; j<known_objects.size(); j++) {
-            if (i->compare(type,known_objects[j]->getObjectType())) {
-                EGS_Object *o = known_objects[j]->createObject(i);
-                if (addObject(o,unique)) {
-                    return o;
-                }
-                EGS_Object::deleteObject(o);
-                return 0;
+        map<string,EGS_Object *>::iterator it = known_index.find(typeKey(type));
+        if (it != known_index.end()) {
+            EGS_Object *o = it->second->createObject(i);
+            if (addObject(o,unique)) {
+                return o;
             }
+            EGS_Object::deleteObject(o);
+            return 0;
         }
     }
     string libname;
@@ -225,11 +296,9 @@ EGS_Object *EGS_ObjectFactory::createSingleObject(EGS_Input *i,
         return 0;
     }
     EGS_Library *lib = 0;
-    for (unsigned int j=0; j<libs.size(); j++) {
-        if (libname == libs[j]->libraryName()) {
-            lib = libs[j];
-            break;
-        }
+    map<string,EGS_Library *>::iterator il = lib_index.find(libname);
+    if (il != lib_index.end()) {
+        lib = il->second;
     }
     if (!lib) {
         lib = new EGS_Library(libname.c_str(),dso_path.c_str());
@@ -241,6 +310,7 @@ EGS_Object *EGS_ObjectFactory::createSingleObject(EGS_Input *i,
             return 0;
         }
         libs.push_back(lib);
+        lib_index.insert(make_pair(string(lib->libraryName()),lib));
     }
     EGS_ObjectCreationFunction create;
     const char *fname = funcname ? funcname : "createObject";
@@ -265,31 +335,33 @@ bool EGS_ObjectFactory::addObject(EGS_Object *o, bool unique) {
                    " object\n");
         return false;
     }
-    for (unsigned int j=0; j<objects.size(); j++) {
-        if (objects[j] == o) {
-            return true;
-        }
+    if (haveObject(o)) {
+        return true;
     }
-    if (unique) {
-        for (unsigned int j=0; j<objects.size(); j++) {
-            if (o->getObjectName() == objects[j]->getObjectName()) {
-                egsWarning("EGS_ObjectFactory::addObject(): an object with "
-                           "the name %s already exists\n",o->getObjectName().c_str());
-                //if( o->deref() == -1 ) delete o;
-                return false;
-            }
-        }
+    if (unique && getObject(o->getObjectName())) {
+        egsWarning("EGS_ObjectFactory::addObject(): an object with "
+                   "the name %s already exists\n",o->getObjectName().c_str());
+        //if( o->deref() == -1 ) delete o;
+        return false;
     }
     //egsWarning("adding an object with name '%s' of type '%s' at 0x%x\n",
     //        o->getObjectName().c_str(),o->getObjectType().c_str(),o);
     objects.push_back(o);
+    index.insert(make_pair(o->getObjectName(),o));
     o->setFactory(this);
     return true;
 }
 
 bool EGS_ObjectFactory::haveObject(const EGS_Object *o) const {
-    for (unsigned int j=0; j<objects.size(); j++) {
-        if (objects[j] == o) {
+    if (!o) {
+        return false;
+    }
+    pair<multimap<string,EGS_Object *>::const_iterator,
+         multimap<string,EGS_Object *>::const_iterator> r =
+             index.equal_range(o->getObjectName());
+    for (multimap<string,EGS_Object *>::const_iterator i = r.first;
+            i != r.second; i++) {
+        if (i->second == o) {
             return true;
         }
     }
@@ -297,24 +369,17 @@ bool EGS_ObjectFactory::haveObject(const EGS_Object *o) const {
 }
 
 EGS_Object *EGS_ObjectFactory::getObject(const string &name) {
-    for (unsigned int j=0; j<objects.size(); j++) {
-        if (name == objects[j]->getObjectName()) {
-            return objects[j];
-        }
-    }
-    return 0;
+    multimap<string,EGS_Object *>::iterator i = index.find(name);
+    return i != index.end() ? i->second : 0;
 }
 
 EGS_Object *EGS_ObjectFactory::takeObject(const string &name) {
-    for (vector<EGS_Object *>::iterator i = objects.begin();
-            i != objects.end(); i++) {
-        if ((*i)->getObjectName() == name) {
-            (*i)->deref();
-            objects.erase(i);
-            return *i;
-        }
+    EGS_Object *o = getObject(name);
+    if (o) {
+        removeObject(o);
+        o->deref();
     }
-    return 0;
+    return o;
 }
 
 void EGS_ObjectFactory::addKnownTypeId(const char *typeid_name) {
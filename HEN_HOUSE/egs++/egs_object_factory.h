@@ -42,6 +42,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <typeinfo>
 using namespace std;
 
@@ -106,9 +107,7 @@ public:
     };
 
     /*! \brief Set the object name to \a Name */
-    void setObjectName(const string &Name) {
-        name = Name;
-    };
+    void setObjectName(const string &Name);
 
     /*! \brief Get the object type */
     const string &getObjectType() const {
@@ -234,14 +233,10 @@ public:
 
       The factory maintains a list of "known" objects and this function
       adds \a o to the list. The list of known object is queried
-      when constructing objects with createSingleObject().
+      when constructing objects with createSingleObject(). If several
+      known objects have the same type, the first one is used.
     */
-    virtual void addKnownObject(EGS_Object *o) {
-        if (o) {
-            o->ref();
-            known_objects.push_back(o);
-        }
-    };
+    virtual void addKnownObject(EGS_Object *o);
 
     /*! \brief Create a single object from the information pointed to
       by \a inp.
@@ -342,6 +337,14 @@ public:
     */
     virtual bool addObject(EGS_Object *o, bool unique = true);
 
+    /*! \brief Update the name index after \a o was renamed from \a oldname.
+
+      This function is called by EGS_Object::setObjectName() and
+      EGS_Object::setName() and there should be no need to call it
+      directly.
+    */
+    void renameObject(EGS_Object *o, const string &oldname);
+
     /*! \brief Add a known typeid to this factory.
 
     */
@@ -360,8 +363,11 @@ public:
 protected:
 
     vector<EGS_Library *> libs;          //!< DSOs loaded so far
+    map<string,EGS_Library *> lib_index; //!< DSOs loaded so far by name
     vector<EGS_Object *>  known_objects; //!< known Objects
+    map<string,EGS_Object *> known_index; //!< Known objects by type
     vector<EGS_Object *>  objects;       //!< Created objects
+    multimap<string,EGS_Object *> index; //!< Created objects by name
     vector<string>        known_typeids; //!< Known typeid's
     string dso_path;                     //!< The path to look for DSOs
 
@@ -0,0 +1,270 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ particle store headers
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+*/
+
+
+/*! \file   egs_particle_store.h
+    \brief  EGS_ParticleStore class for temporary phase-space storage
+*/
+
+#ifndef EGS_PARTICLE_STORE_
+#define EGS_PARTICLE_STORE_
+
+#include "egs_application.h"
+#include "egs_interface2.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/*! \brief A temporary phase-space store for correlated sampling
+
+  \ingroup egspp_main
+
+  Applications that transport the same set of particles through several
+  geometries (e.g. correlated sampling in \c egs_chamber) save the
+  particles crossing a scoring region from the particle stack
+  #the_stack and later put them back onto the stack as the source for
+  the other geometries. This class provides the storage for this.
+
+  The particles are kept in a structure-of-arrays layout that mirrors
+  the particle stack, with all arrays placed in a single memory block.
+  This permits to move a contiguous range of particles between the
+  store and the stack with one \c memcpy per particle property (see
+  save() and restore()). When the store is full, the block is
+  doubled in size; the memory is only released in the destructor, so
+  that after the first few histories clean() and repeated use of the
+  store do not allocate memory. There is no upper limit on the number
+  of particles other than the available memory.
+
+  As the class accesses #the_stack directly, it can only be used in
+  application code, where the \c %array_sizes.h file defining the stack
+  size is available. The nearest distance to a boundary is not stored,
+  the application must set \c dnear after restoring a particle.
+*/
+class EGS_ParticleStore {
+
+public:
+
+    /*! \brief Create an empty store with space for \a size particles */
+    EGS_ParticleStore(int size = 64) : np(0), ntot(0), arena(0) {
+        reserve(size > 0 ? size : 1);
+    };
+
+    ~EGS_ParticleStore() {
+        if (arena) {
+            free(arena);
+        }
+    };
+
+    /*! \brief Save the top particle on the stack */
+    void set() {
+        save(the_stack->np-1,1);
+    };
+
+    /*! \brief Save the particle \a p
+
+    The region index is converted to the stack convention, i.e.
+    <code>p.ir+2</code> is stored.
+    */
+    void set(const EGS_Particle &p) {
+        if (np >= ntot) {
+            reserve(2*ntot);
+        }
+        E[np] = p.E;
+        x[np] = p.x.x;
+        y[np] = p.x.y;
+        z[np] = p.x.z;
+        u[np] = p.u.x;
+        v[np] = p.u.y;
+        w[np] = p.u.z;
+        wt[np] = p.wt;
+        iq[np] = p.q;
+        ir[np] = p.ir + 2;
+        latch[np++] = p.latch;
+    };
+
+    /*! \brief Move the last saved particle to the top of the stack
+
+    The particle is removed from the store and copied to position
+    <code>the_stack->np-1</code>.
+    */
+    void get() {
+        --np;
+        copyToStack(np,the_stack->np-1,1);
+    };
+
+    /*! \brief Save the \a n stack particles starting at index \a first
+
+    The particles are appended to the store in the order in which they
+    are on the stack.
+    */
+    void save(int first, int n) {
+        if (np + n > ntot) {
+            int nnew = 2*ntot;
+            while (np + n > nnew) {
+                nnew *= 2;
+            }
+            reserve(nnew);
+        }
+        memcpy(E+np,the_stack->E+first,n*sizeof(double));
+        memcpy(x+np,the_stack->x+first,n*sizeof(EGS_Float));
+        memcpy(y+np,the_stack->y+first,n*sizeof(EGS_Float));
+        memcpy(z+np,the_stack->z+first,n*sizeof(EGS_Float));
+        memcpy(u+np,the_stack->u+first,n*sizeof(EGS_Float));
+        memcpy(v+np,the_stack->v+first,n*sizeof(EGS_Float));
+        memcpy(w+np,the_stack->w+first,n*sizeof(EGS_Float));
+        memcpy(wt+np,the_stack->wt+first,n*sizeof(EGS_Float));
+        memcpy(iq+np,the_stack->iq+first,n*sizeof(EGS_I32));
+        memcpy(ir+np,the_stack->ir+first,n*sizeof(EGS_I32));
+        memcpy(latch+np,the_stack->latch+first,n*sizeof(EGS_I32));
+        np += n;
+    };
+
+    /*! \brief Move up to \a n particles from the store to the stack
+
+    The last \a n saved particles (or all, if fewer are available) are
+    removed from the store and put on top of the stack, which grows
+    by the same number of particles. The order of the particles on the
+    stack is the order in which they were saved. Returns the number of
+    particles moved. It is the responsibility of the caller to make
+    sure that the stack has enough room.
+    */
+    int restore(int n) {
+        if (n > np) {
+            n = np;
+        }
+        np -= n;
+        copyToStack(np,the_stack->np,n);
+        the_stack->np += n;
+        return n;
+    };
+
+    /*! \brief Remove all particles, keeping the memory */
+    void clean() {
+        np = 0;
+    };
+
+    /*! \brief Set the number of particles in the store to \a n.
+
+    Used to replay previously saved particles: after get() or restore()
+    removed particles, setPointer() with the previous size() makes
+    them available again.
+    */
+    void setPointer(int n) {
+        np = n;
+    };
+
+    /*! \brief The number of particles in the store */
+    int size() const {
+        return np;
+    };
+
+    /*! \brief The number of particles that fit without reallocation */
+    int capacity() const {
+        return ntot;
+    };
+
+    /*! \brief Make room for at least \a n particles */
+    void reserve(int n) {
+        if (n <= ntot) {
+            return;
+        }
+        size_t nf = sizeof(double) + 7*sizeof(EGS_Float) + 3*sizeof(EGS_I32);
+        char *anew = (char *)malloc(n*nf);
+        if (!anew) {
+            egsFatal("EGS_ParticleStore::reserve(): failed to allocate "
+                     "memory for %d particles\n",n);
+        }
+        double    *E1 = (double *)anew;
+        EGS_Float *x1 = (EGS_Float *)(E1 + n);
+        EGS_Float *y1 = x1 + n, *z1 = y1 + n, *u1 = z1 + n, *v1 = u1 + n,
+                   *w1 = v1 + n, *wt1 = w1 + n;
+        EGS_I32   *iq1 = (EGS_I32 *)(wt1 + n);
+        EGS_I32   *ir1 = iq1 + n, *latch1 = ir1 + n;
+        if (np > 0) {
+            memcpy(E1,E,np*sizeof(double));
+            memcpy(x1,x,np*sizeof(EGS_Float));
+            memcpy(y1,y,np*sizeof(EGS_Float));
+            memcpy(z1,z,np*sizeof(EGS_Float));
+            memcpy(u1,u,np*sizeof(EGS_Float));
+            memcpy(v1,v,np*sizeof(EGS_Float));
+            memcpy(w1,w,np*sizeof(EGS_Float));
+            memcpy(wt1,wt,np*sizeof(EGS_Float));
+            memcpy(iq1,iq,np*sizeof(EGS_I32));
+            memcpy(ir1,ir,np*sizeof(EGS_I32));
+            memcpy(latch1,latch,np*sizeof(EGS_I32));
+        }
+        if (arena) {
+            free(arena);
+        }
+        arena = anew;
+        ntot = n;
+        E = E1;
+        x = x1;
+        y = y1;
+        z = z1;
+        u = u1;
+        v = v1;
+        w = w1;
+        wt = wt1;
+        iq = iq1;
+        ir = ir1;
+        latch = latch1;
+    };
+
+protected:
+
+    /*! \brief Copy \a n particles starting at \a i to the stack at \a ip */
+    void copyToStack(int i, int ip, int n) {
+        memcpy(the_stack->E+ip,E+i,n*sizeof(double));
+        memcpy(the_stack->x+ip,x+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->y+ip,y+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->z+ip,z+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->u+ip,u+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->v+ip,v+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->w+ip,w+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->wt+ip,wt+i,n*sizeof(EGS_Float));
+        memcpy(the_stack->iq+ip,iq+i,n*sizeof(EGS_I32));
+        memcpy(the_stack->ir+ip,ir+i,n*sizeof(EGS_I32));
+        memcpy(the_stack->latch+ip,latch+i,n*sizeof(EGS_I32));
+    };
+
+    int       np;       //!< number of particles in the store
+    int       ntot;     //!< number of particles that fit in the arena
+    char      *arena;   //!< the memory block holding all arrays
+    double    *E;       //!< energies
+    EGS_Float *x, *y, *z;   //!< positions
+    EGS_Float *u, *v, *w;   //!< directions
+    EGS_Float *wt;      //!< statistical weights
+    EGS_I32   *iq;      //!< charges
+    EGS_I32   *ir;      //!< stack region indices
+    EGS_I32   *latch;   //!< latch variables
+};
+
+#endif
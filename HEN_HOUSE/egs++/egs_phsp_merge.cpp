@@ -0,0 +1,838 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ phase space merge and conversion tool
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+*/
+
+
+/*! \file egs_phsp_merge.cpp
+ *  \brief A tool to merge, filter and convert phase space files
+ */
+
+#include "egs_compressed_phsp.h"
+#include "egs_functions.h"
+#include "iaea_phsp.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+using namespace std;
+
+/*! \brief A tool to merge, filter and convert phase space files.
+
+  \ingroup egspp_main
+
+  Parallel runs of applications using the \c egs_phsp_scoring ausgab
+  object (or BEAMnrc) produce one phase space file per job. This tool
+  concatenates such files into a single file, optionally filtering
+  the particles and converting between the EGSnrc (MODE0/MODE2), IAEA
+  and compressed (\c .egsphspz) formats. The header of the output file
+  (number of particles and photons, energy range, number of primary
+  histories) is computed while the particles are written, so that
+  only a single pass over the data is needed.
+
+  Usage:
+\verbatim
+egs_phsp_merge [options] -o output_file input_file1 [input_file2 ...]
+
+    -o file           output file (for IAEA format, the name without
+                      the .IAEAheader/.IAEAphsp extension)
+    -f format         output format: egsnrc, iaea or compressed
+                      (default: determined from the output extension)
+    -p type           keep only photons, electrons, positrons or charged
+    --emin e          keep only particles with kinetic energy >= e (MeV)
+    --emax e          keep only particles with kinetic energy <= e (MeV)
+    --latch-any mask  keep only particles with at least one latch bit of mask set
+    --latch-none mask keep only particles with no latch bit of mask set
+    -r list           keep only particles with at least one of the
+                      comma-separated BEAMnrc region bits (1-23) set in latch
+    -z z              store all particles at constant z (IAEA output only)
+    --pos-res r       position resolution (compressed output only)
+    --dir-res r       direction resolution (compressed output only)
+    --ebits n         energy mantissa bits (compressed output only)
+\endverbatim
+
+  Input files are recognized by their content (MODE0, MODE2 or
+  compressed) or by the .IAEAphsp/.IAEAheader extension. EGSnrc output
+  is written in MODE2 if any of the input files is a MODE2 file, with
+  ZLAST set to 0 for particles from the other input files. ZLAST is not
+  stored in compressed or IAEA output, and a warning is printed if MODE2
+  input files are converted to these formats.
+
+  The tool is not part of the default egs++ build because it needs the
+  IAEA phase space library. It is built with <code>make phsp_merge</code>
+  in <code>\$HEN_HOUSE/egs++</code>.
+
+  Each input file is read, filtered and written in chunks of particles,
+  so that EGSnrc files are read with one call per chunk and the memory
+  needed does not depend on the size of the files. When particles marking
+  the start of a new primary history are removed by a filter, the mark
+  is moved to the next accepted particle so that the number of
+  statistically independent histories is preserved.
+*/
+
+#ifndef SKIP_DOXYGEN
+
+static const float rm = 0.5110034;
+
+/* maximum number of IAEA extra floats and longs */
+#define MAXEXTRAS 10
+
+struct PhspParticle {
+    int   q, latch;
+    float E;           // kinetic energy
+    float Etot;        // total energy as read from an EGSnrc file, or 0
+    float x, y, z, u, v, w, wt;
+    float zlast;       // ZLAST from a MODE2 file, or 0
+    bool  is_new;      // first particle of a new primary history
+};
+
+/* The header information of an input file */
+struct PhspHeader {
+    EGS_I64 nparticle, nphoton;
+    double  pinc;
+};
+
+/*********************************************************************
+   Input files
+ *********************************************************************/
+class PhspInput {
+public:
+    virtual ~PhspInput() {};
+    virtual const PhspHeader &header() const {
+        return hd;
+    };
+    virtual bool isValid() const = 0;
+    /* read n particles starting at index first (0-based) into p */
+    virtual bool read(EGS_I64 first, int n, PhspParticle *p) = 0;
+protected:
+    PhspHeader hd;
+};
+
+union __egs_merge_data32 {
+    int   i;
+    float f;
+};
+
+class EGSnrcInput : public PhspInput {
+public:
+    EGSnrcInput(const string &fname) : file_name(fname), recl(0),
+        swap_bytes(false) {
+        hd.nparticle = 0;
+        hd.nphoton = 0;
+        hd.pinc = 0;
+        in.open(fname.c_str(),ios::binary);
+        char mode[5];
+        int n, nphot;
+        float emax, emin, pinc;
+        if (!in.read(mode,5)) {
+            return;
+        }
+        if (!strncmp(mode,"MODE0",5)) {
+            recl = 28;
+        }
+        else if (!strncmp(mode,"MODE2",5)) {
+            recl = 32;
+        }
+        else {
+            return;
+        }
+        in.read((char *) &n,sizeof(int));
+        in.read((char *) &nphot,sizeof(int));
+        in.read((char *) &emax,sizeof(float));
+        in.read((char *) &emin,sizeof(float));
+        in.read((char *) &pinc,sizeof(float));
+        if (!in) {
+            recl = 0;
+            return;
+        }
+        if (n < 0 || nphot < 0 || nphot > n || pinc < 0) {
+            swap_bytes = true;
+            egsSwapBytes(&n);
+            egsSwapBytes(&nphot);
+            egsSwapBytes(&pinc);
+        }
+        hd.nparticle = n;
+        hd.nphoton = nphot;
+        hd.pinc = pinc;
+    };
+    bool isValid() const {
+        return recl > 0;
+    };
+    bool read(EGS_I64 first, int n, PhspParticle *p) {
+        buf.resize(((size_t)n)*recl);
+        in.clear();
+        in.seekg((first+1)*recl,ios::beg);
+        if (!in.read(&buf[0],buf.size())) {
+            return false;
+        }
+        __egs_merge_data32 d[8];
+        d[7].f = 0;
+        for (int j=0; j<n; j++) {
+            memcpy(d,&buf[((size_t)j)*recl],recl);
+            if (swap_bytes) {
+                egsSwapBytes(&d[0].i);
+                for (int k=1; k<recl/4; k++) {
+                    egsSwapBytes(&d[k].f);
+                }
+            }
+            PhspParticle &pj = p[j];
+            pj.latch = d[0].i;
+            pj.q = (pj.latch & (1 << 30)) ? -1 : (pj.latch & (1 << 29)) ? 1 : 0;
+            pj.latch &= ~((1 << 30) | (1 << 29));
+            pj.is_new = d[1].f < 0;
+            pj.Etot = fabs(d[1].f);
+            pj.E = pj.Etot - (pj.q ? rm : 0);
+            pj.x = d[2].f;
+            pj.y = d[3].f;
+            pj.z = 0;
+            pj.u = d[4].f;
+            pj.v = d[5].f;
+            float aux = 1 - pj.u*pj.u - pj.v*pj.v;
+            pj.w = aux > 0 ? sqrt(aux) : 0;
+            pj.wt = d[6].f;
+            if (pj.wt < 0) {
+                pj.w = -pj.w;
+                pj.wt = -pj.wt;
+            }
+            pj.zlast = d[7].f;
+        }
+        return true;
+    };
+protected:
+    string       file_name;
+    ifstream     in;
+    int          recl;
+    bool         swap_bytes;
+    vector<char> buf;
+};
+
+class CompressedInput : public PhspInput {
+public:
+    CompressedInput(const string &fname) : file_name(fname) {
+        valid = reader.open(fname);
+        const EGS_CompressedPhspInfo &info = reader.getInfo();
+        hd.nparticle = valid ? info.nparticle : 0;
+        hd.nphoton = valid ? info.nphoton : 0;
+        hd.pinc = valid ? info.pinc : 0;
+    };
+    bool isValid() const {
+        return valid;
+    };
+    bool read(EGS_I64 first, int n, PhspParticle *p) {
+        EGS_PhspRecord r;
+        for (int j=0; j<n; j++) {
+            if (!reader.getParticle(first+j,r)) {
+                return false;
+            }
+            PhspParticle &pj = p[j];
+            pj.q = (r.latch & (1 << 30)) ? -1 : (r.latch & (1 << 29)) ? 1 : 0;
+            pj.latch = r.latch & ~((1 << 30) | (1 << 29));
+            pj.is_new = r.E < 0;
+            pj.Etot = fabs(r.E);
+            pj.E = pj.Etot - (pj.q ? rm : 0);
+            pj.x = r.x;
+            pj.y = r.y;
+            pj.z = 0;
+            pj.u = r.u;
+            pj.v = r.v;
+            float aux = 1 - pj.u*pj.u - pj.v*pj.v;
+            pj.w = aux > 0 ? sqrt(aux) : 0;
+            pj.wt = r.wt;
+            if (pj.wt < 0) {
+                pj.w = -pj.w;
+                pj.wt = -pj.wt;
+            }
+            pj.zlast = 0;
+        }
+        return true;
+    };
+protected:
+    string                   file_name;
+    EGS_CompressedPhspReader reader;
+    bool                     valid;
+};
+
+class IAEAInput : public PhspInput {
+public:
+    IAEAInput(const string &fname) : id(-1), i_latch(-1), nread(0) {
+        hd.nparticle = 0;
+        hd.nphoton = 0;
+        hd.pinc = 0;
+        int rwmode = 1, iostat, len = fname.size();
+        vector<char> name(fname.begin(),fname.end());
+        name.push_back(0);
+        iaea_new_source(&id,&name[0],&rwmode,&iostat,len);
+        if (iostat < 0) {
+            id = -1;
+            return;
+        }
+        IAEA_I64 n, nphot, pinc;
+        int type = -1;
+        iaea_get_max_particles(&id,&type,&n);
+        type = 1;
+        iaea_get_max_particles(&id,&type,&nphot);
+        iaea_get_total_original_particles(&id,&pinc);
+        int nfloat, nlong;
+        iaea_get_extra_numbers(&id,&nfloat,&nlong);
+        int ltypes[MAXEXTRAS], ftypes[MAXEXTRAS];
+        iaea_get_type_extra_variables(&id,&iostat,ltypes,ftypes);
+        for (int i=0; i<nlong; i++) {
+            if (ltypes[i] == 2) {
+                i_latch = i;
+                break;
+            }
+        }
+        hd.nparticle = n;
+        hd.nphoton = nphot;
+        hd.pinc = pinc;
+    };
+    ~IAEAInput() {
+        if (id >= 0) {
+            int iostat;
+            iaea_destroy_source(&id,&iostat);
+        }
+    };
+    bool isValid() const {
+        return id >= 0;
+    };
+    bool read(EGS_I64 first, int n, PhspParticle *p) {
+        int iostat;
+        if (first != nread) {
+            IAEA_I64 rec = first+1;
+            iaea_set_record(&id,&rec,&iostat);
+            if (iostat < 0) {
+                return false;
+            }
+        }
+        float ef[MAXEXTRAS];
+        int el[MAXEXTRAS];
+        for (int j=0; j<n; j++) {
+            int nstat, type;
+            PhspParticle &pj = p[j];
+            iaea_get_particle(&id,&nstat,&type,&pj.E,&pj.wt,&pj.x,&pj.y,&pj.z,
+                              &pj.u,&pj.v,&pj.w,ef,el);
+            if (nstat < 0) {
+                return false;
+            }
+            pj.is_new = nstat > 0;
+            pj.q = type == 2 ? -1 : type == 3 ? 1 : 0;
+            pj.latch = i_latch >= 0 ? el[i_latch] : 0;
+            pj.Etot = 0;
+            pj.zlast = 0;
+        }
+        nread = first + n;
+        return true;
+    };
+protected:
+    int     id, i_latch;
+    EGS_I64 nread;
+};
+
+/*********************************************************************
+   Output files
+ *********************************************************************/
+class PhspOutput {
+public:
+    PhspOutput() : count(0), countg(0), emax(0), emin(1e30) {};
+    virtual ~PhspOutput() {};
+    virtual bool write(const PhspParticle &p) = 0;
+    virtual bool finish(double pinc) = 0;
+    EGS_I64 count, countg;
+    float   emax, emin;
+protected:
+    void updateCounters(const PhspParticle &p) {
+        ++count;
+        if (!p.q) {
+            ++countg;
+        }
+        else if (p.E < emin) {
+            emin = p.E;
+        }
+        if (p.E > emax) {
+            emax = p.E;
+        }
+    };
+    void toRecord(const PhspParticle &p, EGS_PhspRecord &r) const {
+        r.latch = p.latch & ~((1 << 30) | (1 << 29));
+        if (p.q == -1) {
+            r.latch |= (1 << 30);
+        }
+        else if (p.q == 1) {
+            r.latch |= (1 << 29);
+        }
+        // use the original total energy if available to avoid round-off
+        r.E = p.Etot > 0 ? p.Etot : p.E + (p.q ? rm : 0);
+        if (p.is_new) {
+            r.E = -r.E;
+        }
+        r.x = p.x;
+        r.y = p.y;
+        r.u = p.u;
+        r.v = p.v;
+        r.wt = p.w < 0 ? -p.wt : p.wt;
+    };
+};
+
+class EGSnrcOutput : public PhspOutput {
+public:
+    EGSnrcOutput(const string &fname, bool mode2) : recl(mode2 ? 32 : 28) {
+        out.open(fname.c_str(),ios::binary);
+        out.write(mode2 ? "MODE2" : "MODE0",5);
+        char zero[27];
+        memset(zero,0,27);
+        out.write(zero,recl-5);
+        buf.reserve(recl*4096);
+    };
+    bool isValid() const {
+        return out.good();
+    };
+    bool write(const PhspParticle &p) {
+        EGS_PhspRecord r;
+        toRecord(p,r);
+        const char *c = (const char *) &r;
+        buf.insert(buf.end(),c,c+28);
+        if (recl == 32) {
+            c = (const char *) &p.zlast;
+            buf.insert(buf.end(),c,c+sizeof(float));
+        }
+        updateCounters(p);
+        if (buf.size() >= (size_t)recl*4096) {
+            out.write(&buf[0],buf.size());
+            buf.clear();
+        }
+        return out.good();
+    };
+    bool finish(double pinc) {
+        if (buf.size()) {
+            out.write(&buf[0],buf.size());
+        }
+        if (count > 2147483647) {
+            egsWarning("egs_phsp_merge: %lld particles do not fit into an EGSnrc "
+                       "header, use the compressed or IAEA format\n",count);
+            return false;
+        }
+        int n = count, ng = countg;
+        float emintmp = count == countg ? 0 : emin, pincf = pinc;
+        out.seekp(5,ios::beg);
+        out.write((const char *) &n,sizeof(int));
+        out.write((const char *) &ng,sizeof(int));
+        out.write((const char *) &emax,sizeof(float));
+        out.write((const char *) &emintmp,sizeof(float));
+        out.write((const char *) &pincf,sizeof(float));
+        out.close();
+        return true;
+    };
+protected:
+    ofstream     out;
+    vector<char> buf;
+    int          recl;
+};
+
+class CompressedOutput : public PhspOutput {
+public:
+    CompressedOutput(const string &fname, float pos_res, float dir_res,
+                     int ebits) {
+        valid = writer.open(fname,16384,pos_res,dir_res,ebits);
+    };
+    bool isValid() const {
+        return valid;
+    };
+    bool write(const PhspParticle &p) {
+        EGS_PhspRecord r;
+        toRecord(p,r);
+        updateCounters(p);
+        return writer.write(&r,1);
+    };
+    bool finish(double pinc) {
+        float emintmp = count == countg ? 0 : emin;
+        bool res = writer.flush(countg,emax,emintmp,pinc);
+        writer.close();
+        return res;
+    };
+protected:
+    EGS_CompressedPhspWriter writer;
+    bool valid;
+};
+
+class IAEAOutput : public PhspOutput {
+public:
+    IAEAOutput(const string &fname, bool zconst, float z) : id(-1) {
+        int rwmode = 2, iostat, len = fname.size();
+        vector<char> name(fname.begin(),fname.end());
+        name.push_back(0);
+        iaea_new_source(&id,&name[0],&rwmode,&iostat,len);
+        if (iostat < 0) {
+            id = -1;
+            return;
+        }
+        if (zconst) {
+            int index = 2;
+            iaea_set_constant_variable(&id,&index,&z);
+        }
+        int nfloat = 0, nlong = 1, i_latch = 0, latch_type = 2;
+        iaea_set_extra_numbers(&id,&nfloat,&nlong);
+        iaea_set_type_extralong_variable(&id,&i_latch,&latch_type);
+    };
+    bool isValid() const {
+        return id >= 0;
+    };
+    bool write(const PhspParticle &p) {
+        int nstat = p.is_new ? 1 : 0;
+        int type = p.q == -1 ? 2 : p.q == 1 ? 3 : 1;
+        float ef[1] = {0};
+        int latch = p.latch;
+        iaea_write_particle(&id,&nstat,&type,&p.E,&p.wt,&p.x,&p.y,&p.z,
+                            &p.u,&p.v,&p.w,ef,&latch);
+        updateCounters(p);
+        return nstat >= 0;
+    };
+    bool finish(double pinc) {
+        IAEA_I64 np = (IAEA_I64) pinc;
+        int iostat;
+        iaea_set_total_original_particles(&id,&np);
+        iaea_update_header(&id,&iostat);
+        if (iostat < 0) {
+            return false;
+        }
+        iaea_destroy_source(&id,&iostat);
+        return iostat >= 0;
+    };
+protected:
+    int id;
+};
+
+/*********************************************************************
+   Filtering
+ *********************************************************************/
+struct PhspFilter {
+    int      ptype;       // -1 all, 0 photons, 1 electrons, 2 positrons, 3 charged
+    float    emin, emax;
+    unsigned latch_any, latch_none;
+    bool accept(const PhspParticle &p) const {
+        if (ptype == 0 && p.q) {
+            return false;
+        }
+        if (ptype == 1 && p.q != -1) {
+            return false;
+        }
+        if (ptype == 2 && p.q != 1) {
+            return false;
+        }
+        if (ptype == 3 && !p.q) {
+            return false;
+        }
+        if (p.E < emin || p.E > emax) {
+            return false;
+        }
+        if (latch_any && !(p.latch & latch_any)) {
+            return false;
+        }
+        if (p.latch & latch_none) {
+            return false;
+        }
+        return true;
+    };
+};
+
+/* A chunk of particles read and filtered */
+struct PhspChunk {
+    EGS_I64              first;
+    int                  n;
+    vector<PhspParticle> p;       // the accepted particles
+    bool                 marker;  // new history mark after the last accepted particle
+    bool                 ok;
+};
+
+static void processChunk(PhspInput *in, const PhspFilter *filter,
+                         PhspChunk *chunk) {
+    chunk->p.resize(chunk->n);
+    chunk->ok = chunk->n > 0 ? in->read(chunk->first,chunk->n,&chunk->p[0]) : true;
+    if (!chunk->ok) {
+        return;
+    }
+    int nkeep = 0;
+    bool marker = false;
+    for (int j=0; j<chunk->n; j++) {
+        PhspParticle &pj = chunk->p[j];
+        marker = marker || pj.is_new;
+        if (filter->accept(pj)) {
+            pj.is_new = marker;
+            marker = false;
+            chunk->p[nkeep++] = pj;
+        }
+    }
+    chunk->p.resize(nkeep);
+    chunk->marker = marker;
+}
+
+static bool writeChunk(PhspOutput *out, const PhspChunk &chunk, bool &carry) {
+    for (size_t j=0; j<chunk.p.size(); j++) {
+        PhspParticle p = chunk.p[j];
+        if (j == 0 && carry) {
+            p.is_new = true;
+            carry = false;
+        }
+        if (!out->write(p)) {
+            return false;
+        }
+    }
+    carry = carry || chunk.marker;
+    return true;
+}
+
+static bool endsWith(const string &s, const string &e) {
+    return s.size() >= e.size() && s.compare(s.size()-e.size(),e.size(),e) == 0;
+}
+
+static string stripIAEA(const string &s) {
+    if (endsWith(s,".IAEAphsp")) {
+        return s.substr(0,s.size()-9);
+    }
+    if (endsWith(s,".IAEAheader")) {
+        return s.substr(0,s.size()-11);
+    }
+    return s;
+}
+
+/* Is fname an EGSnrc MODE2 file (i.e. with ZLAST) ? */
+static bool isMode2(const string &fname) {
+    ifstream in(fname.c_str(),ios::binary);
+    char mode[5];
+    return in.read(mode,5) && !strncmp(mode,"MODE2",5);
+}
+
+static void usage(const char *prog) {
+    egsFatal("\nUsage: %s [-f egsnrc|iaea|compressed] "
+             "[-p photons|electrons|positrons|charged] [--emin e] [--emax e]\n"
+             "        [--latch-any mask] [--latch-none mask] [-r region_bits] "
+             "[-z z] [--pos-res r] [--dir-res r] [--ebits n]\n"
+             "        -o output_file input_file1 [input_file2 ...]\n\n",prog);
+}
+
+#endif
+
+int main(int argc, char **argv) {
+
+    string ofile, oformat;
+    vector<string> ifiles;
+    PhspFilter filter;
+    filter.ptype = -1;
+    filter.emin = -1e30;
+    filter.emax = 1e30;
+    filter.latch_any = 0;
+    filter.latch_none = 0;
+    bool zconst = false;
+    float z = 0, pos_res = 1e-4, dir_res = 9.5367431640625e-7;
+    int ebits = 16;
+
+    for (int i=1; i<argc; i++) {
+        string a = argv[i];
+        bool has_arg = i+1 < argc;
+        if ((a == "-o" || a == "--output") && has_arg) {
+            ofile = argv[++i];
+        }
+        else if ((a == "-f" || a == "--format") && has_arg) {
+            oformat = argv[++i];
+        }
+        else if ((a == "-p" || a == "--particle-type") && has_arg) {
+            string t = argv[++i];
+            if (t == "photons") {
+                filter.ptype = 0;
+            }
+            else if (t == "electrons") {
+                filter.ptype = 1;
+            }
+            else if (t == "positrons") {
+                filter.ptype = 2;
+            }
+            else if (t == "charged") {
+                filter.ptype = 3;
+            }
+            else if (t != "all") {
+                usage(argv[0]);
+            }
+        }
+        else if (a == "--emin" && has_arg) {
+            filter.emin = atof(argv[++i]);
+        }
+        else if (a == "--emax" && has_arg) {
+            filter.emax = atof(argv[++i]);
+        }
+        else if (a == "--latch-any" && has_arg) {
+            filter.latch_any |= strtoul(argv[++i],0,0);
+        }
+        else if (a == "--latch-none" && has_arg) {
+            filter.latch_none |= strtoul(argv[++i],0,0);
+        }
+        else if ((a == "-r" || a == "--regions") && has_arg) {
+            // BEAMnrc region bits 1-23 of latch
+            char *s = argv[++i];
+            while (*s) {
+                int bit = strtol(s,&s,10);
+                if (bit < 1 || bit > 23) {
+                    egsFatal("%s: region bits must be between 1 and 23\n",argv[0]);
+                }
+                filter.latch_any |= (1U << bit);
+                while (*s == ',' || *s == ' ') {
+                    ++s;
+                }
+            }
+        }
+        else if (a == "-z" && has_arg) {
+            zconst = true;
+            z = atof(argv[++i]);
+        }
+        else if (a == "--pos-res" && has_arg) {
+            pos_res = atof(argv[++i]);
+        }
+        else if (a == "--dir-res" && has_arg) {
+            dir_res = atof(argv[++i]);
+        }
+        else if (a == "--ebits" && has_arg) {
+            ebits = atoi(argv[++i]);
+        }
+        else if (a[0] == '-') {
+            usage(argv[0]);
+        }
+        else {
+            ifiles.push_back(a);
+        }
+    }
+    if (ofile.empty() || ifiles.empty()) {
+        usage(argv[0]);
+    }
+    if (oformat.empty()) {
+        if (endsWith(ofile,".egsphspz")) {
+            oformat = "compressed";
+        }
+        else if (endsWith(ofile,".IAEAphsp") || endsWith(ofile,".IAEAheader")) {
+            oformat = "iaea";
+        }
+        else {
+            oformat = "egsnrc";
+        }
+    }
+
+    bool mode2 = false;
+    for (size_t ifile=0; ifile<ifiles.size(); ifile++) {
+        if (isMode2(ifiles[ifile])) {
+            mode2 = true;
+            break;
+        }
+    }
+    if (mode2 && oformat != "egsnrc") {
+        egsWarning("%s: ZLAST of MODE2 input files is not stored in %s "
+                   "output\n",argv[0],oformat.c_str());
+    }
+
+    PhspOutput *out = 0;
+    if (oformat == "egsnrc") {
+        EGSnrcOutput *o = new EGSnrcOutput(ofile,mode2);
+        if (o->isValid()) {
+            out = o;
+        }
+    }
+    else if (oformat == "compressed") {
+        CompressedOutput *o = new CompressedOutput(ofile,pos_res,dir_res,ebits);
+        if (o->isValid()) {
+            out = o;
+        }
+    }
+    else if (oformat == "iaea") {
+        IAEAOutput *o = new IAEAOutput(stripIAEA(ofile),zconst,z);
+        if (o->isValid()) {
+            out = o;
+        }
+    }
+    else {
+        usage(argv[0]);
+    }
+    if (!out) {
+        egsFatal("%s: failed to open output file %s\n",argv[0],ofile.c_str());
+    }
+
+    const int chunk_size = 65536;
+    double pinc = 0;
+    EGS_I64 nread = 0;
+    bool carry = false;
+    for (size_t ifile=0; ifile<ifiles.size(); ifile++) {
+        const string &fname = ifiles[ifile];
+        PhspInput *in = 0;
+        if (endsWith(fname,".IAEAphsp") || endsWith(fname,".IAEAheader")) {
+            in = new IAEAInput(stripIAEA(fname));
+        }
+        else if (EGS_CompressedPhspReader::isCompressedPhsp(fname)) {
+            in = new CompressedInput(fname);
+        }
+        else {
+            in = new EGSnrcInput(fname);
+        }
+        if (!in->isValid()) {
+            egsFatal("%s: failed to open %s\n",argv[0],fname.c_str());
+        }
+        const PhspHeader &hd = in->header();
+        pinc += hd.pinc;
+        nread += hd.nparticle;
+        egsInformation("%s: %lld particles, %g primary histories\n",
+                       fname.c_str(),hd.nparticle,hd.pinc);
+
+        PhspChunk chunk;
+        for (EGS_I64 first=0; first<hd.nparticle; first+=chunk_size) {
+            chunk.first = first;
+            chunk.n = hd.nparticle - first < chunk_size ?
+                      (int)(hd.nparticle - first) : chunk_size;
+            processChunk(in,&filter,&chunk);
+            if (!chunk.ok) {
+                egsFatal("%s: I/O error while reading %s\n",argv[0],
+                         fname.c_str());
+            }
+            if (!writeChunk(out,chunk,carry)) {
+                egsFatal("%s: I/O error while writing %s\n",argv[0],
+                         ofile.c_str());
+            }
+        }
+        delete in;
+    }
+
+    if (!out->finish(pinc)) {
+        egsFatal("%s: failed to finalize %s\n",argv[0],ofile.c_str());
+    }
+    egsInformation("\nRead %lld particles from %d file(s)\n",nread,
+                   (int)ifiles.size());
+    egsInformation("Wrote %lld particles (%lld photons) to %s\n",out->count,
+                   out->countg,ofile.c_str());
+    egsInformation("  max. k.e. = %g MeV, min. k.e. of charged particles = %g MeV\n",
+                   out->emax,out->count == out->countg ? 0 : out->emin);
+    egsInformation("  primary histories = %g\n",pinc);
+    delete out;
+    return 0;
+}
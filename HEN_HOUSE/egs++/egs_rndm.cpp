@@ -43,6 +43,7 @@
 
 #include <iostream>
 #include <string>
+#include <limits>
 using namespace std;
 
 void EGS_RandomGenerator::allocate(int n) {
@@ -50,27 +51,56 @@ void EGS_RandomGenerator::allocate(int n) {
         egsFatal("Attempt to construct a RNG with n < 1\n");
     }
     rarray = new EGS_Float[n];
+    own_array = true;
+    ip = &own_ip;
     np = n;
-    ip = np;
+    *ip = np;
 }
 
 void EGS_RandomGenerator::copyBaseState(const EGS_RandomGenerator &r) {
     if (np > 0 && np != r.np) {
-        delete [] rarray;
+        if (own_array) {
+            delete [] rarray;
+        }
         np = 0;
     }
     if (np <= 0) {
         allocate(r.np);
     }
-    ip = r.ip;
+    *ip = *r.ip;
     have_x = r.have_x;
     the_x = r.the_x;
     count = r.count;
-    for (int j=ip; j<np; j++) {
+    for (int j=*ip; j<np; j++) {
         rarray[j] = r.rarray[j];
     }
 }
 
+void EGS_RandomGenerator::setExternalArray(int n, EGS_Float *array,
+        EGS_I32 *index) {
+    if (n < 1) {
+        egsFatal("EGS_RandomGenerator::setExternalArray: n < 1\n");
+    }
+    if (n == np) {
+        for (int j=*ip; j<np; j++) {
+            array[j] = rarray[j];
+        }
+        *index = *ip;
+    }
+    else {
+        // the unused numbers are dropped if the array size changes
+        count -= np - *ip;
+        *index = n;
+    }
+    if (own_array) {
+        delete [] rarray;
+    }
+    rarray = array;
+    np = n;
+    ip = index;
+    own_array = false;
+}
+
 EGS_RandomGenerator::EGS_RandomGenerator(int n) : count(0), np(0) {
     allocate(n);
     have_x = false;
@@ -83,11 +113,14 @@ bool EGS_RandomGenerator::storeState(ostream &data) {
     if (!egsStoreI64(data,count)) {
         return false;
     }
-    data << " " << np << "  " << ip << endl;
+    data << " " << np << "  " << *ip << endl;
+    // enough digits to restore the numbers exactly
+    streamsize prec = data.precision(numeric_limits<EGS_Float>::digits10+3);
     for (int j=0; j<np; j++) {
         data << rarray[j] << " ";
     }
     data << endl;
+    data.precision(prec);
     if (!data.good()) {
         return false;
     }
@@ -98,8 +131,8 @@ bool EGS_RandomGenerator::setState(istream &data) {
     if (!egsGetI64(data,count)) {
         return false;
     }
-    int np1;
-    data >> np1 >> ip;
+    int np1, ip1;
+    data >> np1 >> ip1;
     if (!data.good() || data.fail() || data.eof()) {
         return false;
     }
@@ -107,10 +140,15 @@ bool EGS_RandomGenerator::setState(istream &data) {
         return false;
     }
     if (np1 != np && np > 0) {
-        delete [] rarray;
-        rarray = new EGS_Float [np1];
+        if (own_array) {
+            delete [] rarray;
+        }
+        np = 0;
+    }
+    if (np <= 0) {
+        allocate(np1);
     }
-    np = np1;
+    *ip = ip1;
     for (int j=0; j<np; j++) {
         data >> rarray[j];
     }
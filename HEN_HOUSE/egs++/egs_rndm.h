@@ -82,7 +82,8 @@ public:
      * Being able to save the state of a RNG is useful in advanced applications
      * such as correlated sampling.
      */
-    EGS_RandomGenerator(const EGS_RandomGenerator &r) : np(0) {
+    EGS_RandomGenerator(const EGS_RandomGenerator &r) : np(0),
+        ip(&own_ip), own_array(true) {
         copyBaseState(r);
     };
 
@@ -91,7 +92,9 @@ public:
      * Deallocates the memory pointed to by #rarray.
      */
     virtual ~EGS_RandomGenerator() {
-        delete [] rarray;
+        if (own_array) {
+            delete [] rarray;
+        }
     };
 
     /*! \brief Returns a random number uniformly distributed between
@@ -101,11 +104,11 @@ public:
      * if the pointer #ip points beyond the last element of #rarray.
      */
     inline EGS_Float getUniform() {
-        if (ip >= np) {
+        if (*ip >= np) {
             fillArray(np,rarray);
-            ip = 0;
+            *ip = 0;
         }
-        return rarray[ip++];
+        return rarray[(*ip)++];
     };
 
     /*! \brief Returns the number of random numbers generated so far.
@@ -123,9 +126,24 @@ public:
      * numbers in the array #rarray may not have been used yet.
      */
     EGS_I64 numbersUsed() const {
-        return ip<np ? count - np + ip : count;
+        return *ip<np ? count - np + *ip : count;
     };
 
+    /*! \brief Use external memory for the random number array.
+     *
+     * After this call the generator uses the \a n elements of \a array
+     * as #rarray and \a index as the pointer to the next element. The
+     * random numbers not used so far are transferred to \a array, so that
+     * the sequence of random numbers is not changed if \a n is the same
+     * as the current array size. The external memory must remain valid
+     * for the lifetime of the generator.
+     *
+     * This is used by EGS_AdvancedApplication to share the array with the
+     * mortran back-end, so that the EGSnrc transport and the egspp
+     * objects draw their random numbers from a single sequence.
+     */
+    void setExternalArray(int n, EGS_Float *array, EGS_I32 *index);
+
     /*! \brief Sets \a cphi and \a sphi to the cosine and sine of a random
      * angle uniformely distributed between 0 and \f$2 \pi \f$.
      *
@@ -259,8 +277,10 @@ protected:
 
     EGS_I64   count;  //!< random number generated so far
     int       np;     //!< size of the array rarray
-    int       ip;     //!< pointer to the next rarray element in the sequence
+    EGS_I32   *ip;    //!< pointer to the next rarray element in the sequence
     EGS_Float *rarray;//!< array with random numbers of size np.
+    EGS_I32   own_ip; //!< storage of *ip, unless set by setExternalArray()
+    bool   own_array; //!< is rarray allocated by this generator?
 
     /*! \brief Store the state of the RNG to the output stream \a data.
      *
@@ -134,6 +134,12 @@ public:
         return nbatch;
     };
 
+    /*! \brief Returns the calculation type (0 for a fresh calculation,
+      1 for a restart, 2 for analyze and 3 for combine) */
+    int     getRestart() const {
+        return restart;
+    };
+
     /*! \brief Returns the number of simulation chunks */
     int     getNchunk() const {
         return nchunk;
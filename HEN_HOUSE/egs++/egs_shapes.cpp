@@ -204,3 +204,117 @@ EGS_Object *EGS_CylinderShape::createObject(EGS_Input *input) {
     return result;
 }
 
+
+/****************************************************************************
+ *
+ *                    solid angle sampling helpers
+ *
+ ****************************************************************************/
+
+static inline EGS_Float clampToUnit(EGS_Float c) {
+    return c < -1 ? -1 : (c > 1 ? 1 : c);
+}
+
+EGS_Float EGS_SphericalRectangle::setUp(const EGS_Vector &xo,
+                                        EGS_Float xmin, EGS_Float xmax, EGS_Float ymin, EGS_Float ymax) {
+    x0 = xmin - xo.x;
+    x1 = xmax - xo.x;
+    y0 = ymin - xo.y;
+    y1 = ymax - xo.y;
+    // work in a frame where the rectangle is below the point
+    zdir = xo.z > 0 ? 1 : -1;
+    z0 = -fabs(xo.z);
+    S = 0;
+    if (z0 > -1e-15 || x1 <= x0 || y1 <= y0) {
+        return S;
+    }
+    EGS_Vector v00(x0,y0,z0), v01(x0,y1,z0), v10(x1,y0,z0), v11(x1,y1,z0);
+    EGS_Vector n0 = v00%v10, n1 = v10%v11, n2 = v11%v01, n3 = v01%v00;
+    n0.normalize();
+    n1.normalize();
+    n2.normalize();
+    n3.normalize();
+    EGS_Float g0 = acos(clampToUnit(-(n0*n1))),
+              g1 = acos(clampToUnit(-(n1*n2))),
+              g2 = acos(clampToUnit(-(n2*n3))),
+              g3 = acos(clampToUnit(-(n3*n0)));
+    b0 = n0.z;
+    b1 = n2.z;
+    k = 2*M_PI - g2 - g3;
+    S = g0 + g1 - k;
+    if (S < 0) {
+        S = 0;
+    }
+    return S;
+}
+
+EGS_Vector EGS_SphericalRectangle::sample(EGS_RandomGenerator *rndm) const {
+    EGS_Float au = rndm->getUniform()*S + k;
+    EGS_Float fu = (cos(au)*b0 - b1)/sin(au);
+    EGS_Float cu = 1/sqrt(fu*fu + b0*b0);
+    if (fu < 0) {
+        cu = -cu;
+    }
+    cu = clampToUnit(cu);
+    EGS_Float su = sqrt(1 - cu*cu);
+    EGS_Float xu = su > 0 ? -cu*z0/su : (cu > 0 ? x1 : x0);
+    xu = max(x0,min(x1,xu));
+    EGS_Float d2 = xu*xu + z0*z0, d = sqrt(d2);
+    EGS_Float h0 = y0/sqrt(d2 + y0*y0), h1 = y1/sqrt(d2 + y1*y1);
+    EGS_Float hv = h0 + rndm->getUniform()*(h1 - h0), hv2 = hv*hv;
+    EGS_Float yv = hv2 < 1 ? hv*d/sqrt(1 - hv2) : y1;
+    yv = max(y0,min(y1,yv));
+    EGS_Vector u(xu,yv,z0*zdir);
+    u.normalize();
+    return u;
+}
+
+EGS_Float EGS_SphericalTriangle::setUp(const EGS_Vector &a,
+                                       const EGS_Vector &b, const EGS_Vector &c) {
+    A = a;
+    B = b;
+    C = c;
+    S = 0;
+    EGS_Float la = A.length(), lb = B.length(), lc = C.length();
+    if (la <= 0 || lb <= 0 || lc <= 0) {
+        return S;
+    }
+    A *= (1/la);
+    B *= (1/lb);
+    C *= (1/lc);
+    // Van Oosterom & Strackee formula for the solid angle
+    EGS_Float num = fabs(A*(B%C));
+    if (num < 1e-15) {
+        return S;
+    }
+    S = 2*atan2(num,1 + A*B + B*C + C*A);
+    // the angle at vertex A
+    cosc = A*B;
+    EGS_Vector tB = B - A*cosc;
+    eAC = C - A*(A*C);
+    tB.normalize();
+    eAC.normalize();
+    cosa = clampToUnit(tB*eAC);
+    alpha = acos(cosa);
+    sina = sin(alpha);
+    return S;
+}
+
+EGS_Vector EGS_SphericalTriangle::sample(EGS_RandomGenerator *rndm) const {
+    EGS_Float Ahat = rndm->getUniform()*S;
+    EGS_Float s = sin(Ahat - alpha), t = cos(Ahat - alpha);
+    EGS_Float u = t - cosa, v = s + sina*cosc;
+    EGS_Float q = ((v*t - u*s)*cosa - v)/((v*s + u*t)*sina);
+    q = clampToUnit(q);
+    EGS_Vector Chat = A*q + eAC*sqrt(1 - q*q);
+    EGS_Float cb = Chat*B;
+    EGS_Float z = 1 - rndm->getUniform()*(1 - cb);
+    EGS_Vector w = Chat - B*cb;
+    EGS_Float lw = w.length();
+    if (lw <= 0) {
+        return B;
+    }
+    w *= (1/lw);
+    EGS_Vector res = B*z + w*sqrt(z < 1 ? 1 - z*z : 0);
+    return res;
+}
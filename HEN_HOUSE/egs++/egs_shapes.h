@@ -233,6 +233,33 @@ public:
         return 1;
     };
 
+    /*! Does this shape implement the getSolidAngleDirection() method?
+     *
+     * This virtual function should be re-implemented in derived classes
+     * if the shape supports the getSolidAngleDirection() method.
+     */
+    virtual bool supportsSolidAngleMethod() const {
+        return false;
+    };
+
+    /*! Get a random direction within the solid angle subtended by the shape.
+     *
+     * This method is an alternative to getPointSourceDirection(). Instead of
+     * picking a point on the surface and weighting the resulting direction
+     * with \f$A \cos\theta/d^2\f$, the direction \a u is sampled uniformly
+     * within the solid angle \f$\Omega\f$ subtended by the shape as seen
+     * from \a xo and \a wt is set to \f$\Omega\f$. The expectation value of
+     * the weight is the same as for getPointSourceDirection() but the weight
+     * no longer fluctuates from particle to particle. Shapes for which exact
+     * solid angle sampling is not available may sample a larger solid angle
+     * and set \a wt to zero for directions missing the shape.
+     */
+    virtual void getSolidAngleDirection(const EGS_Vector &xo,
+                                        EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt) {
+        egsFatal("getSolidAngleDirection: you have to implement this "
+                 "method for the %s shape if you want to use it\n",otype.c_str());
+    };
+
 protected:
 
     EGS_AffineTransform *T; //!< The affine transformation attached to the shape
@@ -296,6 +323,81 @@ protected:
 
 };
 
+/*! \brief Uniform sampling of directions within a spherical rectangle.
+ *
+ * \ingroup SurfaceS
+ * \ingroup egspp_main
+ *
+ * Given a point \f$\vec{x}_0\f$ and the rectangle
+ * \f$x_{\rm min} \le x \le x_{\rm max}\f$,
+ * \f$y_{\rm min} \le y \le y_{\rm max}\f$ in the xy-plane at z=0,
+ * setUp() computes the solid angle subtended by the rectangle and
+ * sample() returns directions uniformly distributed within this solid
+ * angle using the algorithm of Ure&ntilde;a, Fajardo and King,
+ * Comput. Graph. Forum 32 (2013) 59.
+ */
+class EGS_EXPORT EGS_SphericalRectangle {
+
+public:
+
+    EGS_SphericalRectangle() : S(0) {};
+
+    /*! \brief Set up for the rectangle seen from \a xo and return its
+     * solid angle.
+     */
+    EGS_Float setUp(const EGS_Vector &xo, EGS_Float xmin, EGS_Float xmax,
+                    EGS_Float ymin, EGS_Float ymax);
+
+    /*! \brief The solid angle computed in the last call to setUp() */
+    EGS_Float solidAngle() const {
+        return S;
+    };
+
+    /*! \brief Sample a unit direction within the rectangle */
+    EGS_Vector sample(EGS_RandomGenerator *rndm) const;
+
+protected:
+
+    EGS_Float x0, y0, x1, y1, z0, zdir, b0, b1, k, S;
+};
+
+/*! \brief Uniform sampling of directions within a spherical triangle.
+ *
+ * \ingroup SurfaceS
+ * \ingroup egspp_main
+ *
+ * setUp() takes the three vertices of a triangle relative to the
+ * point from which it is seen and computes the solid angle subtended
+ * by the triangle, sample() returns directions uniformly distributed
+ * within this solid angle using the algorithm of Arvo,
+ * Proc. SIGGRAPH 95 (1995) 437.
+ */
+class EGS_EXPORT EGS_SphericalTriangle {
+
+public:
+
+    EGS_SphericalTriangle() : S(0) {};
+
+    /*! \brief Set up for the triangle with vertices \a a, \a b and \a c
+     * and return its solid angle.
+     */
+    EGS_Float setUp(const EGS_Vector &a, const EGS_Vector &b,
+                    const EGS_Vector &c);
+
+    /*! \brief The solid angle computed in the last call to setUp() */
+    EGS_Float solidAngle() const {
+        return S;
+    };
+
+    /*! \brief Sample a unit direction within the triangle */
+    EGS_Vector sample(EGS_RandomGenerator *rndm) const;
+
+protected:
+
+    EGS_Vector A, B, C, eAC;
+    EGS_Float  alpha, sina, cosa, cosc, S;
+};
+
 /*! \brief A point shape. This is the simplest shape possible: it simply always
   returns the same point.
 
@@ -482,6 +482,20 @@ public:
                            (*beta)->getAtomicWeight(), (*beta)->getForbidden()
                           );
 
+            emax = (*beta)->getFinalEnergy();
+
+            // Reuse the tabulated spectrum if it was restored from the
+            // decay data cache
+            if ((*beta)->getSpectrumEnergies().size()) {
+                const vector<EGS_Float> &e = (*beta)->getSpectrumEnergies();
+                const vector<EGS_Float> &spec = (*beta)->getSpectrumValues();
+                (*beta)->setSpectrum(new EGS_AliasTable(e.size(),&e[0],&spec[0],1));
+                if (outputBetaSpectra == "yes") {
+                    outputSpectrum(decays->radionuclide,e,spec);
+                }
+                continue;
+            }
+
             const int nbin=1000;
             EGS_Float *e = new EGS_Float [nbin];
             EGS_Float *spec = new EGS_Float [nbin];
@@ -575,28 +589,38 @@ public:
 
             EGS_AliasTable *bspec = new EGS_AliasTable(nbin,e,spec,1);
             (*beta)->setSpectrum(bspec);
+            (*beta)->setSpectrumTable(vector<EGS_Float>(e,e+nbin),
+                                      vector<EGS_Float>(spec,spec+nbin));
 
             // Write the spectrum to a file
             if (outputBetaSpectra == "yes") {
-
-                ostringstream ostr;
-                ostr << decays->radionuclide << "_" << emax << ".spec";
-
-                egsInformation("EGS_RadionuclideBetaSpectrum: Outputting beta spectrum to file: %s\n", ostr.str().c_str());
-
-                ofstream specStream;
-                specStream.open(ostr.str().c_str());
-                for (int ib=0; ib<nbin; ib++) {
-                    spec[ib]=1/de*(spec_y[ib]/s_y);
-                    specStream << e[ib] << " " << spec[ib] << endl;
-                }
-                specStream.close();
+                outputSpectrum(decays->radionuclide,
+                               (*beta)->getSpectrumEnergies(), (*beta)->getSpectrumValues());
             }
+
+            delete [] e;
+            delete [] spec;
+            delete [] spec_y;
         }
     }
 
 protected:
 
+    void outputSpectrum(const string &radionuclide, const vector<EGS_Float> &e,
+                        const vector<EGS_Float> &spec) {
+        ostringstream ostr;
+        ostr << radionuclide << "_" << emax << ".spec";
+
+        egsInformation("EGS_RadionuclideBetaSpectrum: Outputting beta spectrum to file: %s\n", ostr.str().c_str());
+
+        ofstream specStream;
+        specStream.open(ostr.str().c_str());
+        for (unsigned int ib=0; ib<e.size(); ib++) {
+            specStream << e[ib] << " " << spec[ib] << endl;
+        }
+        specStream.close();
+    }
+
     complex<double> cgamma(complex<double> z) {
 
         static const int g=7;
@@ -952,6 +976,14 @@ It is defined using the following input
                             spectrum will produce emission rates to match both
                             the decay intensities and the internal transition
                             intensities from the ensdf file.
+    ensdf cache         = [optional, default=no] yes or no
+                            If yes, the processed decay data and tabulated
+                            beta spectra are stored in a binary file
+                            {ensdf file}.egsensdf next to the ensdf file and
+                            reused in later runs, skipping the parsing and
+                            the beta spectrum calculation. The cache is
+                            rebuilt if the ensdf file or the options above
+                            change.
 :stop spectrum:
 :start spectrum:
     type                = radionuclide
@@ -1001,6 +1033,12 @@ disintegration and the same time of emission as the most recent disintegration
 or internal transition, whichever was last. Relaxations may result in local
 energy depositions - this can be obtained using <b> \c getEdep() </b>.
 
+After the intensities are normalized, the decay scheme is flattened into
+contiguous arrays: one alias table selects the decay channel and one alias
+table per excited daughter level selects the transition away from it, so
+that the cost of sampling an emission does not depend on the number of
+records in the ensdf file.
+
 The <b>\c printSampledEmissions()</b> function is provided for evaluating
 how the decay emissions actually end up sampled by the source.
 The function prints the signature energy and emission intensity of each
@@ -1022,7 +1060,7 @@ public:
     /*! \brief Construct a radionuclide spectrum.
      */
     EGS_RadionuclideSpectrum(const string nuclide, const string ensdf_file,
-                             const EGS_Float relativeActivity, const string relaxType, const string outputBetaSpectra, const bool scoreAlphasLocally, const bool allowMultiTransition) :
+                             const EGS_Float relativeActivity, const string relaxType, const string outputBetaSpectra, const bool scoreAlphasLocally, const bool allowMultiTransition, const bool useCache=false) :
         EGS_BaseSpectrum() {
 
         // For now, hard-code verbose mode
@@ -1033,7 +1071,7 @@ public:
 
         // Read in the data file for the nuclide
         // and build the decay structure
-        decays = new EGS_Ensdf(nuclide, ensdf_file, relaxType, allowMultiTransition, verbose);
+        decays = new EGS_Ensdf(nuclide, ensdf_file, relaxType, allowMultiTransition, verbose, useCache);
 
         // Normalize the emission and transition intensities
         decays->normalizeIntensities();
@@ -1041,6 +1079,16 @@ public:
         // Get the beta energy spectra
         betaSpectra = new EGS_RadionuclideBetaSpectrum(decays, outputBetaSpectra);
 
+        // Store the decay data and beta spectra for the next run
+        if (useCache && !decays->isCached()) {
+            if (decays->writeCache()) {
+                egsInformation("EGS_RadionuclideSpectrum: Stored decay data in %s.egsensdf\n", ensdf_file.c_str());
+            }
+            else {
+                egsWarning("EGS_RadionuclideSpectrum: Failed to write the decay data cache %s.egsensdf\n", ensdf_file.c_str());
+            }
+        }
+
         // Get the particle records from the decay scheme
         myBetas = decays->getBetaRecords();
         myAlphas = decays->getAlphaRecords();
@@ -1054,7 +1102,6 @@ public:
         augerEnergies = decays->getAugerEnergies();
 
         // Initialization
-        currentLevel = 0;
         Emax = 0;
         currentTime = 0;
         ishower = -1; // Start with ishower -1 so first shower has index 0
@@ -1118,6 +1165,12 @@ public:
 
         // Set the application
         app = EGS_Application::activeApplication();
+
+        // Flatten the decay scheme for sampling
+        eadlRelax = relaxationType == "eadl";
+        currentLevel = -1;
+        channelTable = 0;
+        buildDecayGraph();
     };
 
     /*! \brief Destructor. */
@@ -1128,6 +1181,14 @@ public:
         if (betaSpectra) {
             delete betaSpectra;
         }
+        for (unsigned int i=0; i<levels.size(); ++i) {
+            if (levels[i].table) {
+                delete levels[i].table;
+            }
+        }
+        if (channelTable) {
+            delete channelTable;
+        }
     };
 
     /*! \brief Returns the maximum energy that may be emitted.
@@ -1285,7 +1346,8 @@ public:
     }
 
     void resetCounter() {
-        currentLevel = 0;
+        currentLevel = -1;
+        multiTransitions.clear();
         currentTime = 0;
         ishower = -1;
         totalGammaEnergy = 0;
@@ -1318,115 +1380,37 @@ protected:
             return E;
         }
 
-        // Sample a uniform random number
-        EGS_Float u = rndm->getUniform();
-
         // If the daughter is in an excited state
         // check for transitions
-        if (currentLevel && currentLevel->levelCanDecay() && currentLevel->getEnergy() > epsilon) {
-
-            for (vector<GammaRecord *>::iterator gamma = myGammas.begin();
-                    gamma != myGammas.end(); gamma++) {
-
-                if ((*gamma)->getLevelRecord() == currentLevel) {
-
-                    if (u < (*gamma)->getTransitionIntensity()) {
-
-                        // A gamma transition may either be a gamma emission
-                        // or an internal conversion electron
-                        EGS_Float u2 = 0;
-                        if ((*gamma)->getGammaIntensity() < 1) {
-                            u2 = rndm->getUniform();
-                        }
-
-                        // Sample how long
-                        // it took for this transition to occur
-                        // time = -halflife / ln(2) * log(1-u)
-                        double hl = currentLevel->getHalfLife();
-                        if (hl > 0) {
-                            currentTime = -hl * log(1.-rndm->getUniform()) /
-                                          0.693147180559945309417232121458176568075500134360255254120680009493393;
-                        }
-
-                        // Determine whether multiple gamma transitions occur
-                        if (rndm->getUniform() < (*gamma)->getMultiTransitionProb()) {
-                            multiTransitions.push_back(currentLevel);
-                        }
-
-                        // Update the level of the daughter
-                        currentLevel = (*gamma)->getFinalLevel();
-
-                        // If a gamma emission occurs
-                        if (u2 < (*gamma)->getGammaIntensity()) {
-
-                            (*gamma)->incrGammaSampled();
-
-                            currentQ = (*gamma)->getCharge();
-
-                            E = (*gamma)->getDecayEnergy();
+        if (currentLevel >= 0) {
 
-                            totalGammaEnergy += E;
+            const EGS_DecayLevel &level = levels[currentLevel];
+            int k = level.table->sample(rndm);
 
-                            emissionType = 2;
-
-                            return E;
-
-                        }
-                        else if (u2 < (*gamma)->getICIntensity()) {
-                            (*gamma)->incrICSampled();
-                            currentQ = -1;
-                            emissionType = 3;
-
-                            if ((*gamma)->icIntensity.size()) {
-
-                                // Determine which shell the conversion electron
-                                // comes from. This will create a shell vacancy
-                                EGS_Float u3 = rndm->getUniform();
-
-                                for (unsigned int i=0; i<(*gamma)->icIntensity.size(); ++i) {
-                                    if (u3 < (*gamma)->icIntensity[i]) {
-
-                                        E = (*gamma)->getDecayEnergy() - (*gamma)->getBindingEnergy(i);
-
-                                        //                                     egsInformation("test %d %f %f %f\n",i,(*gamma)->getDecayEnergy(),decays->getRelaxations()->getBindingEnergy(decays->Z,i),E);
-
-                                        // Add relaxation particles to the source stack
-                                        if (relaxationType == "eadl") {
-
-                                            // Generate relaxation particles for a
-                                            // shell vacancy i
-                                            (*gamma)->relax(i,app->getEcut()-app->getRM(),app->getPcut(),rndm,edep,relaxParticles);
-                                        }
-
-                                        // Return the conversion electron
-                                        return E;
-                                    }
-                                }
-                            }
-                            return 0;
-                        }
-                        else {
-                            (*gamma)->incrIPSampled();
-                            emissionType = 13;
-
-                            // Internal pair production results in a positron
-                            // and electron pair
+            // There are cases where a transition is not guaranteed
+            if (k >= level.n) {
+                currentLevel = -1;
+                return 0;
+            }
+            const EGS_DecayTransition &t = transitions[level.first+k];
 
-                            //TODO: This is left for future work, we need to
-                            // determine the energies of the electron/positron
-                            // pair (sample uniformly?) and then determine the
-                            // corresponding directions. It might be best to do
-                            // this in the source instead of the spectrum.
+            // Sample how long
+            // it took for this transition to occur
+            // time = -halflife / ln(2) * log(1-u)
+            if (level.halfLife > 0) {
+                currentTime = -level.halfLife * log(1.-rndm->getUniform()) /
+                              0.693147180559945309417232121458176568075500134360255254120680009493393;
+            }
 
-                            currentQ = 1;
-                            return 0;
-                        }
-                    }
-                }
+            // Determine whether multiple gamma transitions occur
+            if (t.multiP > 0 && rndm->getUniform() < t.multiP) {
+                multiTransitions.push_back(currentLevel);
             }
 
-            currentLevel = 0;
-            return 0;
+            // Update the level of the daughter
+            currentLevel = t.level;
+
+            return sampleTransition(t,rndm,true);
         }
 
         // If we have determined that multiple transitions will occur from some
@@ -1443,238 +1427,421 @@ protected:
         // ============================
         currentTime = 0;
 
-        // Beta-, beta+ and electron capture
-        for (vector<BetaRecordLeaf *>::iterator beta = myBetas.begin();
-                beta != myBetas.end(); beta++) {
-            if (u < (*beta)->getBetaIntensity()) {
+        // If we get here with no decay channel, fission occurs
+        // Count it as a disintegration and return 0
+        if (!channelTable) {
+            ishower++;
+            return 0;
+        }
 
-                // Increment the shower number
-                ishower++;
+        const EGS_DecayChannel &c = channels[channelTable->sample(rndm)];
+        switch (c.type) {
 
-                // Increment the counter of betas and get the charge
-                (*beta)->incrNumSampled();
-                currentQ = (*beta)->getCharge();
+        // Beta-, beta+ and electron capture
+        case BetaChannel: {
 
-                // Set the energy level of the daughter
-                currentLevel = (*beta)->getLevelRecord();
+            BetaRecordLeaf *beta = myBetas[c.record];
 
-                // For beta+ records we decide between
-                // branches for beta+ or electron capture
-                if (currentQ == 1) {
-                    // For positron emission, continue as usual
-                    if ((*beta)->getPositronIntensity() > epsilon && rndm->getUniform() < (*beta)->getPositronIntensity()) {
+            // Increment the shower number
+            ishower++;
 
-                    }
-                    else {
+            // Increment the counter of betas and get the charge
+            beta->incrNumSampled();
+            currentQ = c.q;
 
-                        if (relaxationType == "eadl" && (*beta)->ecShellIntensity.size()) {
-                            // Determine which shell the electron capture
-                            // occurs in. This will create a shell vacancy
-                            EGS_Float u3 = rndm->getUniform();
+            // Set the energy level of the daughter
+            currentLevel = c.level;
 
-                            for (unsigned int i=0; i<(*beta)->ecShellIntensity.size(); ++i) {
-                                if (u3 < (*beta)->ecShellIntensity[i]) {
+            // For beta+ records we decide between
+            // branches for beta+ or electron capture
+            if (currentQ == 1) {
+                // For positron emission, continue as usual
+                if (c.branch <= epsilon || rndm->getUniform() >= c.branch) {
 
-                                    // Generate relaxation particles for a
-                                    // shell vacancy i
-                                    (*beta)->relax(i,app->getEcut()-app->getRM(),app->getPcut(),rndm,edep,relaxParticles);
+                    if (eadlRelax && beta->ecShellIntensity.size()) {
+                        // Determine which shell the electron capture
+                        // occurs in. This will create a shell vacancy
+                        EGS_Float u3 = rndm->getUniform();
 
-                                    emissionType = 4;
+                        for (unsigned int i=0; i<beta->ecShellIntensity.size(); ++i) {
+                            if (u3 < beta->ecShellIntensity[i]) {
 
-                                    return 0;
-                                }
+                                // Generate relaxation particles for a
+                                // shell vacancy i
+                                beta->relax(i,app->getEcut()-app->getRM(),app->getPcut(),rndm,edep,relaxParticles);
+                                break;
                             }
                         }
-
-                        // For electron capture, there is no emitted particle
-                        // (only a neutrino)
-                        // so we return a 0 energy particle
-                        emissionType = 4;
-                        return 0;
                     }
-                    emissionType = 5;
-                }
-                else {
-                    emissionType = 6;
-                }
 
-                // Sample the energy from the spectrum alias table
-                E = (*beta)->getSpectrum()->sample(rndm);
-
-                return E;
+                    // For electron capture, there is no emitted particle
+                    // (only a neutrino)
+                    // so we return a 0 energy particle
+                    emissionType = 4;
+                    return 0;
+                }
+                emissionType = 5;
+            }
+            else {
+                emissionType = 6;
             }
+
+            // Sample the energy from the spectrum alias table
+            return c.spectrum->sample(rndm);
         }
 
         // Alphas
-        for (vector<AlphaRecord *>::iterator alpha = myAlphas.begin();
-                alpha != myAlphas.end(); alpha++) {
-            if (u < (*alpha)->getAlphaIntensity()) {
+        case AlphaChannel: {
 
-                // Increment the shower number
-                ishower++;
+            // Increment the shower number
+            ishower++;
 
-                // Increment the counter of alphas and get the charge
-                (*alpha)->incrNumSampled();
-                currentQ = (*alpha)->getCharge();
+            // Increment the counter of alphas and get the charge
+            myAlphas[c.record]->incrNumSampled();
+            currentQ = c.q;
 
-                // Set the energy level of the daughter
-                currentLevel = (*alpha)->getLevelRecord();
+            // Set the energy level of the daughter
+            currentLevel = c.level;
 
-                // Score alpha energy depositions locally,
-                // because alpha transport is not modeled in EGSnrc.
-                // This is an approximation!
-                if (scoreAlphasLocal) {
-                    edep += (*alpha)->getFinalEnergy();
-                }
+            // Score alpha energy depositions locally,
+            // because alpha transport is not modeled in EGSnrc.
+            // This is an approximation!
+            if (scoreAlphasLocal) {
+                edep += c.E;
+            }
 
-                emissionType = 7;
+            emissionType = 7;
 
-                // For alphas we simulate a disintegration but the
-                // transport will not be performed so return 0
-                return 0;
-            }
+            // For alphas we simulate a disintegration but the
+            // transport will not be performed so return 0
+            return 0;
         }
 
         // Metastable "decays" that will result in internal transitions
-        for (vector<GammaRecord *>::iterator gamma = myMetastableGammas.begin();
-                gamma != myMetastableGammas.end(); gamma++) {
-            if (u < (*gamma)->getTransitionIntensity()) {
+        case MetastableChannel:
 
-                // Increment the shower number
-                ishower++;
+            // Increment the shower number
+            ishower++;
 
-                // Set the energy level of the daughter as though a
-                // disintegration just occurred
-                currentLevel = (*gamma)->getLevelRecord();
+            // Set the energy level of the daughter as though a
+            // disintegration just occurred
+            currentLevel = c.level;
 
-                emissionType = 8;
+            emissionType = 8;
 
-                // No particle returned
-                return 0;
-            }
-        }
+            // No particle returned
+            return 0;
 
         // Uncorrelated internal transitions
-        for (vector<GammaRecord *>::iterator gamma = myUncorrelatedGammas.begin();
-                gamma != myUncorrelatedGammas.end(); gamma++) {
-            if (u < (*gamma)->getTransitionIntensity()) {
+        case UncorrelatedChannel:
+            return sampleTransition(transitions[c.record],rndm,false);
 
-                // A gamma transition may either be a gamma emission
-                // or an internal conversion electron
-                EGS_Float u2 = 0;
-                if ((*gamma)->getGammaIntensity() < 1) {
-                    u2 = rndm->getUniform();
-                }
+        // XRays from the ensdf
+        case XRayChannel:
+            numSampledXRay[c.record]++;
+            currentQ = 0;
+            emissionType = 9;
+            return c.E;
 
-                // If a gamma emission occurs
-                if (u2 < (*gamma)->getGammaIntensity()) {
+        // Auger electrons from the ensdf
+        case AugerChannel:
+            numSampledAuger[c.record]++;
+            currentQ = -1;
+            emissionType = 10;
+            return c.E;
 
-                    (*gamma)->incrGammaSampled();
+        // Fission occurs
+        // Count it as a disintegration and return 0
+        default:
+            ishower++;
+            return 0;
+        }
+    };
 
-                    currentQ = (*gamma)->getCharge();
+    /*! \brief Not implemented - returns 0.
+     */
+    EGS_Float expectedAverage() const {
+        return 0;
+    };
 
-                    E = (*gamma)->getDecayEnergy();
+private:
 
-                    totalGammaEnergy += E;
+    /*! \brief A gamma transition in the flattened decay scheme */
+    struct EGS_DecayTransition {
+        GammaRecord *gamma;  //!< The ensdf record (sampling counters, shells)
+        EGS_Float   E;       //!< Transition energy
+        EGS_Float   gammaI;  //!< Probability of gamma emission
+        EGS_Float   icI;     //!< Cumulative probability of gamma or IC
+        EGS_Float   multiP;  //!< Probability of multiple transitions
+        int         level;   //!< Final level index or -1
+        int         q;       //!< Charge of the emitted photon
+    };
 
-                    emissionType = 11;
+    /*! \brief An excited daughter level in the flattened decay scheme
 
-                    return E;
+      The alias table has a bin for each of the \a n transitions starting
+      at \a first and, if the transitions do not add to unity, a last bin
+      for no transition.
+    */
+    struct EGS_DecayLevel {
+        int                  first, n;
+        EGS_Float            halfLife;
+        EGS_SimpleAliasTable *table;
+    };
 
-                }
-                else if (u2 < (*gamma)->getICIntensity()) {
-                    (*gamma)->incrICSampled();
-                    currentQ = -1;
-                    emissionType = 12;
+    /*! \brief Decay channel types */
+    enum {
+        BetaChannel, AlphaChannel, MetastableChannel, UncorrelatedChannel,
+        XRayChannel, AugerChannel, FissionChannel
+    };
 
-                    if ((*gamma)->icIntensity.size()) {
+    /*! \brief A decay channel sampled from \a channelTable */
+    struct EGS_DecayChannel {
+        int            type;      //!< Channel type
+        int            record;    //!< Index in the list for this type
+        int            level;     //!< Daughter level index or -1
+        int            q;         //!< Charge
+        EGS_Float      E;         //!< Energy for alphas, x-rays and Augers
+        EGS_Float      branch;    //!< Positron branching ratio for beta+
+        EGS_AliasTable *spectrum; //!< Beta spectrum
+    };
 
-                        // Determine which shell the conversion electron
-                        // comes from. This will create a shell vacancy
-                        EGS_Float u3 = rndm->getUniform();
+    /*! \brief Returns the index of the level \a lev in \a myLevels
 
-                        for (unsigned int i=0; i<(*gamma)->icIntensity.size(); ++i) {
-                            if (u3 < (*gamma)->icIntensity[i]) {
+      Returns -1 for a null level or a level from which no transitions
+      can be sampled.
+    */
+    int getLevelIndex(const LevelRecord *lev) const {
+        if (!lev || !lev->levelCanDecay() || lev->getEnergy() <= epsilon) {
+            return -1;
+        }
+        for (unsigned int j=0; j<myLevels.size(); ++j) {
+            if (myLevels[j] == lev) {
+                return levels[j].table ? j : -1;
+            }
+        }
+        return -1;
+    }
 
-                                E = (*gamma)->getDecayEnergy() - (*gamma)->getBindingEnergy(i);
+    /*! \brief Adds the transition \a gamma to \a transitions */
+    void addTransition(GammaRecord *gamma, int level) {
+        EGS_DecayTransition t;
+        t.gamma = gamma;
+        t.E = gamma->getDecayEnergy();
+        t.gammaI = gamma->getGammaIntensity();
+        t.icI = gamma->getICIntensity();
+        t.multiP = gamma->getMultiTransitionProb();
+        t.level = level;
+        t.q = gamma->getCharge();
+        transitions.push_back(t);
+    }
 
-                                // Add relaxation particles to the source stack
-                                if (relaxationType == "eadl") {
+    /*! \brief Adds a channel with cumulative intensity \a cumul
 
-                                    // Generate relaxation particles for a
-                                    // shell vacancy i
-                                    (*gamma)->relax(i,app->getEcut()-app->getRM(),app->getPcut(),rndm,edep,relaxParticles);
-                                }
+      The normalized ensdf intensities are cumulative in the order in which
+      sample() used to scan them. The probability of a channel is therefore
+      the part of \a cumul above the largest preceding cumulative value
+      \a cmax.
+    */
+    void addChannel(const EGS_DecayChannel &c, double cumul, double &cmax,
+                    vector<EGS_Float> &prob) {
+        channels.push_back(c);
+        prob.push_back(cumul > cmax ? cumul - cmax : 0);
+        if (cumul > cmax) {
+            cmax = cumul;
+        }
+    }
 
-                                // Return the conversion electron
-                                return E;
-                            }
-                        }
+    /*! \brief Flatten the ensdf decay scheme for sampling
+
+      Builds contiguous transition data and an alias table for the
+      transitions away from each excited level and one alias table for
+      the choice of the decay channel, so that sample() needs neither
+      searches through the record lists nor pointer chasing through the
+      ensdf object graph.
+    */
+    void buildDecayGraph() {
+
+        // Transitions away from each level
+        levels.resize(myLevels.size());
+        vector<EGS_Float> prob;
+        for (unsigned int j=0; j<myLevels.size(); ++j) {
+            EGS_DecayLevel &level = levels[j];
+            level.first = transitions.size();
+            level.n = 0;
+            level.halfLife = myLevels[j]->getHalfLife();
+            level.table = 0;
+            prob.clear();
+            double cmax = 0;
+            for (vector<GammaRecord *>::iterator gamma = myGammas.begin();
+                    gamma != myGammas.end(); gamma++) {
+                if ((*gamma)->getLevelRecord() == myLevels[j]) {
+                    double cumul = (*gamma)->getTransitionIntensity();
+                    prob.push_back(cumul > cmax ? cumul - cmax : 0);
+                    if (cumul > cmax) {
+                        cmax = cumul;
                     }
-                    return 0;
+                    addTransition(*gamma,-1);
+                    level.n++;
                 }
-                else {
-                    (*gamma)->incrIPSampled();
-                    emissionType = 14;
+            }
+            if (level.n) {
+                if (cmax < 1-1e-10) {
+                    prob.push_back(1-cmax);
+                }
+                level.table = new EGS_SimpleAliasTable(prob.size(),&prob[0]);
+            }
+        }
+
+        // Final levels are resolved once all levels are known
+        for (unsigned int i=0; i<transitions.size(); ++i) {
+            transitions[i].level =
+                getLevelIndex(transitions[i].gamma->getFinalLevel());
+        }
+
+        // Decay channels, in the order of the cumulative intensities
+        prob.clear();
+        double cmax = 0;
+        EGS_DecayChannel c;
+        c.E = 0;
+        c.branch = 0;
+        c.spectrum = 0;
+        c.q = 0;
+        for (unsigned int i=0; i<myBetas.size(); ++i) {
+            c.type = BetaChannel;
+            c.record = i;
+            c.level = getLevelIndex(myBetas[i]->getLevelRecord());
+            c.q = myBetas[i]->getCharge();
+            c.branch = myBetas[i]->getPositronIntensity();
+            c.spectrum = myBetas[i]->getSpectrum();
+            addChannel(c,myBetas[i]->getBetaIntensity(),cmax,prob);
+        }
+        c.branch = 0;
+        c.spectrum = 0;
+        for (unsigned int i=0; i<myAlphas.size(); ++i) {
+            c.type = AlphaChannel;
+            c.record = i;
+            c.level = getLevelIndex(myAlphas[i]->getLevelRecord());
+            c.q = myAlphas[i]->getCharge();
+            c.E = myAlphas[i]->getFinalEnergy();
+            addChannel(c,myAlphas[i]->getAlphaIntensity(),cmax,prob);
+        }
+        c.E = 0;
+        c.q = 0;
+        for (unsigned int i=0; i<myMetastableGammas.size(); ++i) {
+            c.type = MetastableChannel;
+            c.record = i;
+            c.level = getLevelIndex(myMetastableGammas[i]->getLevelRecord());
+            addChannel(c,myMetastableGammas[i]->getTransitionIntensity(),
+                       cmax,prob);
+        }
+        c.level = -1;
+        for (unsigned int i=0; i<myUncorrelatedGammas.size(); ++i) {
+            c.type = UncorrelatedChannel;
+            c.record = transitions.size();
+            addTransition(myUncorrelatedGammas[i],-1);
+            addChannel(c,myUncorrelatedGammas[i]->getTransitionIntensity(),
+                       cmax,prob);
+        }
+        for (unsigned int i=0; i<xrayIntensities.size(); ++i) {
+            c.type = XRayChannel;
+            c.record = i;
+            c.E = xrayEnergies[i];
+            addChannel(c,xrayIntensities[i],cmax,prob);
+        }
+        for (unsigned int i=0; i<augerIntensities.size(); ++i) {
+            c.type = AugerChannel;
+            c.record = i;
+            c.E = augerEnergies[i];
+            addChannel(c,augerIntensities[i],cmax,prob);
+        }
+        if (cmax < 1-1e-10) {
+            c.type = FissionChannel;
+            c.record = 0;
+            c.E = 0;
+            addChannel(c,1,cmax,prob);
+        }
+        if (channels.size()) {
+            channelTable = new EGS_SimpleAliasTable(channels.size(),&prob[0]);
+        }
+    }
 
-                    // Internal pair production results in a positron
-                    // and electron pair
+    /*! \brief Sample the emission for the gamma transition \a t
 
-                    //TODO: This is left for future work, we need to
-                    // determine the energies of the electron/positron
-                    // pair (sample uniformly?) and then determine the
-                    // corresponding directions. It might be best to do
-                    // this in the source instead of the spectrum.
+      A gamma transition may either be a gamma emission, an internal
+      conversion electron or internal pair production. \a correlated
+      distinguishes transitions following a disintegration from
+      uncorrelated transitions for the emission type.
+    */
+    EGS_Float sampleTransition(const EGS_DecayTransition &t,
+                               EGS_RandomGenerator *rndm, bool correlated) {
 
-                    currentQ = 1;
-                    return 0;
-                }
-            }
+        EGS_Float u2 = 0;
+        if (t.gammaI < 1) {
+            u2 = rndm->getUniform();
         }
 
-        // XRays from the ensdf
-        for (unsigned int i=0; i < xrayIntensities.size(); ++i) {
-            if (u < xrayIntensities[i]) {
+        // If a gamma emission occurs
+        if (u2 < t.gammaI) {
 
-                numSampledXRay[i]++;
-                currentQ = 0;
+            t.gamma->incrGammaSampled();
 
-                E = xrayEnergies[i];
+            currentQ = t.q;
 
-                emissionType = 9;
+            totalGammaEnergy += t.E;
 
-                return E;
-            }
+            emissionType = correlated ? 2 : 11;
+
+            return t.E;
         }
+        else if (u2 < t.icI) {
+            t.gamma->incrICSampled();
+            currentQ = -1;
+            emissionType = correlated ? 3 : 12;
 
-        // Auger electrons from the ensdf
-        for (unsigned int i=0; i < augerIntensities.size(); ++i) {
-            if (u < augerIntensities[i]) {
+            const vector<double> &icIntensity = t.gamma->icIntensity;
+            if (icIntensity.size()) {
+
+                // Determine which shell the conversion electron
+                // comes from. This will create a shell vacancy
+                EGS_Float u3 = rndm->getUniform();
 
-                numSampledAuger[i]++;
-                currentQ = -1;
+                for (unsigned int i=0; i<icIntensity.size(); ++i) {
+                    if (u3 < icIntensity[i]) {
 
-                E = augerEnergies[i];
+                        EGS_Float E = t.E - t.gamma->getBindingEnergy(i);
 
-                emissionType = 10;
+                        // Add relaxation particles to the source stack
+                        if (eadlRelax) {
+
+                            // Generate relaxation particles for a
+                            // shell vacancy i
+                            t.gamma->relax(i,app->getEcut()-app->getRM(),app->getPcut(),rndm,edep,relaxParticles);
+                        }
 
-                return E;
+                        // Return the conversion electron
+                        return E;
+                    }
+                }
             }
+            return 0;
         }
 
-        // If we get here, fission occurs
-        // Count it as a disintegration and return 0
-        ishower++;
-        return 0;
-    };
+        t.gamma->incrIPSampled();
+        emissionType = correlated ? 13 : 14;
 
-    /*! \brief Not implemented - returns 0.
-     */
-    EGS_Float expectedAverage() const {
-        return 0;
-    };
+        // Internal pair production results in a positron
+        // and electron pair
 
-private:
+        //TODO: This is left for future work, we need to
+        // determine the energies of the electron/positron
+        // pair (sample uniformly?) and then determine the
+        // corresponding directions. It might be best to do
+        // this in the source instead of the spectrum.
+
+        currentQ = 1;
+        return 0;
+    }
 
     EGS_Ensdf                   *decays;
     vector<BetaRecordLeaf *>    myBetas;
@@ -1689,9 +1856,13 @@ private:
            augerEnergies;
     vector<EGS_I64>             numSampledXRay,
            numSampledAuger;
-    vector<const LevelRecord *> multiTransitions;
+    vector<EGS_DecayTransition> transitions;
+    vector<EGS_DecayLevel>      levels;
+    vector<EGS_DecayChannel>    channels;
+    EGS_SimpleAliasTable        *channelTable;
+    vector<int>                 multiTransitions;
     EGS_SimpleContainer<EGS_RelaxationParticle> relaxParticles;
-    const LevelRecord           *currentLevel;
+    int                         currentLevel;
     int                         currentQ;
     unsigned int                emissionType;
     EGS_Float                   currentTime,
@@ -1701,7 +1872,8 @@ private:
                                 edep;
     EGS_I64                     ishower;
     string                      relaxationType;
-    bool                        scoreAlphasLocal;
+    bool                        scoreAlphasLocal,
+                                eadlRelax;
 
     EGS_RadionuclideBetaSpectrum *betaSpectra;
     EGS_Application             *app;
@@ -2214,8 +2386,22 @@ EGS_BaseSpectrum *EGS_BaseSpectrum::createSpectrum(EGS_Input *input) {
         }
         ensdf_fh.close();
 
+        // Determine whether to cache the processed decay data
+        // (options: yes or no)
+        string tmp_ensdfCache;
+        bool useCache = false;
+        err = inp->getInput("ensdf cache", tmp_ensdfCache);
+        if (!err) {
+            if (inp->compare(tmp_ensdfCache,"yes")) {
+                useCache = true;
+            }
+            else if (!inp->compare(tmp_ensdfCache,"no")) {
+                egsFatal("EGS_BaseSpectrum::createSpectrum: Error: Invalid selection for 'ensdf cache'. Use 'no' (default) or 'yes'.\n");
+            }
+        }
+
         // Create the spectrum
-        spec = new EGS_RadionuclideSpectrum(nuclide, ensdf_file, relativeActivity, relaxType, outputBetaSpectra, scoreAlphasLocally, allowMultiTransition);
+        spec = new EGS_RadionuclideSpectrum(nuclide, ensdf_file, relativeActivity, relaxType, outputBetaSpectra, scoreAlphasLocally, allowMultiTransition, useCache);
     }
     else {
         egsWarning("%s unknown spectrum type %s\n",spec_msg1,stype.c_str());
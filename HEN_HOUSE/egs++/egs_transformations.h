@@ -229,6 +229,17 @@ public:
                           rzx*v.x + rzy*v.y + rzz*v.z);
     };
 
+    /*! \brief Rotates the \a n vectors stored in the arrays \a x, \a y
+      and \a z (structure of arrays layout) */
+    void rotate(int n, EGS_Float *x, EGS_Float *y, EGS_Float *z) const {
+        for (int j=0; j<n; j++) {
+            EGS_Float xj = x[j], yj = y[j], zj = z[j];
+            x[j] = rxx*xj + rxy*yj + rxz*zj;
+            y[j] = ryx*xj + ryy*yj + ryz*zj;
+            z[j] = rzx*xj + rzy*yj + rzz*zj;
+        }
+    };
+
     /*! \brief Multiplies the invoking object with \a m from the right
       and returns the result. */
     EGS_RotationMatrix operator*(const EGS_RotationMatrix &m) const {
@@ -419,6 +430,15 @@ public:
     EGS_AffineTransform(const EGS_AffineTransform &tr) :
         R(tr.R),t(tr.t),has_t(tr.has_t),has_R(tr.has_R) {};
 
+    /*! \brief Assignment operator */
+    EGS_AffineTransform &operator=(const EGS_AffineTransform &tr) {
+        R = tr.R;
+        t = tr.t;
+        has_t = tr.has_t;
+        has_R = tr.has_R;
+        return *this;
+    };
+
     /*! \brief Constructs an affine transformation object from the rotation
       \a m and translation \a v. */
     EGS_AffineTransform(const EGS_RotationMatrix &m, const EGS_Vector &v) :
@@ -540,6 +560,21 @@ public:
         }
     };
 
+    /*! \brief Transforms the \a n vectors stored in the arrays \a x, \a y
+      and \a z (structure of arrays layout) */
+    void transform(int n, EGS_Float *x, EGS_Float *y, EGS_Float *z) const {
+        if (has_R) {
+            R.rotate(n,x,y,z);
+        }
+        if (has_t) {
+            for (int j=0; j<n; j++) {
+                x[j] += t.x;
+                y[j] += t.y;
+                z[j] += t.z;
+            }
+        }
+    };
+
     /*! \brief Applies the inverse transformation to the vector \a v */
     void inverseTransform(EGS_Vector &v) const {
         if (has_t) {
@@ -564,6 +599,13 @@ public:
             v = R*v;
         }
     };
+    /*! \brief Applies the rotation to the \a n vectors stored in the
+      arrays \a x, \a y and \a z */
+    void rotate(int n, EGS_Float *x, EGS_Float *y, EGS_Float *z) const {
+        if (has_R) {
+            R.rotate(n,x,y,z);
+        }
+    };
     /*! \brief Applies the inverse rotation to the vector \a v */
     void rotateInverse(EGS_Vector &v) const {
         if (has_R) {
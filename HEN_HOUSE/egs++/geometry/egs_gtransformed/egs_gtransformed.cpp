@@ -41,6 +41,21 @@
 #include "egs_input.h"
 #include "egs_functions.h"
 
+void EGS_TransformedGeometry::updateMotion() {
+    EGS_Float mu = EGS_BaseGeometry::getMU();
+    if (mu == last_mu) {
+        return;
+    }
+    last_mu = mu;
+    EGS_AffineTransform Tm;
+    if (mu >= 0 && motion->getTransformation(mu,Tm)) {
+        T = Tm*T0;
+    }
+    else {
+        T = T0;
+    }
+}
+
 void EGS_TransformedGeometry::setMedia(EGS_Input *,int,const int *) {
     egsWarning("EGS_TransformedGeometry::setMedia: don't use this method. Use the\n"
                " setMedia() methods of the geometry objects that make up this geometry\n");
@@ -97,19 +112,37 @@ extern "C" {
             }
         }
         g->ref();
+        vector<EGS_ControlPoint> cpts;
+        EGS_Input *imotion = input->takeInputItem("motion");
+        if (imotion) {
+            bool ok = EGS_ControlPointTable::getControlPoints(imotion,cpts,
+                      "createGeometry(gtransformed)");
+            delete imotion;
+            if (!ok) {
+                egsWarning("createGeometry(gtransformed): invalid motion "
+                           "input\n");
+                if (!g->deref()) {
+                    delete g;
+                }
+                return 0;
+            }
+        }
         EGS_AffineTransform *t = EGS_AffineTransform::getTransformation(input);
-        EGS_BaseGeometry *result;
+        EGS_TransformedGeometry *result;
         if (!t) {
-            egsWarning("createGeometry(gtransformed): null transformation."
+            if (!cpts.size()) egsWarning("createGeometry(gtransformed): null transformation."
                        " I hope you know what you are doing\n");
             result = new EGS_TransformedGeometry(g,EGS_AffineTransform());
         }
         else {
-            if (t->isI()) egsWarning("createGeometry(gtransformed): "
+            if (t->isI() && !cpts.size()) egsWarning("createGeometry(gtransformed): "
                                          "unity transformation. I hope you know what you are doing\n");
             result = new EGS_TransformedGeometry(g,*t);
             delete t;
         }
+        if (cpts.size()) {
+            result->setMotion(cpts);
+        }
         result->setName(input);
         result->setBoundaryTolerance(input);
         result->setLabels(input);
@@ -41,6 +41,7 @@
 
 #include "egs_base_geometry.h"
 #include "egs_transformations.h"
+#include "egs_control_points.h"
 
 #ifdef WIN32
 
@@ -95,6 +96,25 @@ input defining the transformation
 The input defining the affine transformation is described in
 EGS_AffineTransform::getTransformation().
 
+A transformed geometry can in addition move synchronously with a
+dynamic source (see EGS_DynamicSource) by supplying a set of control
+points in a motion block:
+\verbatim
+:start motion:
+    control point 1 = xiso yiso ziso dsource theta phi phicol mu
+    control point 2 = ...
+    ...
+:stop motion:
+\endverbatim
+The control points have the same meaning and restrictions as for
+EGS_DynamicSource. The position of the geometry for a given fractional
+monitor unit index \f$\mu\f$ is obtained by interpolating between
+the control points and is applied after the static transformation above.
+The application passes the \f$\mu\f$ of the source to the geometries
+once per history via EGS_BaseGeometry::setMU() and the interpolated
+transformation is only recomputed when \f$\mu\f$ changes. If the source
+does not provide \f$\mu\f$, the geometry remains at its static position.
+
 Transformed geometries are used in the
 <code>car.geom, chambers_in_box.geom, seeds_in_xyz.geom</code> and
 \c seeds_in_xyz1.geom example geometry files.
@@ -137,13 +157,22 @@ protected:
     EGS_AffineTransform T;    //!< The affine transformation
     string              type; //!< The geometry type
 
+    EGS_ControlPointTable *motion;  //!< Motion control points (if any)
+    EGS_AffineTransform   T0;       //!< The static transformation
+    EGS_Float             last_mu;  //!< \f$\mu\f$ used to compute T
+
+    /*! \brief Update \a T for the current \f$\mu\f$ (see
+    EGS_BaseGeometry::setMU()) */
+    void updateMotion();
+
 public:
 
     /*! \brief Construct a geometry that is a copy of the geometry \a G
     transformed by \a t
     */
     EGS_TransformedGeometry(EGS_BaseGeometry *G, const EGS_AffineTransform &t,
-                            const string &Name = "") : EGS_BaseGeometry(Name), g(G), T(t) {
+                            const string &Name = "") : EGS_BaseGeometry(Name), g(G), T(t),
+        motion(0), T0(t), last_mu(-1) {
         type = g->getType();
         type += "T";
         nreg = g->regions();
@@ -156,14 +185,35 @@ public:
         if (!g->deref()) {
             delete g;
         }
+        if (motion) {
+            delete motion;
+        }
     };
 
     void setTransformation(const EGS_AffineTransform &t) {
         T = t;
+        T0 = t;
+        last_mu = -1;
+    };
+
+    /*! \brief Set the motion control points.
+
+    The control point \f$\mu\f$ values must be increasing and normalized
+    to unity (see EGS_ControlPointTable::getControlPoints()).
+    */
+    void setMotion(const vector<EGS_ControlPoint> &cpts) {
+        if (!motion) {
+            motion = new EGS_ControlPointTable;
+        }
+        motion->setControlPoints(cpts);
+        last_mu = -1;
     };
 
     int computeIntersections(int ireg, int n, const EGS_Vector &x,
                              const EGS_Vector &u, EGS_GeometryIntersections *isections) {
+        if (motion) {
+            updateMotion();
+        }
         EGS_Vector xt(x), ut(u);
         T.inverseTransform(xt);
         T.rotateInverse(ut);
@@ -174,12 +224,18 @@ public:
         return g->isRealRegion(ireg);
     };
     bool isInside(const EGS_Vector &x) {
+        if (motion) {
+            updateMotion();
+        }
         EGS_Vector xt(x);
         T.inverseTransform(xt);
         return g->isInside(xt);
         //return g->isInside(x*T);
     };
     int isWhere(const EGS_Vector &x) {
+        if (motion) {
+            updateMotion();
+        }
         EGS_Vector xt(x);
         T.inverseTransform(xt);
         return g->isWhere(xt);
@@ -195,10 +251,16 @@ public:
 
     EGS_Float howfarToOutside(int ireg, const EGS_Vector &x,
                               const EGS_Vector &u) {
+        if (motion) {
+            updateMotion();
+        }
         return ireg >= 0 ? g->howfarToOutside(ireg,x*T,u*T.getRotation()) : 0;
     };
     int howfar(int ireg, const EGS_Vector &x, const EGS_Vector &u,
                EGS_Float &t, int *newmed=0, EGS_Vector *normal=0) {
+        if (motion) {
+            updateMotion();
+        }
         EGS_Vector xt(x), ut(u);
         T.inverseTransform(xt);
         T.rotateInverse(ut);
@@ -211,6 +273,9 @@ public:
     };
 
     EGS_Float hownear(int ireg, const EGS_Vector &x) {
+        if (motion) {
+            updateMotion();
+        }
         EGS_Vector xt(x);
         T.inverseTransform(xt);
         return g->hownear(ireg,xt);
@@ -108,6 +108,59 @@ public:
         return EGS_Vector(xo + r*cphi, yo + r*sphi, 0);
     };
 
+    bool supportsSolidAngleMethod() const {
+        return true;
+    };
+
+    /*! \brief Sample a direction within the solid angle subtended by the
+     * circle as seen from \a Xo.
+     *
+     * Directions are sampled uniformly within the cone that contains the
+     * sphere enclosing the circle (or within the half space facing the
+     * circle if \a Xo is inside this sphere). \a wt is set to the solid
+     * angle of the cone for directions that hit the circle and to zero
+     * otherwise, so that the expectation value of \a wt is the solid angle
+     * subtended by the circle.
+     */
+    void getSolidAngleDirection(const EGS_Vector &Xo,
+                                EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt) {
+        EGS_Vector x = T ? Xo*(*T) : Xo;
+        wt = 0;
+        if (!x.z) {
+            return;
+        }
+        EGS_Float R = ro + dr;
+        EGS_Vector a(xo-x.x,yo-x.y,-x.z);
+        EGS_Float d2 = a.length2(), cmin;
+        if (d2 > R*R) {
+            cmin = sqrt(1 - R*R/d2);
+            a *= (1/sqrt(d2));
+        }
+        else {
+            cmin = 0;
+            a = EGS_Vector(0,0,x.z > 0 ? -1 : 1);
+        }
+        EGS_Float cost = cmin + (1 - cmin)*rndm->getUniform(),
+                  sint = sqrt(1 - cost*cost);
+        EGS_Float cphi, sphi;
+        rndm->getAzimuth(cphi,sphi);
+        u = a;
+        u.rotate(cost,sint,cphi,sphi);
+        if (u.z*x.z >= 0) {
+            return;
+        }
+        EGS_Float t = -x.z/u.z;
+        EGS_Float px = x.x + t*u.x - xo, py = x.y + t*u.y - yo;
+        EGS_Float r2 = px*px + py*py;
+        if (r2 > R*R || r2 < ro*ro) {
+            return;
+        }
+        wt = 2*M_PI*(1 - cmin);
+        if (T) {
+            T->rotate(u);
+        }
+    };
+
 protected:
 
     EGS_Float xo, yo, ro, dr;
@@ -63,7 +63,8 @@ EGS_TriangleShape::EGS_TriangleShape(const EGS_Float *points,
 }
 
 EGS_PolygonShape::EGS_PolygonShape(const vector<EGS_Float> &points,
-                                   const string &Name, EGS_ObjectFactory *f) : EGS_SurfaceShape(Name,f) {
+                                   const string &Name, EGS_ObjectFactory *f) : EGS_SurfaceShape(Name,f),
+    have_sph(false) {
     int np = points.size();
     n = np/2;
     EGS_Float auxx = points[np-2] - points[0];
@@ -134,10 +135,40 @@ EGS_PolygonShape::EGS_PolygonShape(const vector<EGS_Float> &points,
         A += yc[i];
     }
     table = new EGS_AliasTable(ntr,xc,yc,0);
+    ntri = ntr;
     delete [] xc;
     delete [] yc;
 }
 
+void EGS_PolygonShape::getSolidAngleDirection(const EGS_Vector &Xo,
+        EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt) {
+    EGS_Vector x = T ? Xo*(*T) : Xo;
+    if (!have_sph || (x-last_x).length2() > 0) {
+        sph_tri.resize(ntri);
+        sph_cum.resize(ntri);
+        EGS_Float sum = 0;
+        for (int j=0; j<ntri; j++) {
+            sum += triangle[j]->setUpSolidAngle(x,sph_tri[j]);
+            sph_cum[j] = sum;
+        }
+        last_x = x;
+        have_sph = true;
+    }
+    wt = sph_cum[ntri-1];
+    if (wt <= 0) {
+        return;
+    }
+    EGS_Float eta = wt*rndm->getUniform();
+    int j = 0;
+    while (j < ntri-1 && eta >= sph_cum[j]) {
+        j++;
+    }
+    u = sph_tri[j].sample(rndm);
+    if (T) {
+        T->rotate(u);
+    }
+}
+
 extern "C" {
 
     EGS_POLYGON_SHAPE_EXPORT EGS_BaseShape *createShape(EGS_Input *input,
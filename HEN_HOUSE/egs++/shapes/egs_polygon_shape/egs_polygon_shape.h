@@ -88,6 +88,36 @@ public:
                           0);
     };
 
+    bool supportsSolidAngleMethod() const {
+        return true;
+    };
+
+    /*! \brief Sample a direction uniformly within the solid angle subtended
+     * by the triangle as seen from \a Xo and set \a wt to this solid angle.
+     */
+    void getSolidAngleDirection(const EGS_Vector &Xo,
+                                EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt) {
+        EGS_Vector x = T ? Xo*(*T) : Xo;
+        EGS_SphericalTriangle st;
+        wt = setUpSolidAngle(x,st);
+        if (wt <= 0) {
+            return;
+        }
+        u = st.sample(rndm);
+        if (T) {
+            T->rotate(u);
+        }
+    };
+
+    /*! \brief Set up \a st for the triangle seen from \a x (given in
+     * the local frame of the triangle) and return the solid angle.
+     */
+    EGS_Float setUpSolidAngle(const EGS_Vector &x,
+                              EGS_SphericalTriangle &st) const {
+        EGS_Vector a(xo-x.x,yo-x.y,-x.z);
+        return st.setUp(a,a+EGS_Vector(ax,ay,0),a+EGS_Vector(bx,by,0));
+    };
+
 protected:
 
     EGS_Float xo, yo, ax, ay, bx, by;
@@ -134,12 +164,32 @@ public:
         return triangle[j]->getPoint(rndm);
     };
 
+    bool supportsSolidAngleMethod() const {
+        return true;
+    };
+
+    /*! \brief Sample a direction uniformly within the solid angle subtended
+     * by the polygon as seen from \a Xo and set \a wt to this solid angle.
+     *
+     * A triangle is selected with a probability proportional to its
+     * solid angle. The spherical triangles are kept and reused as long as
+     * \a Xo does not change (e.g. for a point source).
+     */
+    void getSolidAngleDirection(const EGS_Vector &Xo,
+                                EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt);
+
 protected:
 
     int  n;  // number of triangles
     EGS_TriangleShape **triangle;
     EGS_AliasTable    *table;
 
+    int                            ntri;      //!< number of triangles
+    vector<EGS_SphericalTriangle>  sph_tri;   //!< spherical triangles for last_x
+    vector<EGS_Float>              sph_cum;   //!< cumulative solid angles
+    EGS_Vector                     last_x;    //!< last point seen from
+    bool                           have_sph;  //!< sph_tri is set up
+
 };
 
 #endif
@@ -115,6 +115,35 @@ public:
                           0);
     };
 
+    bool supportsSolidAngleMethod() const {
+        return true;
+    };
+
+    /*! \brief Sample a direction uniformly within the solid angle subtended
+     * by the rectangle as seen from \a Xo and set \a wt to this solid angle.
+     */
+    void getSolidAngleDirection(const EGS_Vector &Xo,
+                                EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt) {
+        EGS_Vector xo = T ? Xo*(*T) : Xo;
+        EGS_SphericalRectangle sr;
+        wt = setUpSolidAngle(xo,sr);
+        if (wt <= 0) {
+            return;
+        }
+        u = sr.sample(rndm);
+        if (T) {
+            T->rotate(u);
+        }
+    };
+
+    /*! \brief Set up \a sr for the rectangle seen from \a xo (given in
+     * the local frame of the rectangle) and return the solid angle.
+     */
+    EGS_Float setUpSolidAngle(const EGS_Vector &xo,
+                              EGS_SphericalRectangle &sr) const {
+        return sr.setUp(xo,xmin,xmax,ymin,ymax);
+    };
+
 protected:
 
     EGS_Float xmin, xmax, ymin, ymax, dx, dy;
@@ -147,6 +176,40 @@ public:
         return r[j]->getPoint(rndm);
     };
 
+    bool supportsSolidAngleMethod() const {
+        return true;
+    };
+
+    /*! \brief Sample a direction uniformly within the solid angle subtended
+     * by the ring as seen from \a Xo and set \a wt to this solid angle.
+     *
+     * One of the 4 rectangles making up the ring is selected with a
+     * probability proportional to its solid angle.
+     */
+    void getSolidAngleDirection(const EGS_Vector &Xo,
+                                EGS_RandomGenerator *rndm, EGS_Vector &u, EGS_Float &wt) {
+        EGS_Vector xo = T ? Xo*(*T) : Xo;
+        EGS_SphericalRectangle sr[4];
+        EGS_Float omega[4];
+        wt = 0;
+        for (int j=0; j<4; j++) {
+            omega[j] = r[j]->setUpSolidAngle(xo,sr[j]);
+            wt += omega[j];
+        }
+        if (wt <= 0) {
+            return;
+        }
+        EGS_Float eta = wt*rndm->getUniform();
+        int j=0;
+        while (j < 3 && (eta > omega[j] || omega[j] <= 0)) {
+            eta -= omega[j++];
+        }
+        u = sr[j].sample(rndm);
+        if (T) {
+            T->rotate(u);
+        }
+    };
+
 protected:
 
     EGS_RectangleShape  *r[4];
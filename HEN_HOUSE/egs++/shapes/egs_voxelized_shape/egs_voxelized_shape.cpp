@@ -156,8 +156,8 @@ void EGS_VoxelizedShape::EGS_VoxelizedShapeFormat0(const char *fname,
         p1[j] = p[j];
     }
     delete [] p;
-    egsInformation("Making alias table\n");
-    prob = new EGS_SimpleAliasTable(nmap,p1);
+    makeAliasTable(nmap,p1,fname);
+    delete [] p1;
     xpos = new EGS_Float [nx+1];
     ypos = new EGS_Float [ny+1];
     zpos = new EGS_Float [nz+1];
@@ -177,10 +177,36 @@ void EGS_VoxelizedShape::EGS_VoxelizedShapeFormat0(const char *fname,
     egsInformation("Done\n");
 }
 
+void EGS_VoxelizedShape::makeAliasTable(int nmap, const EGS_Float *p,
+        const char *fname) {
+    if (!use_cache) {
+        egsInformation("Making alias table\n");
+        prob = new EGS_SimpleAliasTable(nmap,p);
+        return;
+    }
+    string cache_file = string(fname) + ".egsalias";
+    EGS_I64 key = EGS_SimpleAliasTable::hashProbabilities(nmap,p);
+    prob = new EGS_SimpleAliasTable;
+    if (prob->readTable(cache_file,key) && prob->size() == nmap) {
+        egsInformation("Using alias table from %s\n",cache_file.c_str());
+        return;
+    }
+    delete prob;
+    egsInformation("Making alias table\n");
+    prob = new EGS_SimpleAliasTable(nmap,p);
+    if (prob->writeTable(cache_file,key)) {
+        egsInformation("Stored alias table in %s\n",cache_file.c_str());
+    }
+    else {
+        egsWarning("EGS_VoxelizedShape: failed to store alias table in %s\n",
+                   cache_file.c_str());
+    }
+}
+
 EGS_VoxelizedShape::EGS_VoxelizedShape(int file_format, const char *fname,
-                                       const string &Name,EGS_ObjectFactory *f) : EGS_BaseShape(Name,f),
+                                       const string &Name,EGS_ObjectFactory *f, bool cache) : EGS_BaseShape(Name,f),
     prob(0), xpos(0), ypos(0), zpos(0), map(0), nx(0), ny(0), nz(0), nxy(0),
-    nreg(0), type(-1) {
+    nreg(0), type(-1), use_cache(cache) {
     const static char *func = "EGS_VoxelizedShape::EGS_VoxelizedShape";
     if (file_format == 0) { // binary file format -> call original constructor
         string s(fname);
@@ -331,8 +357,8 @@ EGS_VoxelizedShape::EGS_VoxelizedShape(int file_format, const char *fname,
         p1[j] = p[j];
     }
     delete [] p;
-    egsInformation("Making alias table\n");
-    prob = new EGS_SimpleAliasTable(nmap,p1);
+    makeAliasTable(nmap,p1,fname);
+    delete [] p1;
     xpos = new EGS_Float [nx+1];
     ypos = new EGS_Float [ny+1];
     zpos = new EGS_Float [nz+1];
@@ -388,7 +414,12 @@ extern "C" {
                            "file format \n",func);
             file_format = 0;
         }
-        EGS_VoxelizedShape *shape = new EGS_VoxelizedShape(file_format, fname.c_str());
+        vector<string> yn;
+        yn.push_back("no");
+        yn.push_back("yes");
+        bool cache = input->getInput("alias table cache",yn,0) == 1;
+        EGS_VoxelizedShape *shape = new EGS_VoxelizedShape(file_format,
+                fname.c_str(),"",0,cache);
         if (!shape->isValid()) {
             delete shape;
             return 0;
@@ -76,8 +76,16 @@ This shape is specified via
 :start shape:
     library = egs_voxelized_shape
     file name = some_file
+    file format = 0 or 1 (optional, binary or interfile, default is 0)
+    alias table cache = yes or no (optional, default is no)
 :stop shape:
 \endverbatim
+The alias table used to pick voxels is constructed in a time proportional
+to the number of voxels. For very large distributions, the time can be
+further reduced with <code>alias table cache = yes</code>. The table
+is then stored in the file \c some_file.egsalias together with a hash of
+the voxel probabilities and reused in subsequent runs as long as the
+probabilities are unchanged.
 The \c some_file file must be a binary file containing the following information:
  - 1 byte indicating the endianess of the machine the file was created on
    (0 = big endian, 1 = little endian)
@@ -104,7 +112,7 @@ public:
     \c fname
     */
     EGS_VoxelizedShape(int file_format, const char *fname,const string &Name="",
-                       EGS_ObjectFactory *f=0);
+                       EGS_ObjectFactory *f=0, bool cache=false);
     ~EGS_VoxelizedShape();
     void EGS_VoxelizedShapeFormat0(const char *fname,const string &Name="",
                                    EGS_ObjectFactory *f=0);
@@ -136,6 +144,15 @@ protected:
     int        *map;              ///! Voxel map (for type=1)
     int        nx, ny, nz, nxy, nreg;
     int        type;
+    bool       use_cache;         ///! Store/reuse the alias table on disk
+
+    /*! \brief Set up #prob for the \a nmap probabilities \a p
+
+    If #use_cache is true, the alias table is read from the file
+    \a fname.egsalias if it was built from the same probabilities,
+    otherwise it is constructed and stored in this file.
+    */
+    void makeAliasTable(int nmap, const EGS_Float *p, const char *fname);
 };
 
 #endif
@@ -145,6 +145,28 @@ public:
         }
         return c;
     };
+    EGS_I64 getNextParticles(EGS_RandomGenerator *rndm, int n,
+                             EGS_ParticleBlock &p) {
+        EGS_I64 c = source->getNextParticles(rndm,n,p);
+        if (sigma > 0) {
+            for (int j=0; j<n; j++) {
+                EGS_Float cost;
+                do {
+                    cost = 1 + sigma*log(1 - rndm->getUniform());
+                }
+                while (cost <= -1);
+                EGS_Float cphi, sphi;
+                rndm->getAzimuth(cphi,sphi);
+                EGS_Float sint = sqrt(1-cost*cost);
+                EGS_Vector u(p.u[j],p.v[j],p.w[j]);
+                u.rotate(cost,sint,cphi,sphi);
+                p.u[j] = u.x;
+                p.v[j] = u.y;
+                p.w[j] = u.z;
+            }
+        }
+        return c;
+    };
     EGS_Float getEmax() const {
         return source->getEmax();
     };
@@ -39,7 +39,8 @@
 
 EGS_CollimatedSource::EGS_CollimatedSource(EGS_Input *input,
         EGS_ObjectFactory *f) : EGS_BaseSimpleSource(input,f),
-    source_shape(0), target_shape(0), ctry(0), dist(1) {
+    source_shape(0), target_shape(0), ctry(0), dist(1),
+    use_solid_angle(false) {
     EGS_Input *ishape = input->takeInputItem("source shape");
     if (ishape) {
         source_shape = EGS_BaseShape::createShape(ishape);
@@ -88,6 +89,18 @@ EGS_CollimatedSource::EGS_CollimatedSource(EGS_Input *input,
     if (!errd) {
         dist = auxd;
     }
+    vector<string> sampling_options;
+    sampling_options.push_back("area");
+    sampling_options.push_back("solid angle");
+    use_solid_angle = input->getInput("target sampling",sampling_options,0) == 1;
+    if (use_solid_angle && target_shape &&
+            !target_shape->supportsSolidAngleMethod()) {
+        egsWarning("EGS_CollimatedSource: the target shape %s, which is"
+                   " of type %s, does not support solid angle sampling,"
+                   " using area sampling\n",target_shape->getObjectName().c_str(),
+                   target_shape->getObjectType().c_str());
+        use_solid_angle = false;
+    }
     setUp();
 }
 
@@ -115,6 +128,9 @@ void EGS_CollimatedSource::setUp() {
         else {
             description += ", unknown particle type";
         }
+        if (use_solid_angle) {
+            description += ", solid angle sampling";
+        }
     }
 }
 
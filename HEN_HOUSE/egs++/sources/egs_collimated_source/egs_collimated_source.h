@@ -106,6 +106,20 @@ shapes. This accounts for the solid angle within which particles are generated.
 If \c distance is not provided, it defaults to 1, which will likely be
 an incorrect normalization.
 
+With <code>target sampling = solid angle</code> the directions are instead
+sampled uniformly within the solid angle subtended by the target shape
+using the \link EGS_BaseShape::getSolidAngleDirection()
+getSolidAngleDirection() \endlink method and all particles have the same
+weight for a point source, which reduces the variance when the target
+is large or close to the source. This is supported by
+\link EGS_RectangleShape rectangles, \endlink
+\link EGS_RectangularRing "rectangular rings", \endlink
+\link EGS_PolygonShape polygons, \endlink
+\link EGS_TriangleShape triangles \endlink and
+\link EGS_CircleShape circles \endlink (for circles the directions are
+sampled within the enclosing cone and directions missing the circle are
+rejected). For other target shapes area sampling is used.
+
 A collimated source is defined as follows:
 \verbatim
 :start source:
@@ -122,6 +136,7 @@ A collimated source is defined as follows:
     :stop spectrum:
     distance = source-target shape min. distance
     charge = -1 or 0 or 1 for electrons or photons or positrons
+    target sampling = area or solid angle (optional, default is area)
 :stop source:
 \endverbatim
 It is worth noting that the functionality of sources 1, 11, 12, 14, 15 and 16
@@ -170,7 +185,7 @@ public:
                          EGS_BaseShape *sshape, EGS_BaseShape *tshape,
                          const string &Name="", EGS_ObjectFactory *f=0) :
         EGS_BaseSimpleSource(Q,Spec,Name,f), source_shape(sshape),
-        target_shape(tshape), ctry(0), dist(1) {
+        target_shape(tshape), ctry(0), dist(1), use_solid_angle(false) {
         setUp();
     };
 
@@ -190,7 +205,12 @@ public:
         x = source_shape->getRandomPoint(rndm);
         int ntry = 0;
         do {
-            target_shape->getPointSourceDirection(x,rndm,u,wt);
+            if (use_solid_angle) {
+                target_shape->getSolidAngleDirection(x,rndm,u,wt);
+            }
+            else {
+                target_shape->getPointSourceDirection(x,rndm,u,wt);
+            }
             ntry++;
             if (ntry > 10000)
                 egsFatal("EGS_CollimatedSource::getPositionDirection:\n"
@@ -243,6 +263,7 @@ protected:
                   *target_shape;  //!< the target shape
     EGS_I64       ctry;           //!< number of attempts to sample a particle
     EGS_Float     dist;           //!< source-target shape min. distance
+    bool          use_solid_angle; //!< sample within the target solid angle
 
     void setUp();
 
@@ -72,64 +72,13 @@ EGS_DynamicSource::EGS_DynamicSource(EGS_Input *input,
     //get control points
     EGS_Input *dyninp = input->takeInputItem("motion");
     if (dyninp) {
-        //get control points
-        ncpts=0;
-        vector<EGS_Float> point;
-        EGS_ControlPoint cpt;
-        stringstream itos;
-        int err;
-        int icpts=1;
-        itos << icpts;
-        string sstring = "control point " + itos.str();
-        while (!(err = dyninp->getInput(sstring,point))) {
-            if (point.size()!=8) {
-                egsWarning("EGS_DynamicSource: control point %i does not specify 8 values.\n",icpts);
-                valid = false;
-            }
-            else {
-                if (ncpts>0 && point[7] < cpts[ncpts-1].mu) {
-                    egsWarning("EGS_DynamicSource: mu index of control point %i < mu index of control point %i\n",icpts,ncpts);
-                    valid = false;
-                }
-                else if (point[7] < 0.) {
-                    egsWarning("EGS_DynamicSource: mu index of control point %i < 0.0\n",icpts);
-                    valid = false;
-                }
-                else {
-                    ncpts++;
-                    if (ncpts ==1 && point[7] > 0.0) {
-                        egsWarning("EGS_DynamicSource: mu index of control point 1 > 0.0.  This will generate many warning messages.\n");
-                    }
-                    //set cpt values
-                    cpt.iso = EGS_Vector(point[0],point[1],point[2]);
-                    cpt.dsource = point[3];
-                    cpt.theta = point[4];
-                    cpt.phi = point[5];
-                    cpt.phicol = point[6];
-                    cpt.mu = point[7];
-                    //add it to the vector of control points
-                    cpts.push_back(cpt);
-                    icpts++;
-                    itos.str("");
-                    itos << icpts;
-                    sstring = "control point " + itos.str();
-                }
-            }
-        }
-        if (ncpts<=1) {
-            egsWarning("EGS_DynamicSource: not enough or missing control points.\n");
-            valid = false;
-        }
-        if (cpts[ncpts-1].mu == 0.0) {
-            egsWarning("EGS_DynamicSource: mu index of last control point = 0.  Something's wrong.\n");
+        if (!EGS_ControlPointTable::getControlPoints(dyninp,cpts,
+                "EGS_DynamicSource")) {
             valid = false;
         }
-        else {
-            //normalize mu index to max. value
-            for (int i=0; i<ncpts-1; i++) {
-                cpts[i].mu /= cpts[ncpts-1].mu;
-            }
-        }
+        ncpts = cpts.size();
+        table.setControlPoints(cpts);
+        delete dyninp;
     }
     else {
         egsWarning("EGS_DynamicSource: no control points input.\n");
@@ -153,30 +102,36 @@ void EGS_DynamicSource::setUp() {
     }
 }
 
-//actually select the rotation coordinates for the incident particle
-int EGS_DynamicSource::getCoord(EGS_Float rand, EGS_ControlPoint &ipt) {
-    int iindex=0;
-    int i;
-    for (i=0; i<ncpts; i++) {
-        if (rand < cpts[i].mu) {
-            iindex =i;
-            break;
-        }
+EGS_I64 EGS_DynamicSource::getNextParticles(EGS_RandomGenerator *rndm,
+        int n, EGS_ParticleBlock &p) {
+    if (sync) {
+        return EGS_BaseSource::getNextParticles(rndm,n,p);
     }
-    if (i==ncpts) {
-        egsWarning("EGS_DynamicSource: could not locate control point.\n");
-        return 1;
+    EGS_I64 c = source->getNextParticles(rndm,n,p);
+    EGS_AffineTransform T;
+    for (int j=0; j<n; j++) {
+        pmu = rndm->getUniform();
+        while (!table.getTransformation(pmu,T)) {
+            egsWarning("EGS_DynamicSource: could not locate control point.\n");
+            int q, latch;
+            EGS_Float E, wt;
+            EGS_Vector x, u;
+            c = source->getNextParticle(rndm,q,latch,E,wt,x,u);
+            p.set(j,q,latch,E,wt,x,u,c);
+            pmu = rndm->getUniform();
+        }
+        EGS_Vector x(p.x[j],p.y[j],p.z[j]), u(p.u[j],p.v[j],p.w[j]);
+        T.transform(x);
+        T.rotate(u);
+        p.x[j] = x.x;
+        p.y[j] = x.y;
+        p.z[j] = x.z;
+        p.u[j] = u.x;
+        p.v[j] = u.y;
+        p.w[j] = u.z;
     }
-    EGS_Float factor = (rand-cpts[iindex-1].mu)/(cpts[iindex].mu-cpts[iindex-1].mu);
-    ipt.iso.x=cpts[iindex-1].iso.x+ (cpts[iindex].iso.x-cpts[iindex-1].iso.x)*factor;
-    ipt.iso.y=cpts[iindex-1].iso.y+ (cpts[iindex].iso.y-cpts[iindex-1].iso.y)*factor;
-    ipt.iso.z=cpts[iindex-1].iso.z+ (cpts[iindex].iso.z-cpts[iindex-1].iso.z)*factor;
-    ipt.dsource=cpts[iindex-1].dsource+ (cpts[iindex].dsource-cpts[iindex-1].dsource)*factor;
-    ipt.theta=cpts[iindex-1].theta+ (cpts[iindex].theta-cpts[iindex-1].theta)*factor;
-    ipt.phi=cpts[iindex-1].phi+ (cpts[iindex].phi-cpts[iindex-1].phi)*factor;
-    ipt.phicol=cpts[iindex-1].phicol+ (cpts[iindex].phicol-cpts[iindex-1].phicol)*factor;
-    return 0;
-};
+    return c;
+}
 
 extern "C" {
 
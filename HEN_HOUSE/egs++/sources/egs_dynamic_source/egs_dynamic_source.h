@@ -39,6 +39,7 @@
 
 #include "egs_vector.h"
 #include "egs_base_source.h"
+#include "egs_control_points.h"
 #include "egs_rndm.h"
 #include "egs_shapes.h"
 #include <string>
@@ -118,6 +119,14 @@ with mu(1)>0.0, in the case where a user desires to eliminate particles
 associated with a range of mu values, but there will be a lot of
 warning messages.
 
+The control points are converted into an EGS_ControlPointTable when the
+source is constructed, so that the cost of locating the control point
+segment and building the rotation matrices does not grow with the number
+of control points. The monitor unit index of the current particle is
+available through getMu() (and EGS_Application::getMU()) and can be used
+to move geometries together with the source, see the \c motion input of
+EGS_TransformedGeometry.
+
 A simple example is shown below.  This first defines a monoenergetic
 (1 MV) photon source in the Z-direction collimated to a 2x2 field
 centred on the Z-axis.  The control points place the source a
@@ -172,15 +181,8 @@ class EGS_DYNAMIC_SOURCE_EXPORT EGS_DynamicSource :
 public:
 
 
-    struct EGS_ControlPoint {
-
-        EGS_Vector iso; //isocentre position
-        EGS_Float dsource; //source-isocentre distance
-        EGS_Float theta; //angle of rotation about Y-axis
-        EGS_Float phi;  //angle of rotation about Z-axis
-        EGS_Float phicol; //angle of rotation in source plane
-        EGS_Float mu; //monitor unit index for control point
-    };
+    /*! \brief A control point, see EGS_ControlPoint */
+    typedef ::EGS_ControlPoint EGS_ControlPoint;
 
     /*! \brief Construct a dynamic source using \a Source as the
     source and cpts as the control points.  Not sure if this
@@ -210,9 +212,11 @@ public:
                 }
             }
             //normalize mu values
-            for (int i=0; i<npts-1; i++) {
-                cpts[i].mu /= cpts[npts-1].mu;
+            EGS_Float mu_max = cpts[npts-1].mu;
+            for (int i=0; i<npts; i++) {
+                cpts[i].mu /= mu_max;
             }
+            table.setControlPoints(cpts);
         }
         setUp();
     };
@@ -227,10 +231,9 @@ public:
     EGS_I64 getNextParticle(EGS_RandomGenerator *rndm,
                             int &q, int &latch, EGS_Float &E, EGS_Float &wt,
                             EGS_Vector &x, EGS_Vector &u) {
-        int err = 1;
-        EGS_ControlPoint ipt;  //the actual rotation coords
+        EGS_AffineTransform T;
         EGS_I64 c;
-        while (err) {
+        for (;;) {
             c = source->getNextParticle(rndm,q,latch,E,wt,x,u);
             if (sync) {
                 pmu = source->getMu();
@@ -243,24 +246,28 @@ public:
             if (!sync) {
                 pmu = rndm->getUniform();
             }
-            err = getCoord(pmu,ipt);
+            if (table.getTransformation(pmu,T)) {
+                break;
+            }
+            egsWarning("EGS_DynamicSource: could not locate control point.\n");
         }
-
-        //translate source in Z
-        x.z=x.z-ipt.dsource;
-        //get the rotation matrices
-        ipt.phicol *= M_PI/180;
-        ipt.theta *= M_PI/180;
-        ipt.phi *= M_PI/180;
-        EGS_RotationMatrix Rcol(EGS_RotationMatrix::rotZ(ipt.phicol));
-        EGS_RotationMatrix Rtheta(EGS_RotationMatrix::rotY(ipt.theta));
-        EGS_RotationMatrix Rphi(EGS_RotationMatrix::rotZ(ipt.phi));
-        //apply rotations in specific order and then translate relative
-        //to the isocentre
-        u=Rphi*Rtheta*Rcol*u;
-        x=Rphi*Rtheta*Rcol*x + ipt.iso;
+        //rotate about the isocentre and translate the source to dsource
+        //from it
+        T.transform(x);
+        T.rotate(u);
         return c;
     };
+
+    /*! \brief Sample \a n particles into \a p
+
+      When the motion is not synchronized with the source, the particles
+      are sampled from the source with a single call to its
+      getNextParticles() method and the control point transformations
+      are applied in a loop over the block.
+    */
+    EGS_I64 getNextParticles(EGS_RandomGenerator *rndm, int n,
+                             EGS_ParticleBlock &p);
+
     EGS_Float getEmax() const {
         return source->getEmax();
     };
@@ -297,6 +304,8 @@ protected:
 
     vector<EGS_ControlPoint> cpts;  //control point
 
+    EGS_ControlPointTable table;  //!< interpolation table for the cpts
+
     int ncpts;  //no. of control points
 
     bool valid; //is this a valid source
@@ -304,7 +313,11 @@ protected:
     bool sync; //set to true if source motion synched with mu read from
     //iaea phsp or beam simulation source
 
-    int getCoord(const EGS_Float rand, EGS_ControlPoint &ipt);
+    /*! \brief Get the interpolated control point for \a rand.
+      Returns 1 if \a rand is outside of the control point range. */
+    int getCoord(const EGS_Float rand, EGS_ControlPoint &ipt) {
+        return table.getControlPoint(rand,ipt) ? 0 : 1;
+    };
 
     EGS_Float pmu; //monitor unit index corresponding to particle
     //could just be a random number.
@@ -44,8 +44,8 @@
 EGS_FanoSource::EGS_FanoSource(EGS_Input *input,
                                EGS_ObjectFactory *f) :
     EGS_BaseSimpleSource(input,f), shape(0), geom(0),
-    regions(0), nrs(0), min_theta(0), max_theta(M_PI), min_phi(0), max_phi(2*M_PI),
-    max_mass_density(0.0) {
+    regions(0), min_theta(0), max_theta(M_PI), min_phi(0), max_phi(2*M_PI),
+    max_mass_density(0.0), weighted(false), real_count(0), nrs(0) {
 
     vector<EGS_Float> pos;
     EGS_Input *ishape = input->takeInputItem("shape");
@@ -104,6 +104,11 @@ EGS_FanoSource::EGS_FanoSource(EGS_Input *input,
         max_phi = tmp_theta/180.0*M_PI;
     }
 
+    vector<string> sampling_options;
+    sampling_options.push_back("rejection");
+    sampling_options.push_back("weight");
+    weighted = input->getInput("density sampling",sampling_options,0) == 1;
+
     buf_1 = cos(min_theta);
     buf_2 = cos(max_theta);
 
@@ -136,6 +141,9 @@ void EGS_FanoSource::setUp() {
         str_density << scientific << max_mass_density;
         description += "\n maximum density = " + str_density.str() + "  g/cm3";
         description += "\n Fano geometry   = " + geom->getName();
+        if (weighted) {
+            description += "\n density sampling by particle weight";
+        }
         if (geom) {
             geom->ref();
         }
@@ -45,6 +45,8 @@
 #include "egs_base_geometry.h"
 #include "egs_math.h"
 
+#include <iomanip>
+
 
 #ifdef WIN32
 
@@ -88,8 +90,16 @@ It is defined using the following input
     charge = -1 or 0 or 1 for electrons or photons or positrons
     max mass density = 1.2
     geometry = some_name
+    density sampling = rejection or weight (optional)
 :stop source:
 \endverbatim
+With the default <code>density sampling = rejection</code>, points picked
+from the shape are accepted with probability
+\f$\rho/\rho_{\rm max}\f$. With <code>density sampling = weight</code>
+all points inside the geometry (except points in vacuum) are accepted
+and the particle weight is set to \f$\rho/\rho_{\rm max}\f$ instead. The
+fluence returned by getFluence() is then the sum of the weights, so that
+results are normalized in the same way in both modes.
 */
 
 class EGS_FANO_SOURCE_EXPORT EGS_FanoSource :
@@ -106,9 +116,9 @@ public:
                    EGS_BaseGeometry *geometry,
                    const string &Name="", EGS_ObjectFactory *f=0) :
         EGS_BaseSimpleSource(Q,Spec,Name,f), shape(Shape),
-        min_theta(85.), max_theta(95.), min_phi(0), max_phi(2*M_PI),
-        buf_1(1), buf_2(-1),
-        geom(geometry), regions(0), nrs(0) {
+        geom(geometry), regions(0), min_theta(85.), max_theta(95.),
+        buf_1(1), buf_2(-1), min_phi(0), max_phi(2*M_PI),
+        weighted(false), real_count(0), nrs(0) {
         setUp();
     };
 
@@ -139,27 +149,30 @@ public:
                 x = shape->getRandomPoint(rndm);
                 ok = geom->isInside(x);
                 if (ok) {
+                    EGS_Float rho = geom->getMediumRho(geom->medium(geom->isWhere(x)));
+                    if (weighted) {
+                        /*******************************************************
+                         * Rather than rejecting, accept always and adjust the
+                         * weight. Only points in vacuum (rho = 0) are rejected.
+                         *******************************************************/
+                        wt = rho/max_mass_density;
+                        okfano = wt > 0;
+                        if (okfano) {
+                            real_count += wt;
+                        }
+                    }
                     /*******************************************************************************
                      * Rejection technique generates particles proportional to the region's mass m.
                      * The joint probability of selecting the emission point is the product of the
                      * probability of the point being in volume V times the probability of surviving
                      * the rejection, which is proportional to the density in that volume.
                      *******************************************************************************/
-                    if (rndm->getUniform()*max_mass_density > geom->getMediumRho(geom->medium(geom->isWhere(x)))) {
+                    else if (rndm->getUniform()*max_mass_density > rho) {
                         okfano = false;
                     }
                     else {
                         okfano = true;
                     }
-
-                    /*********************************************************************
-                     * Rather than rejecting, accept always and adjust weight accordingly
-                     * A quick check didn't show improved efficiency as one would have expected!
-                     * Perhaps the extra calculations? One should have used the values above!
-                     *********************************************************************/
-                    //wt = wt * geom->getMediumRho(geom->medium(geom->isWhere(x)))/max_mass_density;
-                    //real_count += wt;
-                    //okfano = true;
                 }
             }
             while (!ok);
@@ -182,38 +195,44 @@ public:
         }
     };
 
+    /*! \brief Returns the number of particles, or the sum of the particle
+     * weights when density weighting is used.
+     */
     EGS_Float getFluence() const {
-        return count;
+        return weighted ? real_count : count;
     };
 
-    /**************************************************
-     * Related to the implementation without rejection
-     * To be further tested !!!
-     **************************************************/
-    //EGS_Float getFluence() const { return Fano_source ? real_count : count; };
-    /*
-        bool storeFluenceState(ostream & data) const {
-             if (Fano_source) data << real_count;
-             return Fano_source ? data.good() : true;
-        };
-
-        bool setFluenceState(istream & data) {
-          if (Fano_source) data >> real_count;
-          return Fano_source ? data.good() : true;
-        };
-
-        bool addFluenceData(istream &data) {
-             if (Fano_source){
-                EGS_Float tmp; data >> tmp;
-                if( !data.good() ) return false;
-                real_count += tmp;
-             }
-             return true;
-        };
-
-        void resetFluenceCounter() {real_count = 0.0; };
-    */
-    /*****************************************************/
+    bool storeFluenceState(ostream &data) const {
+        if (weighted) {
+            data << setprecision(16) << real_count << "  ";
+            return data.good();
+        }
+        return true;
+    };
+
+    bool setFluenceState(istream &data) {
+        if (weighted) {
+            data >> real_count;
+            return data.good();
+        }
+        return true;
+    };
+
+    bool addFluenceData(istream &data) {
+        if (weighted) {
+            double tmp;
+            data >> tmp;
+            if (!data.good()) {
+                return false;
+            }
+            real_count += tmp;
+        }
+        return true;
+    };
+
+    void resetFluenceCounter() {
+        real_count = 0;
+    };
 
     bool isValid() const {
         return (s != 0 && shape != 0);
@@ -230,8 +249,9 @@ protected:
     EGS_Float min_theta, max_theta;
     EGS_Float buf_1, buf_2;//! avoid multi-calculating cos(min_theta) and cos(max_theta)
     EGS_Float min_phi, max_phi;
-    //real_count;
     EGS_Float max_mass_density;
+    bool      weighted;   //!< weight by density instead of rejection
+    double    real_count; //!< sum of weights when \a weighted is true
     int                 nrs;
 };
 
@@ -56,6 +56,7 @@ void EGS_PhspSource::init() {
     Ymax = veryFar;
     is_valid = false;
     record = 0;
+    zfile = 0;
     mode2 = false;
     swap_bytes = false;
     the_file_name = "no file";
@@ -73,6 +74,7 @@ void EGS_PhspSource::init() {
     Nrecycle_e = 0;
     Nrecycle = 0;
     Nuse = -1;
+    recycle_symmetry = 0;
     first = true;
 }
 
@@ -87,6 +89,10 @@ void EGS_PhspSource::openFile(const string &phsp_file) {
         delete [] record;
         record = 0;
     }
+    if (zfile) {
+        delete zfile;
+        zfile = 0;
+    }
     the_file.open(phsp_file.c_str(),ios::binary | ios::in);
     if (!the_file.is_open()) {
         egsWarning("EGS_PhspSource::openFile: failed to open binary file %s"
@@ -112,6 +118,32 @@ void EGS_PhspSource::openFile(const string &phsp_file) {
         mode2 = true;
         recl = 32;
     }
+    else if (cmode == "EGSPH") {
+        // a compressed phase space file, particles are read by index
+        the_file.close();
+        zfile = new EGS_CompressedPhspReader;
+        if (!zfile->open(phsp_file) || zfile->getInfo().nparticle < 1) {
+            egsWarning("EGS_PhspSource::openFile: failed to open the "
+                       "compressed phase space file %s\n",phsp_file.c_str());
+            delete zfile;
+            zfile = 0;
+            return;
+        }
+        const EGS_CompressedPhspInfo &zinfo = zfile->getInfo();
+        mode2 = false;
+        recl = 28;
+        Npos = 0;
+        Nlast = zinfo.nparticle;
+        Nfirst = 1;
+        Emax = zinfo.emax;
+        Emin = zinfo.emin;
+        Pinc = zinfo.pinc;
+        Nparticle = zinfo.nparticle;
+        Nphoton = zinfo.nphoton;
+        is_valid = true;
+        the_file_name = phsp_file;
+        return;
+    }
     else {
         egsWarning("EGS_PhspSource::openFile: the file %s is not a MODE0 or"
                    " MODE2 file\n",phsp_file.c_str());
@@ -278,11 +310,27 @@ EGS_PhspSource::EGS_PhspSource(EGS_Input *input, EGS_ObjectFactory *f) :
             Nrecycle_e = ntmp;
         }
     }
+    vector<string> sym_options;
+    sym_options.push_back("none");
+    sym_options.push_back("rotation");
+    sym_options.push_back("reflection");
+    sym_options.push_back("rotation and reflection");
+    recycle_symmetry = input->getInput("recycle symmetry",sym_options,0);
+    if (recycle_symmetry && !Nrecycle_g && !Nrecycle_e) {
+        egsWarning("EGS_PhspSource: 'recycle symmetry' has no effect without"
+                   " 'recycle photons' or 'recycle electrons'\n");
+    }
     description = "Phase space source from ";
     description += the_file_name;
+    if (recycle_symmetry && (Nrecycle_g || Nrecycle_e)) {
+        description += "\n  recycled particles are ";
+        description += recycle_symmetry == 1 ? "rotated about the z-axis" :
+                       recycle_symmetry == 2 ? "reflected about the x- and y-axes" :
+                       "rotated about the z-axis and reflected";
+    }
 }
 
-EGS_I64 EGS_PhspSource::getNextParticle(EGS_RandomGenerator *, int &q,
+EGS_I64 EGS_PhspSource::getNextParticle(EGS_RandomGenerator *rndm, int &q,
                                         int &latch, EGS_Float &E, EGS_Float &wt, EGS_Vector &x, EGS_Vector &u) {
     if (!recl) egsFatal("EGS_PhspSource::readParticle(): the file is not "
                             "open yet\n");
@@ -314,7 +362,31 @@ EGS_I64 EGS_PhspSource::getNextParticle(EGS_RandomGenerator *, int &q,
         u.z = -aux;
         wt = -p.wt;
     }
-    if (rejectParticle()) {
+    if (Nuse > 0 && recycle_symmetry) {
+        // a recycled particle: apply a random symmetry operation
+        if (recycle_symmetry & 1) {
+            EGS_Float cphi, sphi;
+            rndm->getAzimuth(cphi,sphi);
+            EGS_Float tmp = x.x*cphi - x.y*sphi;
+            x.y = x.x*sphi + x.y*cphi;
+            x.x = tmp;
+            tmp = u.x*cphi - u.y*sphi;
+            u.y = u.x*sphi + u.y*cphi;
+            u.x = tmp;
+        }
+        if (recycle_symmetry & 2) {
+            if (rndm->getUniform() < 0.5) {
+                x.x = -x.x;
+                u.x = -u.x;
+            }
+            if (rndm->getUniform() < 0.5) {
+                x.y = -x.y;
+                u.y = -u.y;
+            }
+        }
+    }
+    if (rejectParticle() ||
+            x.x < Xmin || x.x > Xmax || x.y < Ymin || x.y > Ymax) {
         wt = 0;
     }
     E = p.E;
@@ -346,25 +418,16 @@ void EGS_PhspSource::setSimulationChunk(EGS_I64 nstart, EGS_I64 nrun) {
     Nfirst = nstart+1;
     Nlast = nstart + nrun;
     Npos = nstart;
-    istream::off_type pos = Nfirst*recl;
-    the_file.seekg(pos,ios::beg);
+    if (!zfile) {
+        istream::off_type pos = Nfirst*recl;
+        the_file.seekg(pos,ios::beg);
+    }
     egsInformation("EGS_PhspSource: using phsp portion between %lld and %lld\n",
                    Nfirst,Nlast);
 }
 
-void EGS_PhspSource::readParticle() {
-    if ((++Npos) > Nlast) {
-        egsWarning("EGS_PhspSource::readParticle(): reached the end of the "
-                   "phase space file chunk (%lld)\n  will start from the beginning "
-                   "of the chunk (%lld) but this "
-                   "implies that uncertainty estimates will be inaccurate\n",
-                   Nlast,Nfirst);
-        the_file.seekg(recl,ios::beg);
-        Nrestart++;
-        Npos = Nfirst;
-    }
+void EGS_PhspSource::readRecord() {
     the_file.read(record,recl*sizeof(char));
-    ++Nread;
     if (the_file.eof() || !the_file.good())
         egsFatal("EGS_PhspSource::readParticle(): I/O error while reading "
                  "phase space file\n");
@@ -392,6 +455,38 @@ void EGS_PhspSource::readParticle() {
         egsSwapBytes(&p.u);
         egsSwapBytes(&p.v);
     }
+}
+
+void EGS_PhspSource::readParticle() {
+    if ((++Npos) > Nlast) {
+        egsWarning("EGS_PhspSource::readParticle(): reached the end of the "
+                   "phase space file chunk (%lld)\n  will start from the beginning "
+                   "of the chunk (%lld) but this "
+                   "implies that uncertainty estimates will be inaccurate\n",
+                   Nlast,Nfirst);
+        if (!zfile) {
+            the_file.seekg(recl,ios::beg);
+        }
+        Nrestart++;
+        Npos = Nfirst;
+    }
+    ++Nread;
+    if (zfile) {
+        EGS_PhspRecord r;
+        if (!zfile->getParticle(Npos-1,r))
+            egsFatal("EGS_PhspSource::readParticle(): I/O error while reading "
+                     "compressed phase space file\n");
+        p.latch = r.latch;
+        p.E = r.E;
+        p.x = r.x;
+        p.y = r.y;
+        p.u = r.u;
+        p.v = r.v;
+        p.wt = r.wt;
+    }
+    else {
+        readRecord();
+    }
     if (p.latch & 1073741824) {
         p.q = -1;
     }
@@ -427,9 +522,6 @@ bool EGS_PhspSource::rejectParticle() const {
     if (particle_type == 3 && !p.q) {
         return true;
     }
-    if (p.x < Xmin || p.x > Xmax || p.y < Ymin || p.y > Ymax) {
-        return true;
-    }
     if (p.wt < wmin || p.wt > wmax) {
         return true;
     }
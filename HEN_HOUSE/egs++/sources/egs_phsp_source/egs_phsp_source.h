@@ -42,6 +42,7 @@
 #include "egs_base_source.h"
 #include "egs_rndm.h"
 #include "egs_alias_table.h"
+#include "egs_compressed_phsp.h"
 
 #include <fstream>
 using namespace std;
@@ -74,6 +75,13 @@ using namespace std;
 A phase-space file source reads and delivers particles from a
 BEAMnrc phase-space file. Because the phase-space file
 only contains the x- and y- positions, the z-position is set to 0.
+Besides MODE0 and MODE2 files, the source can also read compressed
+phase-space files (\c .egsphspz, see EGS_CompressedPhspWriter), e.g.
+generated with the \c egs_phsp_scoring ausgab object.
+The file format is detected automatically. Because compressed files
+are stored in independent blocks with an index, jumping to the portion
+of the file used by a parallel job only requires decompressing a single
+block.
 A phase-space file source is defined as follows:
 \verbatim
 :start source:
@@ -85,6 +93,8 @@ A phase-space file source is defined as follows:
     weight window = wmin wmax, the min and max particle weights to use. If the particle weight is not in this range, it is rejected. (optional)
     recycle photons = number of times to recycle each photon (optional)
     recycle electrons = number of times to recycle each electron (optional)
+    recycle symmetry = none or rotation or reflection
+                       or rotation and reflection (optional)
 :stop source:
 \endverbatim
 The optional \c cutout key permits to set a rectangular cutout
@@ -94,7 +104,21 @@ defined by its upper-left and lower-right corners <code>x1,y1</code> and
 The <code>particle type</code> key permits to select a subset of particles
 based on the particle charge. No filters based on the value of the
 \c latch variable are implemented yet but such filters will be added
-in future versions of the library. Note that a phase-space source
+in future versions of the library.
+
+With the \c recycle keys each particle read from the file is delivered
+several times with its weight divided accordingly. By default the
+recycled particles are identical copies, so that recycling reduces the
+I/O per history but not the latent variance of the phase-space file.
+If the beam is symmetric, the optional <code>recycle symmetry</code> key
+applies a random symmetry operation to each reuse of a particle: a
+rotation of the position and direction by a random angle about the
+z-axis (\c rotation), random reflections about the x- and y-axes
+(\c reflection), or both. The first use of a particle is always the
+particle as stored in the file. The cutout is applied after the symmetry
+operation.
+
+Note that a phase-space source
 can be used as the source in a
 \link EGS_TransformedSource transformed source \endlink permitting in this way
 arbitrary transformations to be applied to the particle positions and
@@ -141,7 +165,11 @@ public:
     Construct a phase-space file source from the information pointed to by
     \a inp. */
     EGS_PhspSource(EGS_Input *, EGS_ObjectFactory *f=0);
-    ~EGS_PhspSource() { };
+    ~EGS_PhspSource() {
+        if (zfile) {
+            delete zfile;
+        }
+    };
 
     EGS_I64 getNextParticle(EGS_RandomGenerator *rndm,
                             int &q, int &latch, EGS_Float &E, EGS_Float &wt,
@@ -201,7 +229,9 @@ public:
         if (!res) {
             return res;
         }
-        the_file.seekg((Npos+1)*recl,ios::beg);
+        if (!zfile) {
+            the_file.seekg((Npos+1)*recl,ios::beg);
+        }
         res = egsGetI64(data,count);
         return res;
     };
@@ -240,6 +270,7 @@ protected:
     bool        swap_bytes;    /*!< \c true, if phase-space file was generated
                                 on a CPU with different endianness */
     char       *record;        //!< Memory to read a particle into
+    EGS_CompressedPhspReader *zfile; //!< The reader, if a compressed file
     EGS_Float   Emax,    //!< Maximum energy (obtained from the phsp file)
                 Emin,    //!< Minimum energy (obtained from the phsp file)
                 Pinc;    //!< Number of incident particles that created the file
@@ -256,6 +287,9 @@ protected:
     int         Nrecycle_e;  //!< Number of times to recycle a charged particle
     int         Nrecycle;    //!< Number of times to recycle current particle
     int         Nuse;      //!< Number of times current particle was used so far
+    int         recycle_symmetry; /*!< Symmetry operations applied to recycled
+                                   particles: 1 = rotation, 2 = reflection,
+                                   3 = both */
 
     bool        first;
 
@@ -278,6 +312,7 @@ protected:
 #endif
 
     inline void readParticle();
+    void readRecord();
     inline bool rejectParticle() const;
 
 };
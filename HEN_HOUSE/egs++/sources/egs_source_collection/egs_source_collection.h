@@ -160,6 +160,37 @@ public:
         last_cases[j] = this_case;
         return count;
     };
+    /*! \brief Sample the next \a n particles into \a pb
+
+      The sources of all particles are sampled first and then each source
+      is asked for all its particles at once. The particles are returned
+      in the order in which their sources were sampled.
+    */
+    EGS_I64 getNextParticles(EGS_RandomGenerator *rndm, int n,
+                             EGS_ParticleBlock &pb) {
+        which.resize(n);
+        nper.assign(nsource,0);
+        for (int i=0; i<n; i++) {
+            which[i] = table->sample(rndm);
+            ++nper[which[i]];
+        }
+        blocks.resize(nsource);
+        for (int j=0; j<nsource; j++) {
+            if (nper[j] > 0) {
+                sources[j]->getNextParticles(rndm,nper[j],blocks[j]);
+            }
+        }
+        pb.resize(n);
+        nper.assign(nsource,0);
+        for (int i=0; i<n; i++) {
+            int j = which[i], k = nper[j]++;
+            pb.copy(i,blocks[j],k);
+            count += blocks[j].ncase[k] - last_cases[j];
+            last_cases[j] = blocks[j].ncase[k];
+            pb.ncase[i] = count;
+        }
+        return count;
+    };
     EGS_Float getEmax() const {
         return Emax;
     };
@@ -260,6 +291,11 @@ protected:
     EGS_Float Emax;            //!< Maximum energy (max of s[j]->getEmax()).
     EGS_I64        count;      //!< Independent particles delivered
 
+    // work space for getNextParticles()
+    vector<int>               which;  //!< Source of each particle
+    vector<int>               nper;   //!< Particles per source
+    vector<EGS_ParticleBlock> blocks; //!< Particles from each source
+
     void setUp(const vector<EGS_BaseSource *> &S, const vector<EGS_Float> &);
 
 };
@@ -163,6 +163,15 @@ public:
         }
         return c;
     };
+    EGS_I64 getNextParticles(EGS_RandomGenerator *rndm, int n,
+                             EGS_ParticleBlock &p) {
+        EGS_I64 c = source->getNextParticles(rndm,n,p);
+        if (T) {
+            T->rotate(n,&p.u[0],&p.v[0],&p.w[0]);
+            T->transform(n,&p.x[0],&p.y[0],&p.z[0]);
+        }
+        return c;
+    };
     EGS_Float getEmax() const {
         return source->getEmax();
     };
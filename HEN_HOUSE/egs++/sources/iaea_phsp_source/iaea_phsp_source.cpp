@@ -71,6 +71,8 @@ void IAEA_PhspSource::init() {
     Nrecycle = 0;
     Nuse = -1;
     first = true;
+    buf_size = 1024;
+    resetBuffer();
 }
 
 void IAEA_PhspSource::openFile(const string &phsp_file) {
@@ -302,6 +304,10 @@ IAEA_PhspSource::IAEA_PhspSource(EGS_Input *input, EGS_ObjectFactory *f) :
             Nrecycle_e = ntmp;
         }
     }
+    err = input->getInput("buffer size",ntmp);
+    if (!err && ntmp > 0) {
+        buf_size = ntmp;
+    }
     description = "IAEA phase space source from ";
     description += the_file_name;
 }
@@ -313,8 +319,7 @@ EGS_I64 IAEA_PhspSource::getNextParticle(EGS_RandomGenerator *, int &q,
         do { readParticle(); } while ( rejectParticle() );
     }
     */
-    int nstat,extrainttemp[MAXEXTRAS];
-    float extrafloattemp[MAXEXTRAS];
+    int nstat;
     if (Nuse > Nrecycle || Nuse < 0) {  //get a new particle
         if ((++Npos) > Nlast) {
             egsWarning("IAEA_PhspSource::getNextParticle(): reached the end of the "
@@ -326,22 +331,36 @@ EGS_I64 IAEA_PhspSource::getNextParticle(EGS_RandomGenerator *, int &q,
             if (iaea_iostat<0) {
                 egsFatal("IAEA_PhspSource::getNextParticle(): error restarting phase space chunk\n");
             }
+            resetBuffer();
             Nrestart++;
             Npos = Nfirst;
         }
-        iaea_get_particle(&iaea_fileid,&nstat,&p.q,&p.E,&p.wt,&p.x,&p.y,&p.z,&p.u,&p.v,&p.w,extrafloattemp,extrainttemp);
+        if (buf_pos >= buf_n) {
+            readBuffer();
+        }
+        int j = buf_pos++;
+        nstat = b_nstat[j];
+        p.q = b_type[j];
+        p.E = b_E[j];
+        p.wt = b_wt[j];
+        p.x = b_x[j];
+        p.y = b_y[j];
+        p.z = b_z[j];
+        p.u = b_u[j];
+        p.v = b_v[j];
+        p.w = b_w[j];
         ++Nread;
         p.latch=0; //important if we are using latch to do vr
         /*
         if (latch_stored) {
-            p.latch = extrainttemp[i_latch];
+            p.latch = b_extralong[j*n_extra_longs+i_latch];
         }
         */
         if (mode2) {
-            p.zlast = extrafloattemp[i_zlast];
+            p.zlast = b_extrafloat[j*n_extra_floats+i_zlast];
         }
         if (mu_stored) {
-            p.mu = extrafloattemp[i_mu];
+            p.mu = b_extrafloat[j*n_extra_floats+i_mu];
         }
         if (swap_bytes) {
             egsSwapBytes(&p.q);
@@ -423,6 +442,35 @@ union __egs_data32 {
 };
 #endif
 
+void IAEA_PhspSource::readBuffer() {
+    // read at most up to the end of the chunk
+    EGS_I64 nleft = Nlast - Npos + 1;
+    int n = nleft < buf_size ? nleft : buf_size;
+    if (b_E.size() < (size_t)buf_size) {
+        b_nstat.resize(buf_size);
+        b_type.resize(buf_size);
+        b_E.resize(buf_size);
+        b_wt.resize(buf_size);
+        b_x.resize(buf_size);
+        b_y.resize(buf_size);
+        b_z.resize(buf_size);
+        b_u.resize(buf_size);
+        b_v.resize(buf_size);
+        b_w.resize(buf_size);
+        b_extrafloat.resize(buf_size*(n_extra_floats > 0 ? n_extra_floats : 1));
+        b_extralong.resize(buf_size*(n_extra_longs > 0 ? n_extra_longs : 1));
+    }
+    int nread;
+    iaea_get_particles(&iaea_fileid,&n,&nread,&b_nstat[0],&b_type[0],&b_E[0],
+                       &b_wt[0],&b_x[0],&b_y[0],&b_z[0],&b_u[0],&b_v[0],&b_w[0],
+                       &b_extrafloat[0],&b_extralong[0]);
+    if (nread < 1) {
+        egsFatal("IAEA_PhspSource::readBuffer(): error reading particle number %lld\n",Npos);
+    }
+    buf_n = nread;
+    buf_pos = 0;
+}
+
 void IAEA_PhspSource::setSimulationChunk(EGS_I64 nstart, EGS_I64 nrun) {
     if (nstart < 0 || nrun < 1 || nstart + nrun > Nparticle) {
         egsWarning("IAEA_PhspSource::setSimulationChunk(): illegal attempt "
@@ -434,6 +482,7 @@ void IAEA_PhspSource::setSimulationChunk(EGS_I64 nstart, EGS_I64 nrun) {
     Nlast = nstart + nrun;
     Npos = nstart;
     iaea_set_record(&iaea_fileid,&Nfirst,&iaea_iostat);
+    resetBuffer();
     if (iaea_iostat<0) {
         egsWarning("IAEA_PhspSource::setSimulationChunk(): error setting phase space chunk\n");
         return;
@@ -91,6 +91,8 @@ An IAEA phase-space file source is defined as follows:
     weight window = wmin wmax, the min and max particle weights to use. If the particle weight is not in this range, it is rejected. (optional)
     recycle photons = number of times to recycle each photon (optional)
     recycle electrons = number of times to recycle each electron (optional)
+    buffer size = number of particles read from the file at once (optional,
+                  default is 1024)
 :stop source:
 \endverbatim
 The optional \c cutout key permits to set a rectangular cutout
@@ -217,6 +219,7 @@ public:
         }
         Npos++;
         iaea_set_record(&iaea_fileid,&Npos,&iaea_iostat);
+        resetBuffer();
         res = egsGetI64(data,count);
         return res;
     };
@@ -279,6 +282,22 @@ protected:
 
     bool        first;
 
+    /* particles are read from the file buf_size at a time into these
+       arrays using the bulk IAEA API */
+    int           buf_size;  //!< Number of particles read at once
+    int           buf_n;     //!< Number of particles in the buffer
+    int           buf_pos;   //!< Next particle in the buffer
+    vector<int>   b_nstat, b_type, b_extralong;
+    vector<float> b_E, b_wt, b_x, b_y, b_z, b_u, b_v, b_w, b_extrafloat;
+
+    /*! \brief Read the next particles of the chunk into the buffer */
+    void readBuffer();
+    /*! \brief Discard the buffer content (after repositioning the file) */
+    void resetBuffer() {
+        buf_n = 0;
+        buf_pos = 0;
+    };
+
     // filters
     int         particle_type;
     int         filter_type;
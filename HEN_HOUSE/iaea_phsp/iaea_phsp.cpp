@@ -1156,41 +1156,16 @@ void IAEA_SET_RECORD__(const IAEA_I32 *id,
 { iaea_set_record(id, record_num, is_ok); }
 
 /**************************************************************************
-* Get a particle
-*
-* Return the next particle from the sequence of particles from source
-* with Id id. Set n_stat to the number of statistically independent
-* events since the last call to this function (i.e. n_stat = 0, if
-* the particle resulted from the same incident electron, n_stat = 377
-* if there were 377 statistically independent events sinc the last particle
-* returned, etc.). If this information is not available,
-* simply set n_stat to 1 if the particle belongs to a new statistically
-* independent event. Set n_stat to -1, if a source with Id id does not
-* exist. Set n_stat to -2, if end of file of the phase space source reached
-
+* Copy the particle currently stored in the record of source id into the
+* output variables and update the header counters. Used by
+* iaea_get_particle and iaea_get_particles.
 **************************************************************************/
-IAEA_EXTERN_C IAEA_EXPORT
-void iaea_get_particle(const IAEA_I32 *id, IAEA_I32 *n_stat,
-IAEA_I32 *type, /* particle type */
-IAEA_Float *E,  /* kinetic energy in MeV */
-IAEA_Float *wt, /* statistical weight */
-IAEA_Float *x,
-IAEA_Float *y,
-IAEA_Float *z,  /* position in cartesian coordinates*/
-IAEA_Float *u,
-IAEA_Float *v,
-IAEA_Float *w,  /* direction in cartesian coordinates*/
-IAEA_Float *extra_floats,
-IAEA_I32 *extra_ints)
+static void iaea_copy_particle(const IAEA_I32 *id, IAEA_I32 *n_stat,
+IAEA_I32 *type, IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
 {
-      if(feof(p_iaea_record[*id]->p_file)) {
-         *n_stat = -2;
-         rewind (p_iaea_record[*id]->p_file);
-         return;
-      }
-
-      if( p_iaea_record[*id]->read_particle() == FAIL ) { *n_stat = -1; return;}
-
       iaea_record_type *p = p_iaea_record[*id];
 
       // Corrected on Dec. 2006. Before n_stat was not assigned if
@@ -1251,6 +1226,47 @@ IAEA_I32 *extra_ints)
 
       return;
 }
+
+/**************************************************************************
+* Get a particle
+*
+* Return the next particle from the sequence of particles from source
+* with Id id. Set n_stat to the number of statistically independent
+* events since the last call to this function (i.e. n_stat = 0, if
+* the particle resulted from the same incident electron, n_stat = 377
+* if there were 377 statistically independent events sinc the last particle
+* returned, etc.). If this information is not available,
+* simply set n_stat to 1 if the particle belongs to a new statistically
+* independent event. Set n_stat to -1, if a source with Id id does not
+* exist. Set n_stat to -2, if end of file of the phase space source reached
+
+**************************************************************************/
+IAEA_EXTERN_C IAEA_EXPORT
+void iaea_get_particle(const IAEA_I32 *id, IAEA_I32 *n_stat,
+IAEA_I32 *type, /* particle type */
+IAEA_Float *E,  /* kinetic energy in MeV */
+IAEA_Float *wt, /* statistical weight */
+IAEA_Float *x,
+IAEA_Float *y,
+IAEA_Float *z,  /* position in cartesian coordinates*/
+IAEA_Float *u,
+IAEA_Float *v,
+IAEA_Float *w,  /* direction in cartesian coordinates*/
+IAEA_Float *extra_floats,
+IAEA_I32 *extra_ints)
+{
+      if(feof(p_iaea_record[*id]->p_file)) {
+         *n_stat = -2;
+         rewind (p_iaea_record[*id]->p_file);
+         return;
+      }
+
+      if( p_iaea_record[*id]->read_particle() == FAIL ) { *n_stat = -1; return;}
+
+      iaea_copy_particle(id, n_stat, type, E, wt, x, y, z, u, v, w,
+                         extra_floats, extra_ints);
+      return;
+}
 IAEA_EXTERN_C IAEA_EXPORT
 void iaea_get_particle_(const IAEA_I32 *id, IAEA_I32 *n_stat,
 IAEA_I32 *type, /* particle type */
@@ -1327,6 +1343,114 @@ IAEA_I32 *extra_ints)
 { iaea_get_particle(id, n_stat, type,
                                 E, wt, x, y, z, u, v, w, extra_floats, extra_ints); }
 
+/**************************************************************************
+* Get many particles
+*
+* Read up to n particles from source with Id id into the arrays n_stat,
+* type, E, wt, x, y, z, u, v and w (each of dimension n). The extra floats
+* and longs of particle i are stored in extra_floats[i*nf+k] and
+* extra_ints[i*nl+k], where nf and nl are the numbers of extra floats and
+* longs returned by iaea_get_extra_numbers. The meaning of the returned
+* quantities is the same as for iaea_get_particle, but the records are
+* read from the file with a single fread. Set n_read to the number of
+* particles read (which is less than n, if the end of the file was
+* reached), to -1 if the source with Id id does not exist or a read
+* error occured, and to -2 if the end of file of the phase space source
+* was reached before reading any particles (the file is then rewound).
+**************************************************************************/
+IAEA_EXTERN_C IAEA_EXPORT
+void iaea_get_particles(const IAEA_I32 *id, const IAEA_I32 *n, IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
+{
+      if(*id < 0 || *id >= MAX_NUM_SOURCES || p_iaea_record[*id] == NULL ||
+         p_iaea_record[*id]->p_file == NULL) {
+         *n_read = -1;
+         return;
+      }
+      *n_read = 0;
+      if(*n <= 0) return;
+
+      iaea_record_type *p = p_iaea_record[*id];
+      size_t reclength = p->record_length();
+      char *buffer = (char *) malloc((size_t)*n * reclength);
+      if(buffer == NULL) { *n_read = -1; return; }
+
+      size_t nrec = fread(buffer, reclength, (size_t)*n, p->p_file);
+      if(nrec == 0) {
+         free(buffer);
+         if(feof(p->p_file)) {
+            *n_read = -2;
+            rewind (p->p_file);
+         }
+         else *n_read = -1;
+         return;
+      }
+
+      int nf = p->iextrafloat > 0 ? p->iextrafloat : 0;
+      int nl = p->iextralong > 0 ? p->iextralong : 0;
+      for(size_t i=0; i<nrec; i++) {
+         if( p->decode_particle(buffer + i*reclength) == FAIL ) {
+            free(buffer);
+            *n_read = -1;
+            return;
+         }
+         iaea_copy_particle(id, n_stat+i, type+i, E+i, wt+i, x+i, y+i, z+i,
+                            u+i, v+i, w+i, extra_floats+i*nf, extra_ints+i*nl);
+      }
+      free(buffer);
+      *n_read = (IAEA_I32) nrec;
+      return;
+}
+IAEA_EXTERN_C IAEA_EXPORT
+void iaea_get_particles_(const IAEA_I32 *id, const IAEA_I32 *n, IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
+{ iaea_get_particles(id, n, n_read, n_stat, type,
+                E, wt, x, y, z, u, v, w, extra_floats, extra_ints); }
+IAEA_EXTERN_C IAEA_EXPORT
+void iaea_get_particles__(const IAEA_I32 *id, const IAEA_I32 *n, IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
+{ iaea_get_particles(id, n, n_read, n_stat, type,
+                E, wt, x, y, z, u, v, w, extra_floats, extra_ints); }
+IAEA_EXTERN_C IAEA_EXPORT
+void IAEA_GET_PARTICLES(const IAEA_I32 *id, const IAEA_I32 *n, IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
+{ iaea_get_particles(id, n, n_read, n_stat, type,
+                E, wt, x, y, z, u, v, w, extra_floats, extra_ints); }
+IAEA_EXTERN_C IAEA_EXPORT
+void IAEA_GET_PARTICLES_(const IAEA_I32 *id, const IAEA_I32 *n, IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
+{ iaea_get_particles(id, n, n_read, n_stat, type,
+                E, wt, x, y, z, u, v, w, extra_floats, extra_ints); }
+IAEA_EXTERN_C IAEA_EXPORT
+void IAEA_GET_PARTICLES__(const IAEA_I32 *id, const IAEA_I32 *n, IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E, IAEA_Float *wt,
+IAEA_Float *x, IAEA_Float *y, IAEA_Float *z,
+IAEA_Float *u, IAEA_Float *v, IAEA_Float *w,
+IAEA_Float *extra_floats, IAEA_I32 *extra_ints)
+{ iaea_get_particles(id, n, n_read, n_stat, type,
+                E, wt, x, y, z, u, v, w, extra_floats, extra_ints); }
+
 /**************************************************************************
 * Write a particle
 * n_stat = 0 for a secondary particle
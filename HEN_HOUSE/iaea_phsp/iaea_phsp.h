@@ -346,6 +346,36 @@ IAEA_Float *w,  /* direction in cartesian coordinates*/
 IAEA_Float *extra_floats,
 IAEA_I32 *extra_ints);
 
+/**************************************************************************
+* Get many particles
+*
+* Read up to n particles from source with Id id into the arrays n_stat,
+* type, E, wt, x, y, z, u, v and w (each of dimension n). The extra floats
+* and longs of particle i are stored in extra_floats[i*nf+k] and
+* extra_ints[i*nl+k], where nf and nl are the numbers of extra floats and
+* longs returned by iaea_get_extra_numbers. The meaning of the returned
+* quantities is the same as for iaea_get_particle, but the records are
+* read from the file with a single fread. Set n_read to the number of
+* particles read (which is less than n, if the end of the file was
+* reached), to -1 if the source with Id id does not exist or a read
+* error occured, and to -2 if the end of file of the phase space source
+* was reached before reading any particles (the file is then rewound).
+**************************************************************************/
+IAEA_EXTERN_C IAEA_EXPORT
+void iaea_get_particles(const IAEA_I32 *id, const IAEA_I32 *n,
+IAEA_I32 *n_read,
+IAEA_I32 *n_stat, IAEA_I32 *type,
+IAEA_Float *E,  /* kinetic energies in MeV */
+IAEA_Float *wt, /* statistical weights */
+IAEA_Float *x,
+IAEA_Float *y,
+IAEA_Float *z,  /* positions in cartesian coordinates*/
+IAEA_Float *u,
+IAEA_Float *v,
+IAEA_Float *w,  /* directions in cartesian coordinates*/
+IAEA_Float *extra_floats,
+IAEA_I32 *extra_ints);
+
 /**************************************************************************
 * Write a particle
 * n_stat = 0 for a secondary particle
@@ -43,6 +43,7 @@
 #include <iostream>  // so that namespace std becomes defined
 #endif
 #include <math.h>
+#include <string.h>
 
 using namespace std;
 
@@ -154,21 +155,51 @@ short iaea_record_type::write_particle()
   return(OK);
 }
 
+short iaea_record_type::record_length()
+{
+  int rec_to_read = 1;    // energy is always read
+
+  if(ix > 0) rec_to_read++;
+  if(iy > 0) rec_to_read++;
+  if(iz > 0) rec_to_read++;
+  if(iu > 0) rec_to_read++;
+  if(iv > 0) rec_to_read++;
+  if(iweight > 0) rec_to_read++;
+  if(iextrafloat>0) rec_to_read += iextrafloat;
+
+  // particle type + floats + longs
+  return (short) (sizeof(char) + rec_to_read*sizeof(float) +
+                  (iextralong > 0 ? iextralong : 0)*sizeof(IAEA_I32));
+}
+
 short iaea_record_type::read_particle()
 {
-  float floatArray[NUM_EXTRA_FLOAT+7];
-  IAEA_I32 longArray[NUM_EXTRA_LONG+7];
-  int i,j,is,reclength;
-  char ctmp;
+  char buffer[sizeof(char) + (NUM_EXTRA_FLOAT+7)*sizeof(float) +
+              NUM_EXTRA_LONG*sizeof(IAEA_I32)];
+  short reclength = record_length();
 
   // IAEA_I32 pos = ftell(p_file); // To check file position
 
-  if( fread(&ctmp, sizeof(char),   1, p_file) != 1) // particle type is always read
+  if( fread(buffer, (size_t)reclength, 1, p_file) != 1)
   {
-    fprintf(stderr, "\n ERROR: read_particle: Failed to read particle type\n");
-    return (FAIL);;
+    fprintf(stderr, "\n ERROR: read_particle: Failed to read particle\n");
+    return (FAIL);
   }
 
+  return decode_particle(buffer);
+}
+
+short iaea_record_type::decode_particle(const char *record)
+{
+  float floatArray[NUM_EXTRA_FLOAT+7];
+  int i,j,is,reclength;
+  char ctmp;
+
+  // The record is decoded from memory so that many particles can be
+  // read from the file with a single fread (see iaea_get_particles)
+
+  ctmp = record[0];   // particle type is always read
+
   particle = (short) ctmp;
 
   is = 1; // getting sign of Z director cosine w
@@ -185,11 +216,7 @@ short iaea_record_type::read_particle()
   if(iweight > 0) rec_to_read++;
   if(iextrafloat>0) rec_to_read += iextrafloat;
 
-  if( fread(floatArray, sizeof(float), rec_to_read, p_file) != rec_to_read)
-  {
-    fprintf(stderr, "\n ERROR: read_particle: Failed to read FLOATs \n");
-    return (FAIL);;
-  }
+  memcpy(floatArray, record + reclength, rec_to_read*sizeof(float));
 
   reclength += rec_to_read*sizeof(float);
 
@@ -222,12 +249,7 @@ short iaea_record_type::read_particle()
 
   if(iextralong > 0)
   {
-     if( fread(longArray, sizeof(IAEA_I32), (size_t)iextralong, p_file) != (size_t)iextralong)
-     {
-       fprintf(stderr, "\n ERROR: read_particle: Failed to read LONGS\n");
-       return (FAIL);
-     }
-     for(int l=0,j=0;j<iextralong;j++) extralong[j] = longArray[l++];
+     memcpy(extralong, record + reclength, iextralong*sizeof(IAEA_I32));
      reclength += (iextralong)*sizeof(IAEA_I32);
   }
 
@@ -59,6 +59,8 @@ struct iaea_record_type
 
 public:
       short read_particle();
+      short decode_particle(const char *record);
+      short record_length();
       short write_particle();
       short initialize();
 };
@@ -38,6 +38,7 @@
 
 
 #include "egs_interface2.h"
+#include <string.h>
 
 static int n_arg = 0;
 static char **args = 0;
@@ -54,6 +55,7 @@ extern __extc__ struct EGS_IO F77_OBJ_(egs_io,EGS_IO);
 extern __extc__ struct EGS_VarianceReduction F77_OBJ_(egs_vr,EGS_VR);
 extern __extc__ struct EGS_Rayleigh F77_OBJ_(rayleigh_inputs,RAYLEIGH_INPUTS);
 extern __extc__ struct EGS_emfInputs F77_OBJ_(emf_inputs,EMF_INPUTS);
+extern __extc__ struct EGS_Random F77_OBJ(randomm,RANDOMM);
 
 struct EGS_Stack        *the_stack     = & F77_OBJ(stack,STACK);
 struct EGS_Bounds       *the_bounds    = & F77_OBJ(bounds,BOUNDS);
@@ -67,6 +69,7 @@ struct EGS_IO           *the_egsio     = & F77_OBJ_(egs_io,EGS_IO);
 struct EGS_VarianceReduction *the_egsvr = & F77_OBJ_(egs_vr,EGS_VR);
 struct EGS_Rayleigh     *the_rayleigh   = & F77_OBJ_(rayleigh_inputs,RAYLEIGH_INPUTS);
 struct EGS_emfInputs    *the_emf        = & F77_OBJ_(emf_inputs,EMF_INPUTS);
+struct EGS_Random       *the_rng        = & F77_OBJ(randomm,RANDOMM);
 
 extern __extc__ void F77_OBJ_(egs_init_f,EGS_INIT_F)();
 extern __extc__ void F77_OBJ(electr,ELECTR)(int *);
@@ -97,3 +100,24 @@ extern __extc__ void egsShower() {
     np = the_stack->np-1;
   }
 }
+
+/* State used by egs_hatch_copy() while egsHatchData() is running */
+static char    *hatch_data = 0;
+static EGS_I64  hatch_pos = 0;
+static int      hatch_iop = 0;
+
+extern __extc__ void F77_OBJ_(egs_hatch_data,EGS_HATCH_DATA)();
+
+extern __extc__ void F77_OBJ_(egs_hatch_copy,EGS_HATCH_COPY)(char *var,
+        const EGS_I32 *nbytes) {
+  if( hatch_iop == 1 ) memcpy(hatch_data+hatch_pos,var,*nbytes);
+  else if( hatch_iop == 2 ) memcpy(var,hatch_data+hatch_pos,*nbytes);
+  hatch_pos += *nbytes;
+}
+
+EGS_I64 egsHatchData(int iop, char *data) {
+  hatch_iop = iop; hatch_data = data; hatch_pos = 0;
+  F77_OBJ_(egs_hatch_data,EGS_HATCH_DATA)();
+  hatch_iop = 0; hatch_data = 0;
+  return hatch_pos;
+}
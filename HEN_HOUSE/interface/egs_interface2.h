@@ -331,6 +331,23 @@ struct EGS_Media {
     EGS_I32   nmed;
 };
 
+/*! Size of the random number array of the mortran back-end. Must be the
+  same as \c $NRANDOM in \c egs_c_interface2.macros */
+#define EGS_NRANDOM 128
+
+/*! \brief A C-structure corresponding to the \c randomm common block
+
+  Contains the array of random numbers used by the mortran back-end. In
+  the C++ interface this is also the array of the egspp random number
+  generator (see EGS_RandomGenerator::setExternalArray()).
+  */
+struct EGS_Random {
+    /*! The random number array */
+    EGS_Float rng_array[EGS_NRANDOM];
+    /*! The number of elements of rng_array already used */
+    EGS_I32   rng_seed;
+};
+
 /*! \brief A structure corresponding to the \c rayleigh_inputs common block
 
   Contains media and FF file names for custom Rayleigh scattering
@@ -684,6 +701,10 @@ extern __extc__ struct EGS_VarianceReduction *the_egsvr;
   pointer to a C-structure of type EGS_Rayleigh */
 extern __extc__ struct EGS_Rayleigh *the_rayleigh;
 
+/*! \brief The address of the mortran randomm common block as a
+  pointer to a C-structure of type EGS_Random */
+extern __extc__ struct EGS_Random *the_rng;
+
 /*! \brief The address of the mortran EMF-INPUTS common block as a
   pointer to a C-structure of type EGS_emfInputs */
 extern __extc__ struct EGS_emfInputs *the_emf;
@@ -752,6 +773,18 @@ extern __extc__ EGS_I32 egsAddMedium(const char *medname, EGS_I32 length);
  */
 extern __extc__ void egsHatch(void);
 
+/*! \brief Copy the cross section data initialized by egsHatch()
+
+  If \a iop is 1, all variables initialized by egsHatch() are copied
+  into the buffer \a data. If \a iop is 2, they are copied from \a data
+  back into the mortran common blocks instead of calling egsHatch().
+  If \a iop is 0, \a data is not used. The return value is the number
+  of bytes needed for the data, which must be the size of \a data.
+  This is used by EGS_AdvancedApplication::initCrossSections() to store
+  and reuse cross section snapshots.
+ */
+extern __extc__ EGS_I64 egsHatchData(int iop, char *data);
+
 /*! Shorthand notation for the \c SHOWER subroutine (which is renamed to
     \c egs_shower for the C/C++ interface using mortran's replacemant
     capabilities) */
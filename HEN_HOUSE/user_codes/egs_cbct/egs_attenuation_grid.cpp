@@ -0,0 +1,240 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ egs_cbct application attenuation grid class
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+#
+#  Implementation of the EGS_AttenuationGrid class.
+#
+#  Caches media and densities of the simulation geometry on a regular grid
+#  and computes attenuation line integrals by marching through its voxels.
+#
+###############################################################################
+*/
+
+
+#include <cmath>
+
+#include "egs_attenuation_grid.h"
+#include "egs_input.h"
+#include "egs_functions.h"
+#include "egs_base_geometry.h"
+
+using namespace std;
+
+EGS_AttenuationGrid::EGS_AttenuationGrid(EGS_Input *inp, EGS_BaseGeometry *g,
+                                         const int &_imed_out):
+nx(0), ny(0), nz(0), nxy(0), nvox(0), imed_out(_imed_out)
+{
+    vector<EGS_Float> cmin, cmax; vector<int> nv;
+    int err1 = inp->getInput("minimum corner",cmin);
+    int err2 = inp->getInput("maximum corner",cmax);
+    int err3 = inp->getInput("voxels",nv);
+    if( err1 || err2 || err3 || cmin.size() != 3 || cmax.size() != 3 ||
+        nv.size() != 3 )
+      egsFatal("\n\n***  Wrong/missing 'minimum corner', 'maximum corner'"
+               " or 'voxels' input\n"
+               "     for the attenuation grid. This is a fatal error\n\n");
+    if( nv[0] < 1 || nv[1] < 1 || nv[2] < 1 ||
+        cmax[0] <= cmin[0] || cmax[1] <= cmin[1] || cmax[2] <= cmin[2] )
+      egsFatal("\n\n***  Invalid attenuation grid: the number of voxels"
+               " must be positive\n"
+               "     and the maximum corner must be above the minimum"
+               " corner. This is a fatal error\n\n");
+
+    xmin = EGS_Vector(cmin[0],cmin[1],cmin[2]);
+    xmax = EGS_Vector(cmax[0],cmax[1],cmax[2]);
+    nx = nv[0]; ny = nv[1]; nz = nv[2]; nxy = nx*ny; nvox = nxy*nz;
+    dx = (xmax.x - xmin.x)/nx;
+    dy = (xmax.y - xmin.y)/ny;
+    dz = (xmax.z - xmin.z)/nz;
+
+    /* sample region, medium and density at the voxel centers */
+    med.resize(nvox); rho.resize(nvox); reg.resize(nvox);
+    for(int iz=0; iz<nz; iz++) {
+      for(int iy=0; iy<ny; iy++) {
+        for(int ix=0; ix<nx; ix++) {
+          int iv = ix + iy*nx + iz*nxy;
+          EGS_Vector xc(xmin.x + (ix+0.5)*dx,
+                        xmin.y + (iy+0.5)*dy,
+                        xmin.z + (iz+0.5)*dz);
+          int ireg = g->isWhere(xc);
+          reg[iv] = ireg >= 0 ? ireg : -1;
+          if( ireg >= 0 ) {
+             med[iv] = g->medium(ireg);
+             rho[iv] = g->getRelativeRho(ireg);
+          }
+          else { med[iv] = outside; rho[iv] = 1; }
+        }
+      }
+    }
+}
+
+void EGS_AttenuationGrid::describeIt() const {
+    egsInformation("\n Attenuation grid: %d x %d x %d voxels\n",
+                   nx,ny,nz);
+    egsInformation("   from (%g,%g,%g) to (%g,%g,%g)\n",
+                   xmin.x,xmin.y,xmin.z,xmax.x,xmax.y,xmax.z);
+}
+
+/* Clips the interval [t0,t1] of the ray to the slab lo <= x <= hi */
+static inline bool clipToSlab(EGS_Float xo, EGS_Float uo,
+                              EGS_Float lo, EGS_Float hi,
+                              EGS_Float &t0, EGS_Float &t1) {
+    if( uo == 0 ) return xo >= lo && xo <= hi;
+    EGS_Float ta = (lo - xo)/uo, tb = (hi - xo)/uo;
+    if( ta > tb ) { EGS_Float tmp = ta; ta = tb; tb = tmp; }
+    if( ta > t0 ) t0 = ta;
+    if( tb < t1 ) t1 = tb;
+    return t0 < t1;
+}
+
+/* Sets the voxel index, the distance to the next voxel boundary and
+   the distance between boundaries along one axis */
+static inline void initAxis(EGS_Float xs, EGS_Float uo, EGS_Float lo,
+                            EGS_Float d, int n, EGS_Float t0,
+                            int &i, int &step, EGS_Float &tnext,
+                            EGS_Float &dt) {
+    i = (int) ((xs - lo)/d);
+    if( i < 0 ) i = 0; else if( i >= n ) i = n-1;
+    if( uo > 0 ) {
+        step = 1; dt = d/uo; tnext = t0 + (lo + (i+1)*d - xs)/uo;
+    }
+    else if( uo < 0 ) {
+        step = -1; dt = -d/uo; tnext = t0 + (lo + i*d - xs)/uo;
+    }
+    else { step = 0; dt = 1e30; tnext = 1e30; }
+}
+
+double EGS_AttenuationGrid::getLambda(const EGS_Vector &x,
+                                      const EGS_Vector &u,
+                                      const EGS_Float &t,
+                                      const EGS_Float *sigma) const {
+    double sig_out = imed_out >= 0 ? sigma[imed_out] : 0;
+    EGS_Float t0 = 0, t1 = 1e30;
+    if( !clipToSlab(x.x,u.x,xmin.x,xmax.x,t0,t1) ||
+        !clipToSlab(x.y,u.y,xmin.y,xmax.y,t0,t1) ||
+        !clipToSlab(x.z,u.z,xmin.z,xmax.z,t0,t1) ) return sig_out*t;
+
+    /* as for the full geometry, the ray is not attenuated before it
+       enters the geometry, only after leaving it */
+    EGS_Float tend = t < t1 ? t : t1;
+    EGS_Vector xs(x + u*t0);
+    int ix, iy, iz, sx, sy, sz; EGS_Float tx, ty, tz, dtx, dty, dtz;
+    initAxis(xs.x,u.x,xmin.x,dx,nx,t0,ix,sx,tx,dtx);
+    initAxis(xs.y,u.y,xmin.y,dy,ny,t0,iy,sy,ty,dty);
+    initAxis(xs.z,u.z,xmin.z,dz,nz,t0,iz,sz,tz,dtz);
+
+    double lambda = 0; bool entered = false;
+    EGS_Float tcur = t0;
+    while( tcur < tend ) {
+        int iv = ix + iy*nx + iz*nxy;
+        EGS_Float tnext = tx < ty ? (tx < tz ? tx : tz) : (ty < tz ? ty : tz);
+        bool done = tnext >= tend;
+        if( done ) tnext = tend;
+        int imed = med[iv];
+        if( imed == outside ) {
+            if( entered ) lambda += (tnext - tcur)*sig_out;
+        }
+        else {
+            entered = true;
+            if( imed >= 0 ) lambda += (tnext - tcur)*rho[iv]*sigma[imed];
+        }
+        if( done ) break;
+        tcur = tnext;
+        if( tx <= ty && tx <= tz ) {
+            ix += sx; if( ix < 0 || ix >= nx ) break; tx += dtx;
+        }
+        else if( ty <= tz ) {
+            iy += sy; if( iy < 0 || iy >= ny ) break; ty += dty;
+        }
+        else {
+            iz += sz; if( iz < 0 || iz >= nz ) break; tz += dtz;
+        }
+    }
+    /* rays that miss the geometry are attenuated by the surrounding
+       medium over their full length */
+    if( !entered ) return sig_out*t;
+    if( t > t1 ) lambda += sig_out*(t - t1);
+    return lambda;
+}
+
+int EGS_AttenuationGrid::computeIntersections(const EGS_Vector &x,
+                                  const EGS_Vector &u, int n,
+                                  EGS_GeometryIntersections *isections) const {
+    if( n < 1 ) return -1;
+    EGS_Float t0 = 0, t1 = 1e30;
+    if( !clipToSlab(x.x,u.x,xmin.x,xmax.x,t0,t1) ||
+        !clipToSlab(x.y,u.y,xmin.y,xmax.y,t0,t1) ||
+        !clipToSlab(x.z,u.z,xmin.z,xmax.z,t0,t1) ) return 0;
+
+    EGS_Vector xs(x + u*t0);
+    int ix, iy, iz, sx, sy, sz; EGS_Float tx, ty, tz, dtx, dty, dtz;
+    initAxis(xs.x,u.x,xmin.x,dx,nx,t0,ix,sx,tx,dtx);
+    initAxis(xs.y,u.y,xmin.y,dy,ny,t0,iy,sy,ty,dty);
+    initAxis(xs.z,u.z,xmin.z,dz,nz,t0,iz,sz,tz,dtz);
+
+    int nsec = 0;
+    EGS_Float tcur = t0;
+    while( 1 ) {
+        int iv = ix + iy*nx + iz*nxy;
+        EGS_Float tnext = tx < ty ? (tx < tz ? tx : tz) : (ty < tz ? ty : tz);
+        bool done = tnext >= t1;
+        if( done ) tnext = t1;
+        int ireg = reg[iv];
+        if( ireg < 0 ) {
+            if( nsec ) break;   // the ray has left the geometry
+        }
+        else {
+            if( !nsec && tcur > 0 ) {
+                /* part of the ray before it enters the geometry */
+                isections[0].t = tcur; isections[0].rhof = 1;
+                isections[0].ireg = -1; isections[0].imed = -1;
+                nsec = 1;
+            }
+            if( nsec && isections[nsec-1].ireg == ireg )
+                isections[nsec-1].t = tnext;
+            else {
+                if( nsec >= n ) return -1;
+                isections[nsec].t = tnext; isections[nsec].rhof = rho[iv];
+                isections[nsec].ireg = ireg; isections[nsec].imed = med[iv];
+                ++nsec;
+            }
+        }
+        if( done ) break;
+        tcur = tnext;
+        if( tx <= ty && tx <= tz ) {
+            ix += sx; if( ix < 0 || ix >= nx ) break; tx += dtx;
+        }
+        else if( ty <= tz ) {
+            iy += sy; if( iy < 0 || iy >= ny ) break; ty += dty;
+        }
+        else {
+            iz += sz; if( iz < 0 || iz >= nz ) break; tz += dtz;
+        }
+    }
+    return nsec;
+}
@@ -0,0 +1,121 @@
+/*
+###############################################################################
+#
+#  EGSnrc egs++ egs_cbct application attenuation grid class
+#  Copyright (C) 2015 National Research Council Canada
+#
+#  This file is part of EGSnrc.
+#
+#  EGSnrc is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Affero General Public License as published by the
+#  Free Software Foundation, either version 3 of the License, or (at your
+#  option) any later version.
+#
+#  EGSnrc is distributed in the hope that it will be useful, but WITHOUT ANY
+#  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+#  FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+#  more details.
+#
+#  You should have received a copy of the GNU Affero General Public License
+#  along with EGSnrc. If not, see <http://www.gnu.org/licenses/>.
+#
+###############################################################################
+#
+#  Author:          EGSnrc developers, 2026
+#
+#  Contributors:
+#
+###############################################################################
+#
+#  Definition of the EGS_AttenuationGrid class.
+#
+#  Caches the medium and relative mass density of the simulation geometry on
+#  a regular voxel grid so that attenuation line integrals to the scoring
+#  plane can be obtained by marching through the grid instead of computing
+#  the intersections with the full geometry for every ray. In Monte Carlo
+#  calculations with forced detection the grid also provides the sections
+#  along which scattered photons are attenuated and their interaction
+#  sites are sampled.
+#
+#  Input (inside the planar scoring block, ray-tracing calculations):
+#
+#  :start attenuation grid:
+#      minimum corner = xmin ymin zmin
+#      maximum corner = xmax ymax zmax
+#      voxels         = nx ny nz
+#  :stop attenuation grid:
+#
+#  The region, medium and density of each voxel are those at the voxel
+#  center. As in the ray-tracing through the full geometry, voxels outside
+#  the geometry are attenuated by the surrounding medium only after the ray
+#  has entered the geometry. The grid should cover the geometry, and the
+#  results are exact only when it coincides with the voxels of the
+#  simulation geometry.
+#
+###############################################################################
+*/
+
+
+#ifndef EGS_ATTENUATION_GRID__
+#define EGS_ATTENUATION_GRID__
+
+#include "egs_functions.h"
+#include "egs_vector.h"
+
+#include <vector>
+
+class EGS_Input;
+class EGS_BaseGeometry;
+struct EGS_GeometryIntersections;
+
+class  EGS_AttenuationGrid {
+
+protected:
+
+    EGS_Vector xmin, xmax;  // grid corners
+    int nx, ny, nz, nxy;    // number of voxels in each direction
+    EGS_Float dx, dy, dz;   // voxel sizes
+    int nvox;               // total number of voxels
+    int imed_out;           // medium outside the geometry (-1 = vacuum)
+
+    static const short outside = -2;
+
+    vector<short> med;      // medium index of each voxel, -1 = vacuum,
+                            // outside = not in the geometry
+    vector<float> rho;      // relative mass density of each voxel
+    vector<int>   reg;      // geometry region of each voxel, -1 = outside
+
+public:
+
+    /* Creates the grid from the attenuation grid input block and fills
+       it by sampling geometry g at the voxel centers. Medium _imed_out
+       is used outside the geometry. */
+    EGS_AttenuationGrid(EGS_Input *inp, EGS_BaseGeometry *g,
+                        const int &_imed_out);
+    ~EGS_AttenuationGrid(){};
+
+    void describeIt() const;
+
+    /* Number of mean free paths along the ray x + u*s, 0 <= s <= t.
+       sigma[imed] is the linear attenuation coefficient of medium imed
+       at the current energy for unit relative density. As in the
+       ray-tracing through the full geometry, the part of the ray before
+       it enters the geometry is not attenuated and the parts outside the
+       geometry after that are attenuated by the surrounding medium. Rays
+       that never enter the geometry are attenuated by this medium over
+       their full length. */
+    double getLambda(const EGS_Vector &x, const EGS_Vector &u,
+                     const EGS_Float &t, const EGS_Float *sigma) const;
+
+    /* Fills isections with the sections of the ray x + u*s through the
+       grid in the same way as EGS_BaseGeometry::computeIntersections()
+       for a ray starting inside the geometry: consecutive voxels of the
+       same region are merged and the list ends where the ray leaves the
+       geometry or the grid. Voxels outside the geometry before the ray
+       enters it form a first section with region and medium -1.
+       Returns the number of sections, 0 if the ray does not enter the
+       geometry within the grid, or -1 if there are more than n. */
+    int computeIntersections(const EGS_Vector &x, const EGS_Vector &u,
+                             int n, EGS_GeometryIntersections *isections) const;
+};
+#endif
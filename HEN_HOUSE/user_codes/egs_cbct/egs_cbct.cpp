@@ -284,7 +284,8 @@ EGS_CBCT::EGS_CBCT(int argc, char **argv) :
         cbctS(0), scan_type(none), split_type(no_split), rhormax(1),d_split(-1),
         error_estimation(0), split_geom(0), pnorm(1), m_real(0), m_blank(0),
         nmax(10), nmax2d(6), chi2max(2), dmin(0.02), do_smoothing(false),
-        splitter(0), c_att(0), C_imp(1), C_imp_save(1), ray_tracing(false)
+        splitter(0), c_att(0), C_imp(1), C_imp_save(1), ray_tracing(false),
+        att_grid(0), att_gle(-1e30)
 {
         gsections = new EGS_GeometryIntersections[isize];
         //hist = new EGS_Hist(100.,1024);
@@ -303,6 +304,7 @@ EGS_CBCT::~EGS_CBCT() {
    if( cbctS ) delete cbctS;
    if( splitter ) delete splitter;
    if( c_att ) delete c_att;
+   if( att_grid ) delete att_grid;
    //if(hist) delete hist;
 }
 
@@ -313,7 +315,11 @@ inline int EGS_CBCT::computeIntersections(int ireg, const EGS_Vector &x,
 //        const EGS_Vector &u, EGS_GeometryIntersections *isections) {
     int nsec = 0;
     while(1) {
-        nsec = geometry->computeIntersections(ireg,isize,x,u,gsections);
+        /* use the geometry when the ray misses the part covered by the grid */
+        nsec = att_grid ? att_grid->computeIntersections(x,u,isize,gsections)
+                        : 0;
+        if( !nsec )
+            nsec = geometry->computeIntersections(ireg,isize,x,u,gsections);
         if( nsec >= 0 ) break;
         int nsize = 2*isize;
         if( nsize > 16384 ) {
@@ -339,6 +345,14 @@ inline int EGS_CBCT::computeIntersections(int ireg, const EGS_Vector &x,
     return nsec;
 }
 
+inline int EGS_CBCT::sectionRegion(int j, const EGS_Vector &x) {
+    if( att_grid ) {
+        int ireg = geometry->isWhere(x);
+        if( ireg >= 0 ) return ireg;
+    }
+    return gsections[j].ireg;
+}
+
 /*
 Index i assigned to particles at x[i] <= x < x[i+1].
 Therefore, if x hits the edge exactly at xmax it can get through
@@ -1021,6 +1035,16 @@ int EGS_CBCT::initScoring() {
               geometry->getMediumName(0));
             }
 
+            /* cached attenuation grid for ray-tracing and for the
+               attenuation and interaction sites of scattered photons */
+            EGS_Input *grid_inp = aux->takeInputItem("attenuation grid");
+            if( grid_inp ) {
+                EGS_BaseGeometry::setActiveGeometryList(app_index);
+                att_grid = new EGS_AttenuationGrid(grid_inp,geometry,iair);
+                att_sigma.resize(the_media->nmed,0);
+                delete grid_inp;
+            }
+
             /* get target uncertainty and kerma cut_off */
             // defaults set to 1% and 0.5 respectively
             err0 = 0; EGS_Float eps, cut;
@@ -1846,6 +1870,8 @@ void EGS_CBCT::describeSimulation() {
      egsInformation("\n Surrounding medium name is : VACUUM (iair=%d)\n",
                  iair);
 
+   if( att_grid ) att_grid->describeIt();
+
    if (!forced_detection)
     egsInformation("\n Scoring kerma when CROSSING plane [%d]",
                   forced_detection);
@@ -1987,70 +2013,89 @@ inline void EGS_CBCT::RayTrace( const int & ir0 )
 
        if ( k < 0 ) return; // Does not hit detector
 
-       //
-       // *** Particle headed for the detection screen
-       // *** Get particle's trajectory intersections through geometry
-       //
-       int ireg = ir0,
-           nsec = computeIntersections(ireg,p.x,p.u);
-       //
-       // *** Ray trace path along particle's direction to the screen
-       //
-       EGS_Float gle = log(p.E), tlast = 0, gmfp=1e30,
-                 sigma = 0, cohfac = 1, rhor = 1;
-       int imed = -1; bool reached_screen = false; double Lambda = 0;
+       EGS_Float gle = log(p.E); double Lambda = 0;
+       if( att_grid ) {
+           //
+           // *** Particle headed for the detection screen
+           // *** March through the cached attenuation grid
+           //
+           if( gle != att_gle ) {
+               for(size_t j=0; j<att_sigma.size(); j++) {
+                   EGS_Float gmfp = i_gmfp[j].interpolateFast(gle);
+                   if( the_xoptions->iraylr )
+                       gmfp *= i_cohe[j].interpolateFast(gle);
+                   att_sigma[j] = 1/gmfp;
+               }
+               att_gle = gle;
+           }
+           Lambda = att_grid->getLambda(p.x,p.u,t,&att_sigma[0]);
+       }
+       else {
+           //
+           // *** Particle headed for the detection screen
+           // *** Get particle's trajectory intersections through geometry
+           //
+           int ireg = ir0,
+               nsec = computeIntersections(ireg,p.x,p.u);
+           //
+           // *** Ray trace path along particle's direction to the screen
+           //
+           EGS_Float tlast = 0, gmfp=1e30,
+                     sigma = 0, cohfac = 1, rhor = 1;
+           int imed = -1; bool reached_screen = false;
 // egsInformation("ireg = %d nsec = %d pixel=%d\n",ir0,nsec,k);
-       if (!nsec){ scoreDirectKerma( gle, p.wt, t, a*p.u, k ); return;}
+           if (!nsec){ scoreDirectKerma( gle, p.wt, t, a*p.u, k ); return;}
 /*if (nsec)
 egsInformation("-> Initial: ireg = %d x=%g y=%g z=%g u=%g v=%g w=%g nsec = %d pixel=%d\n",
                   ireg,p.x.x,p.x.y,p.x.z,p.u.x,p.u.y,p.u.z,nsec,k);*/
-       for(int j=0; j<nsec; j++) {
-           EGS_Float tnew = gsections[j].t, // distance from particle's position to jth intersection
-                     tstep = tnew - tlast;  // step through jth region
-           /**************************************************/
-           /* Get mu value for current region and MFP numbers*/
-           /**************************************************/
-           if( imed != gsections[j].imed ) {
-               imed = gsections[j].imed;
-               if( imed >= 0 ) {
-                   gmfp = i_gmfp[imed].interpolateFast(gle);
-                   if( the_xoptions->iraylr ) {
-                       cohfac = i_cohe[imed].interpolateFast(gle);
-                       gmfp *= cohfac;
+           for(int j=0; j<nsec; j++) {
+               EGS_Float tnew = gsections[j].t, // distance from particle's position to jth intersection
+                         tstep = tnew - tlast;  // step through jth region
+               /**************************************************/
+               /* Get mu value for current region and MFP numbers*/
+               /**************************************************/
+               if( imed != gsections[j].imed ) {
+                   imed = gsections[j].imed;
+                   if( imed >= 0 ) {
+                       gmfp = i_gmfp[imed].interpolateFast(gle);
+                       if( the_xoptions->iraylr ) {
+                           cohfac = i_cohe[imed].interpolateFast(gle);
+                           gmfp *= cohfac;
+                       }
                    }
+                   else { continue;}//gmfp=1e15; cohfac = 1; }
+               }
+               sigma = gsections[j].rhof/gmfp;
+               EGS_Float this_lambda = tstep*sigma;// MFP numbers tstep*mu = tstep/lambda
+               /**************************************************/
+
+               if( !reached_screen && tnew >= t ) {
+                   reached_screen = true;
+                   Lambda += (t - tlast)*sigma;// t - tlast is distance from
+                                               // last intersection to detector
                }
-               else { continue;}//gmfp=1e15; cohfac = 1; }
-           }
-           sigma = gsections[j].rhof/gmfp;
-           EGS_Float this_lambda = tstep*sigma;// MFP numbers tstep*mu = tstep/lambda
-           /**************************************************/
-
-           if( !reached_screen && tnew >= t ) {
-               reached_screen = true;
-               Lambda += (t - tlast)*sigma;// t - tlast is distance from
-                                           // last intersection to detector
-           }
 
-           if( reached_screen ) break;
+               if( reached_screen ) break;
 
-           tlast = gsections[j].t; Lambda += this_lambda;
+               tlast = gsections[j].t; Lambda += this_lambda;
 
 /*  egsInformation("med[%d] = %d t[%d] = %g cm, step= %g cm, lamda=%g \n",
                   j,gsections[j].imed,j,gsections[j].t,tstep,this_lambda);*/
-       }
+           }
 
-       if( !reached_screen ) {
-           //
-           // *** Particle has not yet intersected the scoring plane
-           //     => compute MFPs in medium surrounding the geometry
-           //
-           if( iair >= 0 ) {
-               gmfp = i_gmfp[iair].interpolateFast(gle);
-               if( the_xoptions->iraylr ) {
-                   cohfac = i_cohe[iair].interpolateFast(gle);
-                   gmfp *= cohfac;
+           if( !reached_screen ) {
+               //
+               // *** Particle has not yet intersected the scoring plane
+               //     => compute MFPs in medium surrounding the geometry
+               //
+               if( iair >= 0 ) {
+                   gmfp = i_gmfp[iair].interpolateFast(gle);
+                   if( the_xoptions->iraylr ) {
+                       cohfac = i_cohe[iair].interpolateFast(gle);
+                       gmfp *= cohfac;
+                   }
+                   Lambda += (t - gsections[nsec-1].t)/gmfp;
                }
-               Lambda += (t - gsections[nsec-1].t)/gmfp;
            }
        }
 
@@ -3124,6 +3169,34 @@ void EGS_CBCT::getCurrentResult(double &sum, double &sum2, double &norm,
     }
 }
 
+/*! Set a splitting parameter during tuning.
+    Splitting can only be tuned if it was turned on in the variance
+    reduction input, because the ausgab calls before photon interactions
+    are only requested in initScoring() when splitting is used.
+    The primary splitting number Np can not be tuned with RDIS and the
+    PDIS splitting factor not with a PDIS corrector, because the
+    importance limits of these objects are set up with the input values.
+ */
+bool EGS_CBCT::setVRParameter(const string &name, EGS_Float value) {
+    if( !ausgab_flag[BeforeCompton] ) return false;
+    if( name == "primary splitting" ) {
+        if( value < 1 || splitter || split_type == PDIS ) return false;
+        nsplit_p = (int) value; the_extra_stack->iphatI = nsplit_p;
+        return true;
+    }
+    if( name == "secondary splitting" ) {
+        if( value < 1 ) return false;
+        nsplit_s = (int) value;
+        return true;
+    }
+    if( name == "PDIS splitting factor" ) {
+        if( value <= 0 || split_type != PDIS || c_att ) return false;
+        f_split = value;
+        return true;
+    }
+    return EGS_AdvancedApplication::setVRParameter(name,value);
+}
+
 /*! simulate a shower */
 int EGS_CBCT::shower() {
 #ifdef USTEP_DEBUG
@@ -3215,7 +3288,7 @@ redo_step:
                     //egsInformation("ispl=%d next lambda: %g lambda_old=%g\n",
                     //        ispl,lambda,lambda_old);
                     EGS_CBCT_Photon p1(p); p1.x += p1.u*(tlast + tt);
-                    p1.imed = imed; p1.ir = gsections[j].ireg;
+                    p1.imed = imed; p1.ir = sectionRegion(j,p1.x);
                     p1.latch = -p1.latch-1; pc.addParticle(p1);
                     tstep -= tt; tlast += tt;
                     goto redo_step;
@@ -3223,7 +3296,7 @@ redo_step:
                 else {
                     //egsInformation("final interaction\n");
                     p.x += p.u*(tlast + tt);
-                    p.imed = imed; p.ir = gsections[j].ireg;
+                    p.imed = imed; p.ir = sectionRegion(j,p.x);
                     not_interacted = false;
                 }
             }
@@ -3836,7 +3909,7 @@ void EGS_CBCT::selectPhotonMFP(EGS_Float &dpmfp) {
            the_stack->y[np] = xint.y;
            the_stack->z[np] = xint.z;
            the_stack->dnear[np] = 0;
-           the_stack->ir[np] = gsections[jint].ireg + 2;
+           the_stack->ir[np] = sectionRegion(jint,xint) + 2;
            the_useful->medium = imed_int + 1;
 
            //********************************************************
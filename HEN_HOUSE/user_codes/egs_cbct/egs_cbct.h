@@ -39,6 +39,7 @@
 #include "egs_mortran.h"
 #include "egs_splitter.h"
 #include "egs_corrector.h"
+#include "egs_attenuation_grid.h"
 #include <string>
 #include <vector>
 
@@ -230,6 +231,9 @@ public:
     void getCurrentResult(double &sum,  double &sum2,
                           double &norm, double &count);
 
+    /*! Set a splitting parameter during variance reduction tuning */
+    bool setVRParameter(const string &name, EGS_Float value);
+
     /*! simulate a shower */
     int shower();
 
@@ -339,6 +343,9 @@ protected:
                                     const EGS_Vector &u,
                              EGS_GeometryIntersections *isections);*/
     inline int computeIntersections(int ireg, const EGS_Vector &x,const EGS_Vector &u);
+    /* Region of an interaction site in section j. Grid sections carry the
+       region at the voxel center, so it is looked up in the geometry. */
+    inline int sectionRegion(int j, const EGS_Vector &x);
     inline EGS_Float getLambda(const int &nsec,
                                EGS_GeometryIntersections *isections,
                                EGS_Float gle);
@@ -513,6 +520,10 @@ private:
     EGS_Hist* hist;
     /* splitter object */
     EGS_Splitter* splitter;
+    /* cached attenuation grid for ray-tracing and scatter scoring */
+    EGS_AttenuationGrid* att_grid;
+    vector<EGS_Float>    att_sigma;// attenuation coefficient per medium
+    EGS_Float            att_gle;  // log(E) at which att_sigma was computed
     EGS_Float C_imp,
               C_imp_save;// importance in previous region, reset to 1 in shower()
 
@@ -41,6 +41,15 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/mman.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
 
 #include "egs_smoothing.h"
 #include "egs_input.h"
@@ -102,6 +111,62 @@ EGS_Distribution2DArray::EGS_Distribution2DArray(const char *fname,
     delete [] dummy;
 }
 
+bool EGS_SmoothingMoments::build(const float *f, int nx, int ny, int nz) {
+    if( (double)(nx+1)*(ny+1)*(nz+1) > maxSize() ) return false;
+    int size = (nx+1)*(ny+1)*(nz+1);
+    if( size != msize ) {
+        if( t ) delete [] t;
+        t = new double [10*size]; msize = size;
+    }
+    mx = nx+1; my = ny+1; mxy = mx*my;
+    cx = nx/2; cy = ny/2; cz = nz/2;
+    for(int j=0; j<10*size; j++) t[j] = 0;
+    /* moments are taken relative to the center of the distribution to
+       reduce round-off in the differences of large prefix sums */
+    int dx = 10, dy = 10*mx, dz = 10*mxy;
+    for(int z=1; z<=nz; z++) {
+        double Z = z-1-cz;
+        for(int y=1; y<=ny; y++) {
+            double Y = y-1-cy;
+            const float *fr = f + (y-1)*nx + (z-1)*nx*ny;
+            double *tt = t + 10*(1 + y*mx + z*mxy);
+            for(int x=1; x<=nx; x++, tt += 10) {
+                double X = x-1-cx, ff = fr[x-1];
+                double v[10] = { ff, ff*X, ff*Y, ff*Z, ff*X*Y, ff*X*Z,
+                                 ff*Y*Z, ff*X*X, ff*Y*Y, ff*Z*Z };
+                for(int m=0; m<10; m++) tt[m] = v[m] +
+                    tt[m-dx] + tt[m-dy] + tt[m-dz] -
+                    tt[m-dx-dy] - tt[m-dx-dz] - tt[m-dy-dz] +
+                    tt[m-dx-dy-dz];
+            }
+        }
+    }
+    return true;
+}
+
+void EGS_SmoothingMoments::windowSums(int ic, int jc, int kc,
+                     int hi, int hj, int hk, double *s) const {
+    int x0 = ic-hi, x1 = ic+hi+1, y0 = (jc-hj)*mx, y1 = (jc+hj+1)*mx,
+        z0 = (kc-hk)*mxy, z1 = (kc+hk+1)*mxy;
+    const double *t111 = t + 10*(x1+y1+z1), *t011 = t + 10*(x0+y1+z1),
+                 *t101 = t + 10*(x1+y0+z1), *t110 = t + 10*(x1+y1+z0),
+                 *t001 = t + 10*(x0+y0+z1), *t010 = t + 10*(x0+y1+z0),
+                 *t100 = t + 10*(x1+y0+z0), *t000 = t + 10*(x0+y0+z0);
+    double S[10];
+    for(int m=0; m<10; m++) S[m] = t111[m] - t011[m] - t101[m] - t110[m] +
+                                   t001[m] + t010[m] + t100[m] - t000[m];
+    /* convert to moments relative to the window center */
+    double a = ic-cx, b = jc-cy, c = kc-cz;
+    s[0] = S[0];
+    s[1] = S[1] - a*S[0]; s[2] = S[2] - b*S[0]; s[3] = S[3] - c*S[0];
+    s[4] = S[4] - b*S[1] - a*S[2] + a*b*S[0];
+    s[5] = S[5] - c*S[1] - a*S[3] + a*c*S[0];
+    s[6] = S[6] - c*S[2] - b*S[3] + b*c*S[0];
+    s[7] = S[7] - 2*a*S[1] + a*a*S[0];
+    s[8] = S[8] - 2*b*S[2] + b*b*S[0];
+    s[9] = S[9] - 2*c*S[3] + c*c*S[0];
+}
+
 void EGS_Smoothing::setNmax(int Nmax) {
     if( nmax == Nmax ) return;
     if( nmax > 0 ) {
@@ -125,8 +190,13 @@ void EGS_Smoothing::setNmax(int Nmax) {
 }
 
 void EGS_Smoothing::calculateCoefficients(int Ni, int Nj, bool do_norm) {
-    s0 = si = sj = sij = sii = sjj = 0;
-    for(register int j=-nj; j<=nj; j++) {
+    if( use_moments && Ni == 1 && Nj == nx && Ni != Nj ) {
+        double s[10]; moments.windowSums(ii,jj,0,ni,nj,0,s);
+        s0 = s[0]; si = s[1]; sj = s[2]; sij = s[4]; sii = s[7]; sjj = s[8];
+    }
+    else {
+      s0 = si = sj = sij = sii = sjj = 0;
+      for(register int j=-nj; j<=nj; j++) {
         register int j2 = j*j;
         for(register int i=-ni; i<=ni; i++) {
             register double ff = fsmoo1[reg + i*Ni + j*Nj];
@@ -135,6 +205,7 @@ void EGS_Smoothing::calculateCoefficients(int Ni, int Nj, bool do_norm) {
                 ff *= i; si += ff; sij += ff*j; sii += ff*i;
             }
         }
+      }
     }
     if( do_norm ) {
         N = (2*ni+1)*(2*nj+1);
@@ -278,6 +349,7 @@ EGS_Smoothing::smooth1(EGS_Distribution2D *the_dose) {
     for(reg=0; reg<nreg; reg++) {
         fsmoo1[reg] = fsmoo[reg]; dfsmoo1[reg] = dfsmoo[reg];
     }
+    use_moments = moments.build(fsmoo1,nx,ny,1);
     for(ii=0; ii<nx; ii++) {
         //egsWarning(".");
         for(jj=0; jj<ny; jj++) {
@@ -314,20 +386,104 @@ EGS_Smoothing::smooth1(EGS_Distribution2D *the_dose) {
         }
     }
     //egsWarning("\n");
-    int  nsmoothed = 0;char c = '%';
+    nsmoothed = 0;
     for(reg=0; reg<nreg; reg++) {
        if (smoothed[reg]) nsmoothed++;
     }
+    if( verbose ) reportStatus(nsmoothed,nreg);
+
+    delete [] smoothed;
+    delete [] ni_array; delete [] nj_array;
+    return result;
+}
+
+void EGS_Smoothing::reportStatus(int ns, int ntot) {
+    char c = '%';
     egsInformation("\n==================\n"
                     " smoothing status \n"
                     "==================\n");
-    egsInformation("smoothed %d voxels out of %d\n",nsmoothed,nreg);
-    egsInformation("smoothing rate: %g %c\n",100.0*EGS_Float(nsmoothed)/EGS_Float(nreg),c);
+    egsInformation("smoothed %d voxels out of %d\n",ns,ntot);
+    egsInformation("smoothing rate: %g %c\n",100.0*EGS_Float(ns)/EGS_Float(ntot),c);
     egsInformation("==================\n");
+}
 
-    delete [] smoothed;
-    delete [] ni_array; delete [] nj_array;
-    return result;
+void EGS_Smoothing::smoothProjection(EGS_Distribution2D *proj, float *res,
+                                     int *ns) {
+    EGS_Distribution2D *smoothed = smooth1(proj);
+    for(int j=0; j<nreg; j++) res[j] = smoothed->d_array[j];
+    *ns = nsmoothed;
+    delete smoothed;
+}
+
+bool EGS_Smoothing::smoothAll(EGS_Distribution2DArray *scan, float *result,
+                              int njobs) {
+    int nproj = scan->nProjections();
+    for(int iproj=0; iproj<nproj; iproj++) {
+        if( scan->get_proj(iproj)->nreg != nreg ) {
+            egsWarning("EGS_Smoothing::smoothAll: projection %d has %d "
+                       "regions\n",iproj,scan->get_proj(iproj)->nreg);
+            egsWarning("  whereas I'm expecting %d regions\n",nreg);
+            return false;
+        }
+    }
+    bool save_verbose = verbose; verbose = false;
+    int ns = 0;
+#ifndef WIN32
+    if( njobs > nproj ) njobs = nproj;
+    if( njobs > 1 ) {
+        /* child ichild smooths projections ichild, ichild+njobs, ... and
+           writes the results and the number of smoothed points into an
+           anonymous shared mapping. The count is set to -1 until the
+           projection is done, so that the parent can smooth projections
+           left over by children that failed. */
+        size_t nres = (size_t)nproj*nreg;
+        size_t len = nres*sizeof(float) + nproj*sizeof(int);
+        void *p = mmap(0,len,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_ANONYMOUS,
+                       -1,0);
+        if( p == MAP_FAILED ) {
+            egsWarning("EGS_Smoothing::smoothAll: failed to map shared"
+                       " memory, smoothing in a single process\n");
+        }
+        else {
+            float *res_shm = (float *) p;
+            int *ns_shm = (int *) (res_shm + nres);
+            for(int iproj=0; iproj<nproj; iproj++) ns_shm[iproj] = -1;
+            fflush(stdout); fflush(stderr); cout.flush();
+            vector<pid_t> pids;
+            for(int ichild=0; ichild<njobs; ichild++) {
+                pid_t pid = fork();
+                if( pid == 0 ) {
+                    for(int iproj=ichild; iproj<nproj; iproj+=njobs)
+                        smoothProjection(scan->get_proj(iproj),
+                                         res_shm + iproj*nreg,ns_shm + iproj);
+                    fflush(stdout); fflush(stderr);
+                    _exit(0);
+                }
+                if( pid > 0 ) pids.push_back(pid);
+            }
+            for(size_t j=0; j<pids.size(); j++) waitpid(pids[j],0,0);
+            for(int iproj=0; iproj<nproj; iproj++) {
+                if( ns_shm[iproj] < 0 )
+                    smoothProjection(scan->get_proj(iproj),
+                                     res_shm + iproj*nreg,ns_shm + iproj);
+                ns += ns_shm[iproj];
+            }
+            memcpy(result,res_shm,nres*sizeof(float));
+            munmap(p,len);
+            verbose = save_verbose;
+            if( verbose ) reportStatus(ns,nproj*nreg);
+            return true;
+        }
+    }
+#endif
+    for(int iproj=0; iproj<nproj; iproj++) {
+        int nsp;
+        smoothProjection(scan->get_proj(iproj),result + iproj*nreg,&nsp);
+        ns += nsp;
+    }
+    verbose = save_verbose;
+    if( verbose ) reportStatus(ns,nproj*nreg);
+    return true;
 }
 
 void EGS_Smoothing::describeIt(){
@@ -407,6 +563,12 @@ void EGS_Smoothing3D::set_nmax(int Nmax) {
 }
 
 void EGS_Smoothing3D::calc_sums() {
+  if( use_moments ) {
+    double s[10]; moments.windowSums(ii,jj,kk,ni,nj,nk,s);
+    s0 = s[0]; si = s[1]; sj = s[2]; sk = s[3]; sij = s[4]; sik = s[5];
+    sjk = s[6]; sii = s[7]; sjj = s[8]; skk = s[9];
+    return;
+  }
   s0 = si = sj = sk = sij = sik = sjk = sii = sjj = skk = 0;
   for(register int k=-nk; k<=nk; k++) {
     register int k2 = k*k; register int irk = (k+kk)*nxy;
@@ -424,14 +586,35 @@ void EGS_Smoothing3D::calc_sums() {
 }
 
 void EGS_Smoothing3D::calc_coeffs_ij(int Ni, int Nj, bool do_norm) {
-  s0 = si = sj = sij = sii = sjj = 0;
-  for(register int j=-nj; j<=nj; j++) {
-    register int j2 = j*j;
-    for(register int i=-ni; i<=ni; i++) {
-      register double ff = fsmoo1[reg + i*Ni + j*Nj];
-      s0 += ff; sj += ff*j; sjj += ff*j2;
-      if( i ) {
-        ff *= i; si += ff; sij += ff*j; sii += ff*i;
+  // the plane of the window is (x,y), (x,z) or (z,y)
+  double s[10]; bool done = false;
+  if( use_moments && Ni != Nj ) {
+    if( Ni == 1 && Nj == nx ) {
+      moments.windowSums(ii,jj,kk,ni,nj,0,s);
+      s0 = s[0]; si = s[1]; sj = s[2]; sij = s[4]; sii = s[7]; sjj = s[8];
+      done = true;
+    }
+    else if( Ni == 1 && Nj == nxy ) {
+      moments.windowSums(ii,jj,kk,ni,0,nj,s);
+      s0 = s[0]; si = s[1]; sj = s[3]; sij = s[5]; sii = s[7]; sjj = s[9];
+      done = true;
+    }
+    else if( Ni == nxy && Nj == nx ) {
+      moments.windowSums(ii,jj,kk,0,nj,ni,s);
+      s0 = s[0]; si = s[3]; sj = s[2]; sij = s[6]; sii = s[9]; sjj = s[8];
+      done = true;
+    }
+  }
+  if( !done ) {
+    s0 = si = sj = sij = sii = sjj = 0;
+    for(register int j=-nj; j<=nj; j++) {
+      register int j2 = j*j;
+      for(register int i=-ni; i<=ni; i++) {
+        register double ff = fsmoo1[reg + i*Ni + j*Nj];
+        s0 += ff; sj += ff*j; sjj += ff*j2;
+        if( i ) {
+          ff *= i; si += ff; sij += ff*j; sii += ff*i;
+        }
       }
     }
   }
@@ -574,6 +757,7 @@ EGS_Distribution3D *EGS_Smoothing3D::smooth1(const EGS_Distribution3D *the_dose)
     sume2 += error_array[ii]; smoothed[ii] = false;
     fsmoo1[ii] = d_array[ii]; dfsmoo1[ii] = error_array[ii];
   }
+  use_moments = moments.build(fsmoo1,nx,ny,nz);
 
   ni_array = new char [nreg]; nj_array = new char [nreg];
   nk_array = new char [nreg];
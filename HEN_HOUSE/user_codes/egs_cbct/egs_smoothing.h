@@ -108,6 +108,8 @@ EGS_Distribution2DArray(const char *fname, int Nx, int Ny, int Nz);
 
 EGS_Distribution2D* get_proj(int i){return scan[i];}
 
+int nProjections() const {return nz;}
+
 private:
 
 int nx, ny, nz;
@@ -116,6 +118,30 @@ EGS_Distribution2D** scan;
 };
 
 
+/* Summed-area (2D) or summed-volume (3D) tables of the moments
+   f, f*x, f*y, f*z, f*x*y, f*x*z, f*y*z, f*x*x, f*y*y, f*z*z of a
+   distribution f. They provide the sums over a rectangular smoothing
+   window in constant time, independent of the window size. The tables
+   are kept between calls so that smoothing a series of projections of
+   the same size does not reallocate them. */
+struct EGS_SmoothingMoments {
+    int    mx, my, mxy, msize;
+    double cx, cy, cz;
+    double *t;
+    EGS_SmoothingMoments() { msize = 0; t = 0; };
+    ~EGS_SmoothingMoments() { if( t ) delete [] t; };
+    /* Maximum number of table entries (per moment) for which tables are
+       used. Larger distributions use the direct window sums */
+    static int maxSize() { return 4194304; };
+    bool build(const float *f, int nx, int ny, int nz);
+    /* Sums of the moments relative to the window center (ic,jc,kc) for
+       the window with half-widths hi,hj,hk: s[0]=sum f,
+       s[1..3]=sum f*i,f*j,f*k, s[4..6]=sum f*i*j,f*i*k,f*j*k,
+       s[7..9]=sum f*i*i,f*j*j,f*k*k */
+    void windowSums(int ic, int jc, int kc, int hi, int hj, int hk,
+                    double *s) const;
+};
+
 class EGS_Input;
 
 class  EGS_Smoothing {
@@ -139,6 +165,12 @@ protected:
 
     double  *cc1, *cc2, *cc3, *cc4, *cc5, *cc6, *ccc;
 
+    EGS_SmoothingMoments moments;
+    bool    use_moments;
+
+    int     nsmoothed;  // points smoothed by the last call to smooth1()
+    bool    verbose;    // print the smoothing status in smooth1()
+
     void    calculateCoefficients(int Ni, int Nj, bool do_norm = true);
     void    setCoefficients();
     int     calculateChi2(int,int,double &,double &);
@@ -146,7 +178,10 @@ protected:
     bool    smooth1D(int iii, int Nx, int Ni, int &nn, double &se2, double &ww);
     void    setDefaults() {
         nmax = 0; setNmax(3); chi2_max = 1; setDimensions(0,0);
+        use_moments = false; nsmoothed = 0; verbose = true;
     };
+    void    reportStatus(int ns, int ntot);
+    void    smoothProjection(EGS_Distribution2D *proj, float *res, int *ns);
 
 public:
 
@@ -171,6 +206,19 @@ public:
     void describeIt();
     EGS_Distribution2D *smooth1(EGS_Distribution2D *the_dose);
 
+    /* Batch mode: smooths all projections of scan in one pass and stores
+       the smoothed values in result (nProjections()*nx*ny values in the
+       order of the scan). The coefficient and moment tables are reused
+       for all projections and a single smoothing status is printed for
+       the whole scan. As with smooth1(), the projections in scan may be
+       modified. If njobs > 1, the projections are distributed over njobs
+       forked processes that write into shared memory (not on Windows,
+       where they are always smoothed one after the other). Returns false
+       if the projections do not have the dimensions set with
+       setDimensions(). */
+    bool smoothAll(EGS_Distribution2DArray *scan, float *result,
+                   int njobs = 1);
+
 };
 
 /****************************************************
@@ -264,6 +312,10 @@ protected:
   char    *ni_array, *nj_array, *nk_array;
 
   double  *cc1, *cc2, *cc3, *cc4, *cc5, *cc6, *ccc;
+
+  EGS_SmoothingMoments moments;
+  bool    use_moments;
+
   void    calc_sums();
   void    copy_sums();
   void    reset_sums();
@@ -278,14 +330,14 @@ protected:
                     int &nn, double &se2, double &ww);
   void    setDefaults() {
     nmax = 0; set_nmax(3); chi2_max = 1; set_cube_dimensions(0,0,0);
-    do_3d = true; dmin = 0.1;
+    do_3d = true; dmin = 0.1; use_moments = false;
   };
 
 public:
 
   EGS_Smoothing3D() {
     nmax = 0; set_nmax(3); chi2_max = 1; set_cube_dimensions(0,0,0);
-    do_3d = true; dmin = 0.1;
+    do_3d = true; dmin = 0.1; use_moments = false;
   };
   EGS_Smoothing3D(EGS_Input *I);
   ~EGS_Smoothing3D() {
@@ -46,7 +46,7 @@ int main(int argc, char**argv) {
 
     int nmax = 4, nmax2d = 3;
     double chi2max = 1, dmin = 0.02;
-    int Nx = 64, Ny = 64, Nz = 72;
+    int Nx = 64, Ny = 64, Nz = 72, njobs = 1;
     char *ifile=0, *ofile=0, *bench=0;
     for(int j=1; j<argc-1; j++) {
         string tmp(argv[j]);
@@ -61,11 +61,12 @@ int main(int argc, char**argv) {
         else if( tmp == "-ny" ) Ny = atoi(argv[++j]);
         else if( tmp == "-nz" ) Nz = atoi(argv[++j]);
         else if( tmp == "-nz" ) Nz = atoi(argv[++j]);
+        else if( tmp == "-j" ) njobs = atoi(argv[++j]);
         else cerr << "Unknown option " << argv[j] << endl;
     }
     if( !ifile ) {
         cerr << "Usage: " << argv[0] << " -i input [-o output] [-nmax n] "
-             << "[-nmax2d n2d] [-chi2max chi2]\n";
+             << "[-nmax2d n2d] [-chi2max chi2] [-j njobs]\n";
         return 1;
     }
 
@@ -107,42 +108,52 @@ int main(int argc, char**argv) {
                  "   parameters is null! Smoothed scan identical\n"
                  "   to original scan!\n");
     }
-    for(int iproj=0; iproj<Nz; iproj++){
-
-        EGS_Distribution2D* scan = proj.get_proj(iproj);
-        EGS_Distribution2D* b    = 0;
-        if( be ) {b = be->get_proj(iproj);}
-
-        double sumo = 0, maxdo = 0;
-        if( be ) {
-           for(int j=0; j<Nx*Ny; j++) {
+    /* the projections are modified while smoothing, so get the
+       differences to the benchmark first */
+    int nreg = Nx*Ny;
+    double *sumo = 0, *maxdo = 0;
+    if( be ) {
+        sumo = new double [Nz]; maxdo = new double [Nz];
+        for(int iproj=0; iproj<Nz; iproj++) {
+           EGS_Distribution2D* scan = proj.get_proj(iproj);
+           EGS_Distribution2D* b    = be->get_proj(iproj);
+           sumo[iproj] = 0; maxdo[iproj] = 0;
+           for(int j=0; j<nreg; j++) {
               double aux = fabs(scan->d_array[j] - b->d_array[j]);
-              sumo += aux*aux;
-              if( aux > maxdo ) maxdo = aux;
+              sumo[iproj] += aux*aux;
+              if( aux > maxdo[iproj] ) maxdo[iproj] = aux;
            }
         }
-        EGS_Distribution2D *smoothed = smoo.smooth1(scan);
-        if( !smoothed ) {
-          cerr << "Error while smoothing" << iproj
-               << " projection\n"; return 1;
-        }
-        if( be ) {
+    }
+
+    /* smooth all projections in one pass */
+    float *smoothed = new float [nreg*Nz];
+    if( !smoo.smoothAll(&proj,smoothed,njobs) ) {
+        cerr << "Error while smoothing projections\n"; return 1;
+    }
+
+    if( be ) {
+        for(int iproj=0; iproj<Nz; iproj++) {
+          EGS_Distribution2D* b = be->get_proj(iproj);
+          const float *sm = smoothed + iproj*nreg;
           double sum = 0, maxd = 0;
-          for(int j=0; j<Nx*Ny; j++) {
-             double aux = fabs(smoothed->d_array[j] - b->d_array[j]);
+          for(int j=0; j<nreg; j++) {
+             double aux = fabs(sm[j] - b->d_array[j]);
              sum += aux*aux;
              if( aux > maxd ) maxd = aux;
           }
-          sum /= (Nx*Ny); sumo /= (Nx*Ny);
-          egsInformation("\nMSD  smoothed=%lg original=%lg IR=%lg",sum,sumo,
-                         sumo/sum);
+          sum /= nreg; sumo[iproj] /= nreg;
+          egsInformation("\nMSD  smoothed=%lg original=%lg IR=%lg",sum,
+                         sumo[iproj],sumo[iproj]/sum);
           egsInformation("\nMax. difference: smoothed=%lg original=%lg"
                          "IR=%lg\n",
-                         maxd,maxdo,maxdo/maxd);
+                         maxd,maxdo[iproj],maxdo[iproj]/maxd);
         }
-
-        out.write((char *) smoothed->d_array,smoothed->nreg*sizeof(float));
+        delete [] sumo; delete [] maxdo;
     }
+
+    out.write((char *) smoothed,nreg*Nz*sizeof(float));
+    delete [] smoothed;
     egsInformation(" done !\n");
 
     out.close();
@@ -79,14 +79,10 @@
 // Interpolators
 #include "egs_interpolator.h"
 #include "egs_run_control.h"
+// Temporary phase-space storage for correlated sampling
+#include "egs_particle_store.h"
 
 #include "egs_rndm.h"
-#define getRNGPointers F77_OBJ_(egs_get_rng_pointers,EGS_GET_RNG_POINTERS)
-extern __extc__ void getRNGPointers(EGS_I32 *, EGS_I32 *);
-#define getRNGArray F77_OBJ_(egs_get_rng_array,EGS_GET_RNG_ARRAY)
-extern __extc__ void getRNGArray(EGS_Float *);
-#define setRNGState F77_OBJ_(egs_set_rng_state,EGS_SET_RNG_STATE)
-extern __extc__ void setRNGState(const EGS_I32 *, const EGS_Float *);
 
 #define doRayleigh F77_OBJ_(do_rayleigh,DO_RAYLEIGH)
 extern __extc__ void doRayleigh();
@@ -109,64 +105,6 @@ extern __extc__ void F77_OBJ(photo,PHOTO)();
                 the_stack->ir[np1] = the_stack->ir[np]; \
                 the_stack->dnear[np1] = the_stack->dnear[np]; \
 
-/*! a class for storing the phase-space temporarilly */
-
-#define MAXPHSP 100000
-class TmpPhsp {
-public:
-    // constructor
-    TmpPhsp() : np(0), ntot(4), p(new EGS_Particle[4]) {};
-    ~TmpPhsp() { delete [] p; };
-    void grow() {
-        int ntot_new = 2*ntot;
-        if( ntot_new > MAXPHSP ) egsFatal("TmpPhsp::grow(): exceeded maximum size %d\n",MAXPHSP);
-        EGS_Particle *pnew = new EGS_Particle [ntot_new];
-        for(int j=0; j<np; j++) pnew[j] = p[j];
-        delete [] p;
-        p = pnew; ntot = ntot_new;
-    };
-
-    void set() {
-        if( np > ntot-1 ) grow();
-        int ip = the_stack->np-1;
-        p[np].q     = the_stack->iq[ip];
-        p[np].latch = the_stack->latch[ip];
-        p[np].ir    = the_stack->ir[ip];
-        p[np].E     = the_stack->E[ip];
-        p[np].wt    = the_stack->wt[ip];
-        p[np].x     = EGS_Vector(the_stack->x[ip],the_stack->y[ip],the_stack->z[ip]);
-        p[np++].u   = EGS_Vector(the_stack->u[ip],the_stack->v[ip],the_stack->w[ip]);
-    };
-    void set(const EGS_Particle &particle) {
-        if( np > ntot-1 ) grow();
-        p[np++] = particle;
-    };
-    void get(){
-        int ip = the_stack->np-1; --np;
-        the_stack->x[ip]  = p[np].x.x;
-        the_stack->y[ip]  = p[np].x.y;
-        the_stack->z[ip]  = p[np].x.z;
-        the_stack->u[ip]  = p[np].u.x;
-        the_stack->v[ip]  = p[np].u.y;
-        the_stack->w[ip]  = p[np].u.z;
-        the_stack->E[ip]  = p[np].E;
-        the_stack->iq[ip] = p[np].q;
-        the_stack->latch[ip] = p[np].latch;
-        the_stack->wt[ip] = p[np].wt;
-    };
-
-    void clean() { np = 0; };
-
-    void setPointer(int ip) { np = ip; };
-
-    int  size() const { return np; };
-
-private:
-
-    int          ntot, np;
-    EGS_Particle *p;
-};
-
 //*HB_start************************
 
 /*a class in which you put infos and generate new positions*/
@@ -544,7 +482,7 @@ public:
     EGS_ChamberApplication(int argc, char **argv) :
         EGS_AdvancedApplication(argc,argv), ngeom(0), dose(0),
         fsplit(1), fspliti(1), rr_flag(0), Esave(0), rho_rr(1),
-	cgeom(0), nsmall_step(0), ncg(0), do_cse(0), do_TmpPhsp(0),
+	cgeom(0), nsmall_step(0), ncg(0), do_cse(0), do_TmpPhsp(0), sync_replay(false),
 	cgeoms(0), nsubgeoms(0), check_for_subreg(0), is_subgeomreg(0), subgeoms(0),
 	container(0), container2(0), container3(0), save_dose(0), silent(0) ,
         iso_pu_flag(0), cav_pu_flag(0), iso_pu_do_shift(0), cav_pu_do_shift(0),pu_flag(0),
@@ -592,6 +530,9 @@ public:
      */
     int runSimulation();
 
+    /*! Set photon splitting, radiative splitting or XCSE during tuning */
+    bool setVRParameter(const string &name, EGS_Float value);
+
     /* For eventual implementation*/
     //int combineResults();
 
@@ -600,6 +541,10 @@ public:
      */
     int simulateSingleShower();
 
+    /*! Transport a particle from the temporary phase space in geometry ig,
+        jpu is the index of the cavity positioning uncertainty distributor */
+    void replayParticle(int jpu);
+
     /*! Output intermediate results to the .egsdat file. */
     int outputData();
 
@@ -695,9 +640,10 @@ private:
     int **cs_enhance;
     bool do_cse;
     int do_TmpPhsp;
-    TmpPhsp *container;
-    TmpPhsp *container2;
-    TmpPhsp *container3;
+    bool sync_replay;   // replay each particle in all geometries with the same RNG state
+    EGS_ParticleStore *container;
+    EGS_ParticleStore *container2;
+    EGS_ParticleStore *container3;
     bool do_mcav;
     EGS_BaseGeometry **cgeoms;
     //EGS_I32 ip, np;		// pointers in mortran arrays
@@ -836,6 +782,7 @@ void EGS_ChamberApplication::describeSimulation() {
     if (do_TmpPhsp){
 	egsInformation("\nscoring phase-space at cavity of '%s'",geoms[0]->getName().c_str());
     	if(do_TmpPhsp>1)egsInformation("\n recycling %i times",do_TmpPhsp);
+    	if(sync_replay)egsInformation("\n synchronized replay in all geometries");
 	if(do_sub &! silent){ egsInformation("\n\n subgeometries:");
 		for(int j=0; j<ngeom; j++) {
 			if(nsubgeoms[j]>0 && has_sub[j]){
@@ -917,9 +864,12 @@ int EGS_ChamberApplication::initScoring() {
         int err815 = vr->getInput("TmpPhsp",tmps);
         if(!err815){
             do_TmpPhsp = tmps;
-            container = new TmpPhsp;
-            container3 = new TmpPhsp;
+            container = new EGS_ParticleStore;
+            container3 = new EGS_ParticleStore;
         }
+        vector<string> sync_options;
+        sync_options.push_back("no"); sync_options.push_back("yes");
+        sync_replay = vr->getInput("synchronized replay",sync_options,0);
         //
         // ******* cs enhancement
         //
@@ -1816,7 +1766,12 @@ int EGS_ChamberApplication::initScoring() {
             //	if(nsubgeoms[i] == 0){
             //		egsFatal("\nsubgeometries");
             //}
-            container2 = new TmpPhsp;
+            container2 = new EGS_ParticleStore;
+        }
+        if( sync_replay && do_sub ){
+            egsWarning("\nsynchronized replay can not be combined with"
+                    " subgeometries --> turned off\n");
+            sync_replay = false;
         }
     }
     //
@@ -2113,6 +2068,8 @@ int EGS_ChamberApplication::runSimulation() {
     }
     if( !ok ) return 1;
 
+    if( run->getRestart() == 0 ) tuneVarianceReduction();
+
     int start_status = run->startSimulation();
     if( start_status ) {
         if( start_status < 0 )
@@ -2296,6 +2253,27 @@ int EGS_ChamberApplication::simulateSingleShower() {
                 }
                 */
             }
+            // synchronized replay: each particle is transported in all other
+            // geometries starting from the same random number state
+            else if(sync_replay){
+                int tmppc = container->size();
+                for(int k=tmppc; k>0; k--){
+                    for( int i=0; i< do_TmpPhsp; i++){
+                        saveRNGState();
+                        for(ig=1; ig<ngeom; ig++){
+                            if(ig > 1) resetRNGState();
+                            geometry = geoms[ig];
+                            container->setPointer(k);
+                            nsmall_step = 0;
+                            the_stack->np = 1;
+                            container->get();
+                            replayParticle(jpu);
+                        }
+                    }
+                }
+                container->setPointer(tmppc);
+                break;
+            }
             // when particles were scored reuse them for all other geometries
             else if(container->size() > 0){
                 if( (nsubgeoms[ig] != 0) || !do_sub ){
@@ -2315,81 +2293,7 @@ int EGS_ChamberApplication::simulateSingleShower() {
                             nsmall_step = 0;
                             the_stack->np = 1;
                             container->get();
-                            EGS_Vector xt(the_stack->x[0], the_stack->y[0], the_stack->z[0]);
-                            if( transforms[ig] ) {
-                                transforms[ig]->transform(xt);
-                                EGS_Vector ut(the_stack->u[0], the_stack->v[0], the_stack->w[0]);
-                                transforms[ig]->rotate(ut);
-                                the_stack->u[0] = ut.x; the_stack->v[0] = ut.y; the_stack->w[0] = ut.z;
-                                the_stack->x[0] = xt.x; the_stack->y[0] = xt.y; the_stack->z[0] = xt.z;
-                            }
-                            //HB Nov. 2009: Could implement motion of paricle here for positioning uncertainty
-                            //*HB_start************************
-                            //cavity positioning uncertainty (implem here to avoid delay in shift if particle do not reach TmpPhsp)
-                            if(cav_pu_flag) {
-                                if(cav_pu_do_shift) {
-                                    pu_distributor[jpu]->setNewShifts(rndm);
-                                    cav_pu_do_shift = false;
-                                }
-                                EGS_Vector tmp1 = pu_distributor[jpu]->getRotation();
-                                EGS_RotationMatrix Rtmp = EGS_RotationMatrix(-tmp1.x,-tmp1.y,-tmp1.z);
-                                EGS_Vector ut(the_stack->u[0], the_stack->v[0], the_stack->w[0]);
-                                //EGS_Vector xt(the_stack->x[0], the_stack->y[0], the_stack->z[0]);
-                                xt = Rtmp*xt;
-                                ut = Rtmp*ut;
-                                EGS_Vector tmp2 = pu_distributor[jpu]->getTranslation();
-                                xt.x -= tmp2.x;
-                                xt.y -= tmp2.y;
-                                xt.z -= tmp2.z;
-                                the_stack->u[0] = ut.x; the_stack->v[0] = ut.y; the_stack->w[0] = ut.z;
-                                the_stack->x[0] = xt.x; the_stack->y[0] = xt.y; the_stack->z[0] = xt.z;
-                            }
-                            //*HB_end**************************
-
-                            the_stack->ir[0] = geometry->isWhere(xt) + 2;
-                            if( the_stack->ir[0] < 2 ) continue;
-                            the_stack->wt[0] /= (EGS_Float)do_TmpPhsp;// adjust weight due to splitting
-                            the_stack->latch[0] /= do_TmpPhsp;	  // the latch is only set for fat electrons ph
-                            the_stack->dnear[0] = 0;
-                            // adjust the number/weight of electrons
-                            // I assume that the cse_enhance in the cavity of the TmpPhsp object
-                            // is related to the actual weight of the electron
-                            // when I start in the geometry I compare with the new and old cse
-                            if( the_stack->iq[0] ){
-                                int ir = the_stack->ir[0]-2;
-                                if( cs_enhance[0][basereg] < cs_enhance[ig][ir] ){
-                                    // split since CSE increased in this reg
-                                    int n_esplit = cs_enhance[ig][ir]/cs_enhance[0][basereg];
-                                    the_stack->wt[0] = the_stack->wt[0]/(EGS_Float)n_esplit;
-                                    for(int i=0; i<n_esplit; i++){
-                                        container3->set();
-                                    }
-                                    while(container3->size() > 0){
-                                        nsmall_step = 0;
-                                        the_stack->dnear[0] = 0;
-                                        the_stack->np = 1;
-                                        container3->get();
-                                        EGS_Vector xt2(the_stack->x[0], the_stack->y[0], the_stack->z[0]);
-                                        the_stack->ir[0] = geometry->isWhere(xt2) + 2;
-                                        egsShower();
-                                    }
-                                }
-                                //play RR since cse is decreased in this reg
-                                else if( ir >= 0 && cs_enhance[0][basereg] > cs_enhance[ig][ir] ){
-                                    int RRprob = cs_enhance[0][basereg]/cs_enhance[ig][ir];
-                                    if( rndm->getUniform()*RRprob < 1 ){
-                                        the_stack->wt[0] *= RRprob;
-                                        egsShower();
-                                    }
-                                }
-                                else{
-                                    // CSE stayed the same
-                                    egsShower(); // shortcut to mortran-backend
-                                }
-                            }
-                            else{
-                                egsShower();
-                            }
+                            replayParticle(jpu);
                         }
                     }
                     container->setPointer(tmppc);	// for next geometry
@@ -2439,6 +2343,88 @@ int EGS_ChamberApplication::simulateSingleShower() {
 };
 
 
+/*! Transport the particle on top of the stack, taken from the temporary
+    phase space, in the current calculation geometry.
+ */
+void EGS_ChamberApplication::replayParticle(int jpu) {
+        EGS_Vector xt(the_stack->x[0], the_stack->y[0], the_stack->z[0]);
+        if( transforms[ig] ) {
+            transforms[ig]->transform(xt);
+            EGS_Vector ut(the_stack->u[0], the_stack->v[0], the_stack->w[0]);
+            transforms[ig]->rotate(ut);
+            the_stack->u[0] = ut.x; the_stack->v[0] = ut.y; the_stack->w[0] = ut.z;
+            the_stack->x[0] = xt.x; the_stack->y[0] = xt.y; the_stack->z[0] = xt.z;
+        }
+        //HB Nov. 2009: Could implement motion of paricle here for positioning uncertainty
+        //*HB_start************************
+        //cavity positioning uncertainty (implem here to avoid delay in shift if particle do not reach TmpPhsp)
+        if(cav_pu_flag) {
+            if(cav_pu_do_shift) {
+                pu_distributor[jpu]->setNewShifts(rndm);
+                cav_pu_do_shift = false;
+            }
+            EGS_Vector tmp1 = pu_distributor[jpu]->getRotation();
+            EGS_RotationMatrix Rtmp = EGS_RotationMatrix(-tmp1.x,-tmp1.y,-tmp1.z);
+            EGS_Vector ut(the_stack->u[0], the_stack->v[0], the_stack->w[0]);
+            //EGS_Vector xt(the_stack->x[0], the_stack->y[0], the_stack->z[0]);
+            xt = Rtmp*xt;
+            ut = Rtmp*ut;
+            EGS_Vector tmp2 = pu_distributor[jpu]->getTranslation();
+            xt.x -= tmp2.x;
+            xt.y -= tmp2.y;
+            xt.z -= tmp2.z;
+            the_stack->u[0] = ut.x; the_stack->v[0] = ut.y; the_stack->w[0] = ut.z;
+            the_stack->x[0] = xt.x; the_stack->y[0] = xt.y; the_stack->z[0] = xt.z;
+        }
+        //*HB_end**************************
+
+        the_stack->ir[0] = geometry->isWhere(xt) + 2;
+        if( the_stack->ir[0] < 2 ) return;
+        the_stack->wt[0] /= (EGS_Float)do_TmpPhsp;// adjust weight due to splitting
+        the_stack->latch[0] /= do_TmpPhsp;	  // the latch is only set for fat electrons ph
+        the_stack->dnear[0] = 0;
+        // adjust the number/weight of electrons
+        // I assume that the cse_enhance in the cavity of the TmpPhsp object
+        // is related to the actual weight of the electron
+        // when I start in the geometry I compare with the new and old cse
+        if( the_stack->iq[0] ){
+            int ir = the_stack->ir[0]-2;
+            if( cs_enhance[0][basereg] < cs_enhance[ig][ir] ){
+                // split since CSE increased in this reg
+                int n_esplit = cs_enhance[ig][ir]/cs_enhance[0][basereg];
+                the_stack->wt[0] = the_stack->wt[0]/(EGS_Float)n_esplit;
+                container3->clean();
+                container3->set();
+                for(int i=0; i<n_esplit; i++){
+                    nsmall_step = 0;
+                    the_stack->dnear[0] = 0;
+                    the_stack->np = 1;
+                    container3->setPointer(1);
+                    container3->get();
+                    EGS_Vector xt2(the_stack->x[0], the_stack->y[0], the_stack->z[0]);
+                    the_stack->ir[0] = geometry->isWhere(xt2) + 2;
+                    egsShower();
+                }
+            }
+            //play RR since cse is decreased in this reg
+            else if( ir >= 0 && cs_enhance[0][basereg] > cs_enhance[ig][ir] ){
+                int RRprob = cs_enhance[0][basereg]/cs_enhance[ig][ir];
+                if( rndm->getUniform()*RRprob < 1 ){
+                    the_stack->wt[0] *= RRprob;
+                    egsShower();
+                }
+            }
+            else{
+                // CSE stayed the same
+                egsShower(); // shortcut to mortran-backend
+            }
+        }
+        else{
+            egsShower();
+        }
+}
+
+
 /*! Output intermediate results to the .egsdat file. */
 int EGS_ChamberApplication::outputData() {
     int err = EGS_AdvancedApplication::outputData();
@@ -2516,6 +2502,38 @@ int EGS_ChamberApplication::readData() {
     return 0;
 };
 
+/*! Set photon splitting, radiative splitting or the XCSE factor during
+    tuning. Photon splitting can only be tuned if it was turned on in the
+    variance reduction input, because the ausgab calls needed for it
+    are set up in initScoring(). The same applies to the XCSE factor,
+    which must be an integer of at least 2 and replaces the enhancement
+    factor of all regions with cross section enhancement.
+ */
+bool EGS_ChamberApplication::setVRParameter(const string &name,
+        EGS_Float value) {
+    if( name == "photon splitting" ) {
+        if( fsplit <= 1 || value <= 1 ) return false;
+        fsplit = value; fspliti = 1/value;
+        return true;
+    }
+    if( name == "radiative splitting" ) {
+        if( value < 1 ) return false;
+        // nbr_split is reset to csplit at the start of each history
+        csplit = (int) value; the_egsvr->nbr_split = csplit;
+        return true;
+    }
+    if( name == "XCSE factor" ) {
+        int fac = (int) value;
+        if( !do_cse || fac < 2 ) return false;
+        for(int j=0; j<ngeom; j++) {
+            for(int i=0; i<geoms[j]->regions(); i++)
+                if( cs_enhance[j][i] > 1 ) cs_enhance[j][i] = fac;
+        }
+        return true;
+    }
+    return EGS_AdvancedApplication::setVRParameter(name,value);
+}
+
 /*! Reset the variables used for accumulating results */
 void EGS_ChamberApplication::resetCounter() {
     EGS_AdvancedApplication::resetCounter();